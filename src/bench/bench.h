@@ -38,6 +38,11 @@ BENCHMARK(CODE_TO_TIME, 5000);
 
  */
 
+/** Number of wallet outputs created by the staking simulation (-stakeutxos) */
+static const int64_t DEFAULT_BENCH_STAKE_UTXOS = 1000;
+static const int64_t MIN_BENCH_STAKE_UTXOS = 1000;
+static const int64_t MAX_BENCH_STAKE_UTXOS = 500000;
+
 namespace benchmark {
 // In case high_resolution_clock is steady, prefer that, otherwise use steady_clock.
 struct best_clock {
@@ -34,6 +34,7 @@ static void SetupBenchArgs()
     gArgs.AddArg("-plot-plotlyurl=<uri>", strprintf("URL to use for plotly.js (default: %s)", DEFAULT_PLOT_PLOTLYURL), false, OptionsCategory::OPTIONS);
     gArgs.AddArg("-plot-width=<x>", strprintf("Plot width in pixel (default: %u)", DEFAULT_PLOT_WIDTH), false, OptionsCategory::OPTIONS);
     gArgs.AddArg("-plot-height=<x>", strprintf("Plot height in pixel (default: %u)", DEFAULT_PLOT_HEIGHT), false, OptionsCategory::OPTIONS);
+    gArgs.AddArg("-stakeutxos=<n>", strprintf("Number of wallet outputs used by the staking simulation, %u-%u (default: %u)", MIN_BENCH_STAKE_UTXOS, MAX_BENCH_STAKE_UTXOS, DEFAULT_BENCH_STAKE_UTXOS), false, OptionsCategory::OPTIONS);
 }
 
 static fs::path SetDataDir()
@@ -77,6 +78,12 @@ int main(int argc, char** argv)
         return EXIT_FAILURE;
     }
 
+    const int64_t stake_utxos = gArgs.GetArg("-stakeutxos", DEFAULT_BENCH_STAKE_UTXOS);
+    if (stake_utxos < MIN_BENCH_STAKE_UTXOS || stake_utxos > MAX_BENCH_STAKE_UTXOS) {
+        tfm::format(std::cerr, "Error: -stakeutxos must be between %d and %d\n", MIN_BENCH_STAKE_UTXOS, MAX_BENCH_STAKE_UTXOS);
+        return EXIT_FAILURE;
+    }
+
     std::unique_ptr<benchmark::Printer> printer = MakeUnique<benchmark::ConsolePrinter>();
     std::string printer_arg = gArgs.GetArg("-printer", DEFAULT_BENCH_PRINTER);
     if ("plot" == printer_arg) {
@@ -0,0 +1,158 @@
+// Copyright (c) 2020 The Blocknet developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <compat.h>
+#include <netbase.h>
+#include <util/system.h>
+
+#include <cassert>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+#ifdef USE_POLL
+#include <poll.h>
+#endif
+#ifdef USE_EPOLL
+#include <sys/epoll.h>
+#endif
+
+// Per-loop cost of only the readiness wait with many connected peers, of which
+// every 100th has data in each loop. poll() rebuilds the socket set every loop
+// like GenerateSelectSet and SocketEventsPoll, epoll keeps the sockets registered
+// and only returns the ones that became ready.
+//
+// These loops mirror the wait and don't run CConnman. After the wait SocketHandler
+// still walks every node (remembered readiness, InactivityCheck), so a full socket
+// handler loop stays linear in the number of peers with either mode.
+
+#if defined(USE_POLL) && !defined(WIN32)
+namespace {
+
+/** Connected socket pairs, the local end is the one the socket handler waits on */
+class Peers
+{
+public:
+    explicit Peers(size_t count)
+    {
+        RaiseFileDescriptorLimit(2 * count + 64);
+        for (size_t i = 0; i < count; ++i) {
+            int fds[2];
+            if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+                break;
+            local.push_back(fds[0]);
+            remote.push_back(fds[1]);
+        }
+    }
+
+    ~Peers()
+    {
+        for (SOCKET& s : local)
+            CloseSocket(s);
+        for (SOCKET& s : remote)
+            CloseSocket(s);
+    }
+
+    void Send()
+    {
+        for (size_t i = 0; i < remote.size(); i += 100)
+            send(remote[i], "x", 1, MSG_NOSIGNAL | MSG_DONTWAIT);
+    }
+
+    static void Receive(const std::set<SOCKET>& recv_set)
+    {
+        char buf[16];
+        for (SOCKET s : recv_set)
+            recv(s, buf, sizeof(buf), MSG_DONTWAIT);
+    }
+
+    std::vector<SOCKET> local;
+    std::vector<SOCKET> remote;
+};
+
+} // namespace
+
+static void SocketEventsPoll(benchmark::State& state, size_t count)
+{
+    Peers peers(count);
+    while (state.KeepRunning()) {
+        peers.Send();
+
+        std::set<SOCKET> recv_select_set, error_select_set;
+        for (SOCKET s : peers.local) {
+            recv_select_set.insert(s);
+            error_select_set.insert(s);
+        }
+        std::unordered_map<SOCKET, struct pollfd> pollfds;
+        for (SOCKET s : recv_select_set) {
+            pollfds[s].fd = s;
+            pollfds[s].events |= POLLIN;
+        }
+        for (SOCKET s : error_select_set) {
+            pollfds[s].fd = s;
+            pollfds[s].events |= POLLERR|POLLHUP;
+        }
+        std::vector<struct pollfd> vpollfds;
+        vpollfds.reserve(pollfds.size());
+        for (const auto& it : pollfds)
+            vpollfds.push_back(it.second);
+
+        poll(vpollfds.data(), vpollfds.size(), 0);
+
+        std::set<SOCKET> recv_set;
+        for (const struct pollfd& entry : vpollfds) {
+            if (entry.revents & POLLIN)
+                recv_set.insert(entry.fd);
+        }
+        Peers::Receive(recv_set);
+    }
+}
+
+static void SocketEventsPoll100(benchmark::State& state) { SocketEventsPoll(state, 100); }
+static void SocketEventsPoll500(benchmark::State& state) { SocketEventsPoll(state, 500); }
+static void SocketEventsPoll1000(benchmark::State& state) { SocketEventsPoll(state, 1000); }
+
+BENCHMARK(SocketEventsPoll100, 5000);
+BENCHMARK(SocketEventsPoll500, 1000);
+BENCHMARK(SocketEventsPoll1000, 500);
+#endif
+
+#ifdef USE_EPOLL
+static void SocketEventsEpoll(benchmark::State& state, size_t count)
+{
+    Peers peers(count);
+    const int epollfd = epoll_create1(EPOLL_CLOEXEC);
+    assert(epollfd != -1);
+    for (SOCKET s : peers.local) {
+        struct epoll_event event{};
+        event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        event.data.fd = s;
+        epoll_ctl(epollfd, EPOLL_CTL_ADD, s, &event);
+    }
+
+    struct epoll_event events[1024];
+    while (state.KeepRunning()) {
+        peers.Send();
+
+        const int nEvents = epoll_wait(epollfd, events, 1024, 0);
+
+        std::set<SOCKET> recv_set;
+        for (int i = 0; i < nEvents; ++i) {
+            if (events[i].events & EPOLLIN)
+                recv_set.insert(events[i].data.fd);
+        }
+        Peers::Receive(recv_set);
+    }
+    close(epollfd);
+}
+
+static void SocketEventsEpoll100(benchmark::State& state) { SocketEventsEpoll(state, 100); }
+static void SocketEventsEpoll500(benchmark::State& state) { SocketEventsEpoll(state, 500); }
+static void SocketEventsEpoll1000(benchmark::State& state) { SocketEventsEpoll(state, 1000); }
+
+BENCHMARK(SocketEventsEpoll100, 5000);
+BENCHMARK(SocketEventsEpoll500, 1000);
+BENCHMARK(SocketEventsEpoll1000, 500);
+#endif
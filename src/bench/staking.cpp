@@ -0,0 +1,255 @@
+// Copyright (c) 2020 The Blocknet developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <chainparams.h>
+#include <consensus/validation.h>
+#include <interfaces/chain.h>
+#include <kernel.h>
+#include <miner.h>
+#include <pow.h>
+#include <pubkey.h>
+#include <scheduler.h>
+#include <script/sign.h>
+#include <stakemgr.h>
+#include <timedata.h>
+#include <txdb.h>
+#include <txmempool.h>
+#include <util/system.h>
+#include <util/time.h>
+#include <validation.h>
+#include <validationinterface.h>
+#include <wallet/wallet.h>
+
+#include <boost/thread.hpp>
+
+/**
+ * Synthetic regtest chain and wallet used to simulate staking. The PoW coinbases are
+ * fanned out into -stakeutxos outputs that all belong to the simulated wallet.
+ */
+class StakingSimulation {
+public:
+    explicit StakingSimulation(const int utxos) {
+        SelectParams(CBaseChainParams::REGTEST);
+        const auto & params = Params();
+        const auto & consensus = params.GetConsensus();
+        InitScriptExecutionCache();
+
+        threadGroup.create_thread(std::bind(&CScheduler::serviceQueue, &scheduler));
+        GetMainSignals().RegisterBackgroundSignalScheduler(scheduler);
+        UnloadBlockIndex(); // other benchmarks may have left a chain behind
+        {
+            LOCK(cs_main);
+            ::pblocktree.reset(new CBlockTreeDB(1 << 20, true));
+            ::pcoinsdbview.reset(new CCoinsViewDB(1 << 23, true));
+            ::pcoinsTip.reset(new CCoinsViewCache(pcoinsdbview.get()));
+        }
+        LoadGenesisBlock(params);
+        CValidationState state;
+        ActivateBestChain(state, params);
+        assert(::chainActive.Tip() != nullptr);
+
+        key.MakeNewKey(true);
+        CBasicKeyStore keystore; // used to spend the coinbases
+        keystore.AddKey(key);
+        script = CScript() << ToByteVector(key.GetPubKey()) << OP_CHECKSIG;
+
+        // Spread the requested outputs over every block that can spend a mature coinbase
+        const int fanoutBlocks = consensus.lastPOWBlock - consensus.coinMaturity - 1;
+        const int perTx = std::max(1, (utxos + fanoutBlocks - 1) / fanoutBlocks);
+        std::vector<CTransactionRef> coinbases;
+        int created{0};
+        for (int i = 0; i < consensus.lastPOWBlock; ++i) {
+            SetMockTime(GetAdjustedTime() + consensus.nPowTargetSpacing);
+            std::vector<CMutableTransaction> txs;
+            if (i > consensus.coinMaturity && created < utxos) {
+                const auto & prev = coinbases[i - consensus.coinMaturity];
+                const int outputs = std::min(perTx, utxos - created);
+                CMutableTransaction mtx;
+                mtx.vin.emplace_back(COutPoint(prev->GetHash(), 0));
+                const CAmount value = (prev->vout[0].nValue - COIN) / outputs; // leave a fee
+                for (int k = 0; k < outputs; ++k)
+                    mtx.vout.emplace_back(value, script);
+                SignatureData sigdata;
+                ProduceSignature(keystore, MutableTransactionSignatureCreator(&mtx, 0, prev->vout[0].nValue, SIGHASH_ALL), prev->vout[0].scriptPubKey, sigdata);
+                UpdateInput(mtx.vin[0], sigdata);
+                txs.push_back(mtx);
+                created += outputs;
+            }
+            coinbases.push_back(MineBlock(txs).vtx[0]);
+        }
+
+        chain = interfaces::MakeChain();
+        wallet = std::make_shared<CWallet>(*chain, WalletLocation(), WalletDatabase::CreateMock());
+        bool firstRun;
+        wallet->LoadWallet(firstRun);
+        {
+            LOCK(wallet->cs_wallet);
+            wallet->AddKeyPubKey(key, key.GetPubKey());
+        }
+        {
+            WalletRescanReserver reserver(wallet.get());
+            reserver.reserve();
+            wallet->ScanForWalletTransactions(::chainActive.Genesis()->GetBlockHash(), {}, reserver, true);
+        }
+        RegisterValidationInterface(wallet.get());
+
+        // Age the outputs past the minimum stake age
+        SetMockTime(GetAdjustedTime() + consensus.stakeMinAge * 2);
+    }
+
+    ~StakingSimulation() {
+        SyncWithValidationInterfaceQueue();
+        UnregisterValidationInterface(wallet.get());
+        wallet.reset();
+        chain.reset();
+        threadGroup.interrupt_all();
+        threadGroup.join_all();
+        GetMainSignals().FlushBackgroundCallbacks();
+        GetMainSignals().UnregisterBackgroundSignalScheduler();
+        UnloadBlockIndex();
+        ::pcoinsTip.reset();
+        ::pcoinsdbview.reset();
+        ::pblocktree.reset();
+        SetMockTime(0);
+    }
+
+    const CBlockIndex* Tip() {
+        LOCK(cs_main);
+        return ::chainActive.Tip();
+    }
+
+    /** Runs the staker until it produces the next block */
+    void StakeBlock(StakeMgr & staker) {
+        const auto & params = Params();
+        const auto height = Tip()->nHeight;
+        std::vector<std::shared_ptr<CWallet>> wallets{wallet};
+        int tries{0};
+        while (Tip()->nHeight == height) {
+            const auto tip = Tip();
+            if (staker.Update(wallets, tip, params.GetConsensus(), true) && staker.TryStake(tip, params))
+                break;
+            assert(++tries < 1000);
+            auto stime = staker.LastUpdateTime();
+            if (stime == 0)
+                stime = GetAdjustedTime();
+            SetMockTime(stime + params.GetConsensus().PoSFutureBlockTimeLimit(tip->GetBlockTime()));
+        }
+        SyncWithValidationInterfaceQueue(); // let the wallet pick up the coinstake
+    }
+
+    static int UtxoCount() {
+        return static_cast<int>(gArgs.GetArg("-stakeutxos", DEFAULT_BENCH_STAKE_UTXOS));
+    }
+
+    std::shared_ptr<CWallet> wallet;
+
+private:
+    CBlock MineBlock(const std::vector<CMutableTransaction> & txs) {
+        const auto & params = Params();
+        auto pblocktemplate = BlockAssembler(params).CreateNewBlock(script);
+        CBlock & block = pblocktemplate->block;
+        block.vtx.resize(1);
+        for (const auto & tx : txs)
+            block.vtx.push_back(MakeTransactionRef(tx));
+        {
+            LOCK(cs_main);
+            unsigned int extraNonce = 0;
+            IncrementExtraNonce(&block, ::chainActive.Tip(), extraNonce);
+        }
+        while (!CheckProofOfWork(block.GetHash(), block.nBits, params.GetConsensus()))
+            ++block.nNonce;
+        bool processed{ProcessNewBlock(params, std::make_shared<const CBlock>(block), true, nullptr)};
+        assert(processed);
+        return block;
+    }
+
+private:
+    ECCVerifyHandle verifyHandle;
+    boost::thread_group threadGroup;
+    CScheduler scheduler;
+    std::unique_ptr<interfaces::Chain> chain;
+    CKey key;
+    CScript script;
+};
+
+// Raw kernel search, one iteration is one candidate stake time for one input.
+static void StakeKernelHash(benchmark::State& state)
+{
+    SelectParams(CBaseChainParams::REGTEST);
+    const auto & consensus = Params().GetConsensus();
+    const uint256 hashBlockFrom = uint256S("0x2a3b0f1e89c2e7a2b3c53da7b66d1f3e2f4d4a9c7c0e1b3d5f7a9c1e3b5d7f91");
+    arith_uint256 bnTargetPerCoinDay;
+    bnTargetPerCoinDay.SetCompact(0x1d00ffff);
+    CDataStream ss(SER_GETHASH, 0);
+    ss << static_cast<uint64_t>(0x5ca1ab1e);
+    const unsigned int nTimeBlockFrom{1590000000};
+    unsigned int nTimeTx{nTimeBlockFrom + 3600};
+
+    while (state.KeepRunning()) {
+        const auto hashProofOfStake = stakeHashV06(ss, hashBlockFrom, nTimeBlockFrom, 100000, 1, nTimeTx);
+        stakeTargetHitV07(hashProofOfStake, nTimeTx, nTimeTx - consensus.nPowTargetSpacing, 1000 * COIN,
+                          bnTargetPerCoinDay, consensus.nPowTargetSpacing);
+        ++nTimeTx;
+    }
+}
+
+// Kernel validation against an in-memory block index, includes the stake modifier lookup.
+static void StakeCheckKernelHash(benchmark::State& state)
+{
+    SelectParams(CBaseChainParams::REGTEST);
+    const auto & consensus = Params().GetConsensus();
+    constexpr int CHAIN_LENGTH{1000};
+    const int64_t startTime{1590000000};
+    std::vector<uint256> hashes(CHAIN_LENGTH);
+    std::vector<CBlockIndex> index(CHAIN_LENGTH);
+    for (int i = 0; i < CHAIN_LENGTH; ++i) {
+        hashes[i] = ArithToUint256(arith_uint256(i + 1));
+        index[i].phashBlock = &hashes[i];
+        index[i].pprev = i > 0 ? &index[i - 1] : nullptr;
+        index[i].nHeight = i;
+        index[i].nTime = static_cast<uint32_t>(startTime + i * consensus.nPowTargetSpacing);
+        index[i].nBits = UintToArith256(consensus.powLimit).GetCompact();
+        index[i].nStakeModifier = static_cast<uint64_t>(i);
+    }
+    const CBlockIndex *pindexPrev = &index.back();
+    const CBlockIndex *pindexStake = &index.front();
+    const COutPoint prevout(hashes.front(), 0);
+    int64_t blockTime = pindexPrev->GetBlockTime() + consensus.nPowTargetSpacing;
+
+    while (state.KeepRunning()) {
+        uint256 hashProofOfStake;
+        CheckStakeKernelHash(pindexPrev, pindexStake, pindexPrev->nBits, 1000 * COIN, prevout, blockTime,
+                             static_cast<unsigned int>(blockTime), hashProofOfStake, consensus);
+        ++blockTime;
+    }
+}
+
+// Wall time of a full StakeMgr::Update pass over -stakeutxos inputs.
+static void StakeMgrUpdate(benchmark::State& state)
+{
+    StakingSimulation sim(StakingSimulation::UtxoCount());
+    std::vector<std::shared_ptr<CWallet>> wallets{sim.wallet};
+    const auto tip = sim.Tip();
+    StakeMgr staker;
+    while (state.KeepRunning()) {
+        staker.Reset(); // force a search over the whole staking window
+        staker.Update(wallets, tip, Params().GetConsensus(), true);
+    }
+}
+
+// Latency from the start of a stake search to the block being accepted.
+static void StakeMgrStakeBlock(benchmark::State& state)
+{
+    StakingSimulation sim(StakingSimulation::UtxoCount());
+    StakeMgr staker;
+    while (state.KeepRunning()) {
+        sim.StakeBlock(staker);
+    }
+}
+
+BENCHMARK(StakeKernelHash, 500 * 1000);
+BENCHMARK(StakeCheckKernelHash, 500 * 1000);
+BENCHMARK(StakeMgrUpdate, 5);
+BENCHMARK(StakeMgrStakeBlock, 5);
@@ -6,6 +6,7 @@
 
 #include <primitives/transaction.h>
 #include <hash.h>
+#include <memusage.h>
 #include <script/script.h>
 #include <script/standard.h>
 #include <random.h>
@@ -299,6 +300,11 @@ bool CRollingBloomFilter::contains(const uint256& hash) const
     return contains(vData);
 }
 
+size_t CRollingBloomFilter::DynamicMemoryUsage() const
+{
+    return memusage::DynamicUsage(data);
+}
+
 void CRollingBloomFilter::reset()
 {
     nTweak = GetRand(std::numeric_limits<unsigned int>::max());
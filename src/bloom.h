@@ -132,6 +132,8 @@ public:
 
     void reset();
 
+    size_t DynamicMemoryUsage() const;
+
 private:
     int nEntriesPerGeneration;
     int nEntriesThisGeneration;
@@ -25,11 +25,14 @@
 #include <validation.h>
 #include <validationinterface.h>
 
+#include <atomic>
+#include <functional>
 #include <regex>
 #include <string>
 #include <utility>
 
 #include <boost/algorithm/string.hpp>
+#include <boost/signals2/signal.hpp>
 #include <boost/thread.hpp>
 
 /**
@@ -1125,9 +1128,50 @@ public:
         stackvotes.clear();
         sbvotes.clear();
         db->Reset(true);
+        ++generation;
+        for (auto & item : sbgenerations)
+            ++item.second;
+        pendingNotifications.clear();
+        pendingSuperblocks.clear();
         return true;
     }
 
+    /**
+     * Returns the generation of the governance data. The generation increases every time a
+     * proposal or vote is added, removed, spent or unspent. Consumers can compare it with the
+     * generation they last saw instead of fetching and comparing the proposals and votes.
+     * @return
+     */
+    uint64_t getGeneration() const {
+        return generation;
+    }
+
+    /**
+     * Returns the generation of the proposals and votes in the specified superblock. Superblock
+     * results only need to be recomputed when this changes.
+     * @param superblock Block number of superblock
+     * @return
+     */
+    uint64_t getGeneration(const int & superblock) {
+        LOCK(mu);
+        auto it = sbgenerations.find(superblock);
+        return it != sbgenerations.end() ? it->second : 0;
+    }
+
+    /**
+     * Change notifications. Only changes from connected and disconnected blocks are announced,
+     * the data loaded by loadGovernanceData is reflected by the generation only. Signals are
+     * emitted on the validation interface thread after the governance lock is released.
+     */
+    boost::signals2::signal<void (const Proposal & proposal)> NotifyProposalAdded;
+    boost::signals2::signal<void (const Proposal & proposal)> NotifyProposalRemoved;
+    boost::signals2::signal<void (const Vote & vote)> NotifyVoteAdded;
+    boost::signals2::signal<void (const Vote & vote)> NotifyVoteRemoved;
+    boost::signals2::signal<void (const Vote & vote)> NotifyVoteSpent;
+    boost::signals2::signal<void (const Vote & vote)> NotifyVoteUnspent;
+    /** Emitted once per block for each superblock whose proposals or votes changed */
+    boost::signals2::signal<void (int superblock, uint64_t generation)> NotifySuperblockChanged;
+
     /**
      * Loads the governance data from the blockchain ledger. It's possible to optimize
      * this further by creating a separate leveldb for goverance data. Currently, this
@@ -1619,6 +1663,8 @@ public:
         // Update db
         if (savedb)
             db->AddVote(CDiskVote(vote));
+
+        changed(proposals[vote.getProposal()].getSuperblock(), savedb, [this,vote]() { NotifyVoteSpent(vote); });
     }
 
     /**
@@ -1656,6 +1702,8 @@ public:
         // Update db
         if (savedb)
             db->AddVote(CDiskVote(vote));
+
+        changed(proposals[vote.getProposal()].getSuperblock(), savedb, [this,vote]() { NotifyVoteUnspent(vote); });
     }
 
     /**
@@ -2308,6 +2356,7 @@ protected:
             return;
         processBlock(block.get(), pindex->nHeight, params);
         db->BlockConnected(block, pindex, txn_conflicted);
+        sendNotifications();
     }
 
     void BlockDisconnected(const std::shared_ptr<const CBlock>& block) override {
@@ -2384,8 +2433,10 @@ protected:
                 removeProposal(proposal);
         }
 
-        if (blockHeight == maxInt)
+        if (blockHeight == maxInt) {
+            sendNotifications();
             return; // do not unspend votes if block height is undefined
+        }
 
         // Unspend any vote utxos that were spent by this
         // block. Only unspend those votes where the block
@@ -2416,6 +2467,8 @@ protected:
                 unspendVote(v.getHash(), blockHeight, prevouts[v.getUtxo()]);
             }
         }
+
+        sendNotifications();
     }
 
     /**
@@ -2507,6 +2560,8 @@ protected:
 
         if (savedb)
             db->AddVote(CDiskVote(vote));
+
+        changed(proposal.getSuperblock(), savedb, [this,vote]() { NotifyVoteAdded(vote); });
     }
 
     /**
@@ -2538,10 +2593,13 @@ protected:
         if (savedb)
             db->RemoveVote(voteHash);
 
-        if (!proposals.count(vote.getProposal()))
+        if (!proposals.count(vote.getProposal())) {
+            ++generation;
             return;
+        }
 
         const auto & proposal = proposals[vote.getProposal()];
+        changed(proposal.getSuperblock(), savedb, [this,vote]() { NotifyVoteRemoved(vote); });
         if (!sbvotes.count(proposal.getSuperblock()))
             return; // no votes found for superblock, skip
 
@@ -2571,6 +2629,8 @@ protected:
             return true;
 
         const auto & proposal = proposals[vote.getProposal()];
+        if (!outsideVotingCutoff(proposal, vote.getBlockNumber(), consensus))
+            changed(proposal.getSuperblock(), false, nullptr); // only used when loading governance data
         while (!outsideVotingCutoff(proposal, vote.getBlockNumber(), consensus)) {
             // Remove from votes data provider
             stackvotes[voteHash].pop_back();
@@ -2610,6 +2670,7 @@ protected:
         proposals[proposal.getHash()] = proposal;
         if (savedb)
             db->AddProposal(CDiskProposal(proposal));
+        changed(proposal.getSuperblock(), savedb, [this,proposal]() { NotifyProposalAdded(proposal); });
     }
 
     /**
@@ -2619,11 +2680,46 @@ protected:
      */
     void removeProposal(const Proposal & proposal, bool savedb=true) EXCLUSIVE_LOCKS_REQUIRED(mu) {
         const auto hash = proposal.getHash();
-        proposals.erase(hash);
+        if (proposals.erase(hash) > 0)
+            changed(proposal.getSuperblock(), savedb, [this,proposal]() { NotifyProposalRemoved(proposal); });
         if (savedb)
             db->RemoveProposal(hash);
     }
 
+    /**
+     * Bumps the generation of the governance data and of the superblock. If notify is set the
+     * notification is queued until sendNotifications is called without the governance lock.
+     * @param superblock
+     * @param notify
+     * @param notification
+     */
+    void changed(const int superblock, const bool notify, std::function<void()> notification) EXCLUSIVE_LOCKS_REQUIRED(mu) {
+        ++generation;
+        const auto sbgeneration = ++sbgenerations[superblock];
+        if (!notify)
+            return;
+        if (notification)
+            pendingNotifications.push_back(std::move(notification));
+        pendingSuperblocks[superblock] = sbgeneration;
+    }
+
+    /**
+     * Emits the queued change notifications.
+     */
+    void sendNotifications() LOCKS_EXCLUDED(mu) {
+        std::vector<std::function<void()>> notifications;
+        std::map<int, uint64_t> superblocks;
+        {
+            LOCK(mu);
+            notifications.swap(pendingNotifications);
+            superblocks.swap(pendingSuperblocks);
+        }
+        for (const auto & notification : notifications)
+            notification();
+        for (const auto & item : superblocks)
+            NotifySuperblockChanged(item.first, item.second);
+    }
+
 protected:
     Mutex mu;
     std::unordered_map<uint256, Proposal, Hasher> proposals GUARDED_BY(mu);
@@ -2631,6 +2727,10 @@ protected:
     std::unordered_map<uint256, std::vector<Vote>, Hasher> stackvotes GUARDED_BY(mu);
     std::unordered_map<int, std::unordered_map<uint256, Vote, Hasher>> sbvotes GUARDED_BY(mu);
     std::unique_ptr<GovernanceDB> db;
+    std::atomic<uint64_t> generation{0};
+    std::unordered_map<int, uint64_t> sbgenerations GUARDED_BY(mu);
+    std::vector<std::function<void()>> pendingNotifications GUARDED_BY(mu);
+    std::map<int, uint64_t> pendingSuperblocks GUARDED_BY(mu); // superblock, generation
 };
 
 }
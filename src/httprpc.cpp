@@ -18,13 +18,36 @@
 #include <crypto/hmac_sha256.h>
 #include <stdio.h>
 
+#include <map>
 #include <memory>
+#include <set>
 
 #include <boost/algorithm/string.hpp> // boost::trim
 
 /** WWW-Authenticate to present with 401 Unauthorized response */
 static const char* WWW_AUTH_HEADER_DATA = "Basic realm=\"jsonrpc\"";
 
+/** Request bodies up to this size are parsed on the HTTP thread to schedule the request by its methods */
+static const size_t MAX_RPC_CLASSIFY_BODY = 16 * 1024;
+
+/** Calls that only read a few values from memory, served by the fast lane workers
+ * besides the regular ones so slow calls can not hold them up. Extended with -rpcfastmethod.
+ */
+static const char* DEFAULT_RPC_FAST_METHODS[] = {
+    "getbestblockhash", "getblockcount", "getblockhash", "getconnectioncount",
+    "getrpcinfo", "uptime",
+    "dxGetLocalTokens", "dxGetNetworkTokens", "dxGetOrder", "dxGetOrders",
+};
+
+/** Default concurrency limits, <method or category>:<n>. Overridden with -rpcmethodlimit. */
+static const char* DEFAULT_RPC_METHOD_LIMITS[] = {
+    "dxGetOrderHistory:1", "dxGetTradingData:1", "xrouter:2",
+};
+
+static std::set<std::string> setRPCFastMethods;
+//! Method and category names with a concurrency limit, the name is the scheduling group
+static std::set<std::string> setRPCLimitedGroups;
+
 /** Simple one-shot callback timer to be used by the RPC mechanism to e.g.
  * re-lock the wallet.
  */
@@ -84,6 +107,67 @@ static void JSONErrorReply(HTTPRequest* req, const UniValue& objError, const Uni
     req->WriteReply(nStatus, strReply);
 }
 
+/** Size of the chunks a streamed result is sent in */
+static const size_t RPC_STREAM_CHUNK_SIZE = 64 * 1024;
+
+/**
+ * Sends the result of a singleton request as a chunked reply while the handler
+ * builds it. The reply is only started once the first element is pushed, results
+ * that are not streamed are replied to as before.
+ */
+class HTTPRPCStream final : public JSONRPCStream
+{
+public:
+    explicit HTTPRPCStream(HTTPRequest* req) : req(req) {}
+
+    bool Push(UniValue::VType type, const std::string* key, const UniValue& val) override
+    {
+        if (!started) {
+            req->WriteHeader("Content-Type", "application/json");
+            req->StartChunkedReply(HTTP_OK);
+            started = true;
+            closing = type == UniValue::VARR ? ']' : '}';
+            buffer = type == UniValue::VARR ? "{\"result\":[" : "{\"result\":{";
+        } else {
+            buffer += ',';
+        }
+        if (key) {
+            buffer += UniValue(*key).write();
+            buffer += ':';
+        }
+        buffer += val.write();
+        if (buffer.size() < RPC_STREAM_CHUNK_SIZE)
+            return true;
+        failed = !req->WriteChunk(buffer);
+        buffer.clear();
+        return !failed;
+    }
+
+    bool Started() const { return started; }
+
+    /**
+     * Close the result and send the error and id. On error the result holds the
+     * elements sent so far. If the client stopped reading the reply is cut short.
+     */
+    void Finish(const UniValue& error, const UniValue& id)
+    {
+        assert(started);
+        if (!failed) {
+            buffer += closing;
+            buffer += ",\"error\":" + error.write() + ",\"id\":" + id.write() + "}\n";
+            req->WriteChunk(buffer);
+        }
+        req->EndChunkedReply();
+    }
+
+private:
+    HTTPRequest* req;
+    bool started{false};
+    bool failed{false};
+    char closing{']'};
+    std::string buffer;
+};
+
 //This function checks username and password against -rpcauth
 //entries from config file.
 static bool multiUserAuthorized(std::string strUserPass)
@@ -175,6 +259,7 @@ static bool HTTPReq_JSONRPC(HTTPRequest* req, const std::string &)
         return false;
     }
 
+    HTTPRPCStream stream(req);
     try {
         // Parse request
         UniValue valRequest;
@@ -183,14 +268,27 @@ static bool HTTPReq_JSONRPC(HTTPRequest* req, const std::string &)
 
         // Set the URI
         jreq.URI = req->GetURI();
+        jreq.received = req->GetReceivedTime();
 
         std::string strReply;
         // singleton request
         if (valRequest.isObject()) {
             jreq.parse(valRequest);
+            jreq.stream = &stream;
 
             UniValue result = tableRPC.execute(jreq);
 
+            if (stream.Started()) {
+                // A streamed result is returned empty, anything else is an error the
+                // handler caught and returned in place of the result
+                if (!result.empty()) {
+                    stream.Finish(result, jreq.id);
+                    return false;
+                }
+                stream.Finish(NullUniValue, jreq.id);
+                return true;
+            }
+
             // Send reply
             strReply = JSONRPCReply(result, NullUniValue, jreq.id);
 
@@ -203,15 +301,102 @@ static bool HTTPReq_JSONRPC(HTTPRequest* req, const std::string &)
         req->WriteHeader("Content-Type", "application/json");
         req->WriteReply(HTTP_OK, strReply);
     } catch (const UniValue& objError) {
-        JSONErrorReply(req, objError, jreq.id);
+        if (stream.Started())
+            stream.Finish(objError, jreq.id);
+        else
+            JSONErrorReply(req, objError, jreq.id);
         return false;
     } catch (const std::exception& e) {
-        JSONErrorReply(req, JSONRPCError(RPC_PARSE_ERROR, e.what()), jreq.id);
+        if (stream.Started())
+            stream.Finish(JSONRPCError(RPC_PARSE_ERROR, e.what()), jreq.id);
+        else
+            JSONErrorReply(req, JSONRPCError(RPC_PARSE_ERROR, e.what()), jreq.id);
         return false;
     }
     return true;
 }
 
+/** Scheduling group of a call: its method if limited, else its category if limited */
+static std::string RPCMethodGroup(const std::string& method)
+{
+    if (setRPCLimitedGroups.count(method))
+        return method;
+    const CRPCCommand* pcmd = tableRPC[method];
+    if (pcmd && setRPCLimitedGroups.count(pcmd->category))
+        return pcmd->category;
+    return "";
+}
+
+static HTTPRequestClass HTTPReq_JSONRPC_Classify(HTTPRequest* req, const std::string &)
+{
+    HTTPRequestClass cls;
+    // Unauthenticated requests are rejected by the handler, don't parse their body
+    // on the HTTP thread
+    if (req->GetRequestMethod() != HTTPRequest::POST || !req->GetHeader("authorization").first)
+        return cls;
+    UniValue valRequest;
+    if (!valRequest.read(req->PeekBody(MAX_RPC_CLASSIFY_BODY)))
+        return cls;
+
+    // A batch is only fast if all of its calls are, and is limited by its first limited call
+    std::vector<UniValue> calls;
+    if (valRequest.isObject())
+        calls.push_back(valRequest);
+    else if (valRequest.isArray())
+        calls = valRequest.getValues();
+    if (calls.empty())
+        return cls;
+    cls.fast = true;
+    for (const UniValue& call : calls) {
+        const UniValue& method = call.isObject() ? find_value(call, "method") : NullUniValue;
+        if (!method.isStr()) {
+            cls.fast = false;
+            continue;
+        }
+        const std::string& strMethod = method.get_str();
+        if (!setRPCFastMethods.count(strMethod))
+            cls.fast = false;
+        if (cls.group.empty())
+            cls.group = RPCMethodGroup(strMethod);
+    }
+    if (cls.fast)
+        cls.group.clear();
+    return cls;
+}
+
+/** Parse -rpcfastmethod and -rpcmethodlimit and set up the work queue limits */
+static bool InitRPCScheduling()
+{
+    setRPCFastMethods.clear();
+    setRPCFastMethods.insert(std::begin(DEFAULT_RPC_FAST_METHODS), std::end(DEFAULT_RPC_FAST_METHODS));
+    for (const std::string& method : gArgs.GetArgs("-rpcfastmethod"))
+        setRPCFastMethods.insert(method);
+
+    std::map<std::string, int64_t> limits;
+    std::vector<std::string> vLimits(std::begin(DEFAULT_RPC_METHOD_LIMITS), std::end(DEFAULT_RPC_METHOD_LIMITS));
+    for (const std::string& strLimit : gArgs.GetArgs("-rpcmethodlimit"))
+        vLimits.push_back(strLimit);
+    for (const std::string& strLimit : vLimits) {
+        const size_t pos = strLimit.rfind(':');
+        int64_t limit;
+        if (pos == std::string::npos || pos == 0 || !ParseInt64(strLimit.substr(pos + 1), &limit) || limit < 0) {
+            uiInterface.ThreadSafeMessageBox(
+                strprintf(_("Invalid -rpcmethodlimit '%s', expected <method or category>:<n>"), strLimit),
+                "", CClientUIInterface::MSG_ERROR);
+            return false;
+        }
+        limits[strLimit.substr(0, pos)] = limit;
+    }
+
+    setRPCLimitedGroups.clear();
+    for (const auto& limit : limits) {
+        SetHTTPConcurrencyLimit(limit.first, limit.second);
+        if (limit.second > 0)
+            setRPCLimitedGroups.insert(limit.first);
+    }
+    return true;
+}
+
 static bool InitRPCAuthentication()
 {
     if (gArgs.GetArg("-rpcpassword", "") == "")
@@ -239,10 +424,12 @@ bool StartHTTPRPC()
     LogPrint(BCLog::RPC, "Starting HTTP RPC server\n");
     if (!InitRPCAuthentication())
         return false;
+    if (!InitRPCScheduling())
+        return false;
 
-    RegisterHTTPHandler("/", true, HTTPReq_JSONRPC);
+    RegisterHTTPHandler("/", true, HTTPReq_JSONRPC, HTTPReq_JSONRPC_Classify);
     if (g_wallet_init_interface.HasWalletSupport()) {
-        RegisterHTTPHandler("/wallet/", false, HTTPReq_JSONRPC);
+        RegisterHTTPHandler("/wallet/", false, HTTPReq_JSONRPC, HTTPReq_JSONRPC_Classify);
     }
     struct event_base* eventBase = EventBase();
     assert(eventBase);
@@ -14,6 +14,9 @@
 #include <sync.h>
 #include <ui_interface.h>
 
+#include <chrono>
+#include <deque>
+#include <map>
 #include <memory>
 #include <stdio.h>
 #include <stdlib.h>
@@ -41,6 +44,21 @@
 /** Maximum size of http request (request line + headers) */
 static const size_t MAX_HEADERS_SIZE = 8192;
 
+/** State of a chunked reply, shared between the worker thread producing the
+ * body and the http thread writing it to the socket.
+ */
+struct HTTPChunkedReply
+{
+    Mutex cs;
+    std::condition_variable cond;
+    /** Bytes handed to the http thread that were not added to the connection yet */
+    size_t queued GUARDED_BY(cs){0};
+    /** Bytes added to the connection that were not flushed to the socket yet */
+    size_t sending GUARDED_BY(cs){0};
+    /** Set by the http thread when the connection was closed, the request is freed */
+    bool closed GUARDED_BY(cs){false};
+};
+
 /** HTTP request work item */
 class HTTPWorkItem final : public HTTPClosure
 {
@@ -63,17 +81,47 @@ private:
 
 /** Simple work queue for distributing work over multiple threads.
  * Work items are simply callable objects.
+ *
+ * Workers take the oldest item they may run: an item whose group is at its
+ * concurrency limit is skipped until a running item of the group finishes, and
+ * fast lane workers only take items marked fast. Fast items have their own depth
+ * so a queue full of slow items does not reject them.
  */
 template <typename WorkItem>
 class WorkQueue
 {
 private:
+    struct Entry
+    {
+        std::unique_ptr<WorkItem> item;
+        bool fast;
+        std::string group;
+    };
+
     /** Mutex protects entire object */
     Mutex cs;
     std::condition_variable cond;
-    std::deque<std::unique_ptr<WorkItem>> queue;
+    std::deque<Entry> queue;
     bool running;
     size_t maxDepth;
+    size_t fastDepth{0};
+    std::map<std::string, size_t> groupLimit;
+    std::map<std::string, size_t> groupActive;
+
+    typename std::deque<Entry>::iterator NextRunnable(bool fastOnly)
+    {
+        for (auto it = queue.begin(); it != queue.end(); ++it) {
+            if (fastOnly && !it->fast)
+                continue;
+            if (!it->group.empty()) {
+                auto limit = groupLimit.find(it->group);
+                if (limit != groupLimit.end() && groupActive[it->group] >= limit->second)
+                    continue;
+            }
+            return it;
+        }
+        return queue.end();
+    }
 
 public:
     explicit WorkQueue(size_t _maxDepth) : running(true),
@@ -86,31 +134,57 @@ public:
     {
     }
     /** Enqueue a work item */
-    bool Enqueue(WorkItem* item)
+    bool Enqueue(WorkItem* item, bool fast = false, const std::string& group = "")
     {
         LOCK(cs);
-        if (queue.size() >= maxDepth) {
+        if ((fast ? fastDepth : queue.size() - fastDepth) >= maxDepth) {
             return false;
         }
-        queue.emplace_back(std::unique_ptr<WorkItem>(item));
-        cond.notify_one();
+        queue.push_back(Entry{std::unique_ptr<WorkItem>(item), fast, group});
+        if (fast)
+            ++fastDepth;
+        // Not every worker may run every item
+        cond.notify_all();
         return true;
     }
+    /** Set the concurrency limit of a group, 0 for none */
+    void SetLimit(const std::string& group, size_t limit)
+    {
+        LOCK(cs);
+        if (limit == 0)
+            groupLimit.erase(group);
+        else
+            groupLimit[group] = limit;
+        cond.notify_all();
+    }
     /** Thread function */
-    void Run()
+    void Run(bool fastOnly = false)
     {
         while (true) {
             std::unique_ptr<WorkItem> i;
+            std::string group;
             {
                 WAIT_LOCK(cs, lock);
-                while (running && queue.empty())
+                auto it = queue.end();
+                while (running && (it = NextRunnable(fastOnly)) == queue.end())
                     cond.wait(lock);
                 if (!running)
                     break;
-                i = std::move(queue.front());
-                queue.pop_front();
+                i = std::move(it->item);
+                group = std::move(it->group);
+                if (it->fast)
+                    --fastDepth;
+                queue.erase(it);
+                if (!group.empty())
+                    ++groupActive[group];
             }
             (*i)();
+            if (!group.empty()) {
+                LOCK(cs);
+                --groupActive[group];
+                // Items of the group queued behind the limit may run now
+                cond.notify_all();
+            }
         }
     }
     /** Interrupt and exit loops */
@@ -129,13 +203,14 @@ public:
 
 struct HTTPPathHandler
 {
-    HTTPPathHandler(std::string _prefix, bool _exactMatch, HTTPRequestHandler _handler):
-        prefix(_prefix), exactMatch(_exactMatch), handler(_handler)
+    HTTPPathHandler(std::string _prefix, bool _exactMatch, HTTPRequestHandler _handler, HTTPRequestClassifier _classifier):
+        prefix(_prefix), exactMatch(_exactMatch), handler(_handler), classifier(_classifier)
     {
     }
     std::string prefix;
     bool exactMatch;
     HTTPRequestHandler handler;
+    HTTPRequestClassifier classifier;
 };
 
 /** HTTP module state */
@@ -267,9 +342,12 @@ static void http_request_cb(struct evhttp_request* req, void* arg)
 
     // Dispatch to worker thread
     if (i != iend) {
+        HTTPRequestClass cls;
+        if (i->classifier)
+            cls = i->classifier(hreq.get(), path);
         std::unique_ptr<HTTPWorkItem> item(new HTTPWorkItem(std::move(hreq), path, i->handler));
         assert(workQueue);
-        if (workQueue->Enqueue(item.get()))
+        if (workQueue->Enqueue(item.get(), cls.fast, cls.group))
             item.release(); /* if true, queue took ownership */
         else {
             LogPrintf("WARNING: request rejected because http work queue depth exceeded, it can be increased with the -rpcworkqueue= setting\n");
@@ -341,10 +419,10 @@ static bool HTTPBindAddresses(struct evhttp* http)
 }
 
 /** Simple wrapper to set thread name and run work queue */
-static void HTTPWorkQueueRun(WorkQueue<HTTPClosure>* queue)
+static void HTTPWorkQueueRun(WorkQueue<HTTPClosure>* queue, bool fastOnly)
 {
-    RenameThread("blocknet-httpworker");
-    queue->Run();
+    RenameThread(fastOnly ? "blocknet-httpfast" : "blocknet-httpworker");
+    queue->Run(fastOnly);
 }
 
 /** libevent event log callback */
@@ -432,11 +510,15 @@ void StartHTTPServer()
 {
     LogPrint(BCLog::HTTP, "Starting HTTP server\n");
     int rpcThreads = std::max((long)gArgs.GetArg("-rpcthreads", DEFAULT_HTTP_THREADS), 1L);
-    LogPrintf("HTTP: starting %d worker threads\n", rpcThreads);
+    int rpcFastThreads = std::max((long)gArgs.GetArg("-rpcfastthreads", DEFAULT_HTTP_FAST_THREADS), 0L);
+    LogPrintf("HTTP: starting %d worker threads and %d fast lane threads\n", rpcThreads, rpcFastThreads);
     threadHTTP = std::thread(ThreadHTTP, eventBase);
 
     for (int i = 0; i < rpcThreads; i++) {
-        g_thread_http_workers.emplace_back(HTTPWorkQueueRun, workQueue);
+        g_thread_http_workers.emplace_back(HTTPWorkQueueRun, workQueue, false);
+    }
+    for (int i = 0; i < rpcFastThreads; i++) {
+        g_thread_http_workers.emplace_back(HTTPWorkQueueRun, workQueue, true);
     }
 }
 
@@ -516,11 +598,16 @@ void HTTPEvent::trigger(struct timeval* tv)
         evtimer_add(ev, tv); // trigger after timeval passed
 }
 HTTPRequest::HTTPRequest(struct evhttp_request* _req) : req(_req),
-                                                       replySent(false)
+                                                       replySent(false),
+                                                       receivedTime(GetTimeMicros())
 {
 }
 HTTPRequest::~HTTPRequest()
 {
+    if (chunked && req) {
+        LogPrintf("%s: Unfinished chunked reply\n", __func__);
+        EndChunkedReply();
+    }
     if (!replySent) {
         // Keep track of whether reply was sent to avoid request leaks
         LogPrintf("%s: Unhandled request\n", __func__);
@@ -560,6 +647,20 @@ std::string HTTPRequest::ReadBody()
     return rv;
 }
 
+std::string HTTPRequest::PeekBody(size_t maxSize) const
+{
+    struct evbuffer* buf = evhttp_request_get_input_buffer(req);
+    if (!buf)
+        return "";
+    size_t size = evbuffer_get_length(buf);
+    if (size > maxSize)
+        return "";
+    const char* data = (const char*)evbuffer_pullup(buf, size);
+    if (!data)
+        return "";
+    return std::string(data, size);
+}
+
 void HTTPRequest::WriteHeader(const std::string& hdr, const std::string& value)
 {
     struct evkeyvalq* headers = evhttp_request_get_output_headers(req);
@@ -567,6 +668,22 @@ void HTTPRequest::WriteHeader(const std::string& hdr, const std::string& value)
     evhttp_add_header(headers, hdr.c_str(), value.c_str());
 }
 
+/** Re-enable reading from the socket once a reply is started. This is the second
+ * part of the libevent workaround in http_request_cb.
+ */
+static void http_enable_read(struct evhttp_request* req)
+{
+    if (event_get_version_number() >= 0x02010600 && event_get_version_number() < 0x02020001) {
+        evhttp_connection* conn = evhttp_request_get_connection(req);
+        if (conn) {
+            bufferevent* bev = evhttp_connection_get_bufferevent(conn);
+            if (bev) {
+                bufferevent_enable(bev, EV_READ | EV_WRITE);
+            }
+        }
+    }
+}
+
 /** Closure sent to main thread to request a reply to be sent to
  * a HTTP request.
  * Replies must be sent in the main loop in the main http thread,
@@ -585,20 +702,118 @@ void HTTPRequest::WriteReply(int nStatus, const std::string& strReply)
     auto req_copy = req;
     HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy, nStatus]{
         evhttp_send_reply(req_copy, nStatus, nullptr, nullptr);
-        // Re-enable reading from the socket. This is the second part of the libevent
-        // workaround above.
-        if (event_get_version_number() >= 0x02010600 && event_get_version_number() < 0x02020001) {
-            evhttp_connection* conn = evhttp_request_get_connection(req_copy);
-            if (conn) {
-                bufferevent* bev = evhttp_connection_get_bufferevent(conn);
-                if (bev) {
-                    bufferevent_enable(bev, EV_READ | EV_WRITE);
-                }
+        http_enable_read(req_copy);
+    });
+    ev->trigger(nullptr);
+    replySent = true;
+    req = nullptr; // transferred back to main thread
+}
+
+/** Called on the http thread when all chunks added so far were written to the socket */
+static void http_chunk_flushed_cb(struct evhttp_connection* conn, void* arg)
+{
+    auto state = static_cast<HTTPChunkedReply*>(arg);
+    LOCK(state->cs);
+    state->sending = 0;
+    state->cond.notify_all();
+}
+
+/** Called on the http thread when the connection of a chunked reply is closed */
+static void http_chunk_closed_cb(struct evhttp_connection* conn, void* arg)
+{
+    auto state = static_cast<HTTPChunkedReply*>(arg);
+    LOCK(state->cs);
+    state->closed = true;
+    state->cond.notify_all();
+}
+
+/** Chunked replies are started, sent and ended on the main http thread like
+ * WriteReply. The worker thread only blocks when the client reads slower than
+ * the reply is produced, which bounds the memory held by a reply.
+ */
+void HTTPRequest::StartChunkedReply(int nStatus)
+{
+    assert(!replySent && req);
+    if (ShutdownRequested()) {
+        WriteHeader("Connection", "close");
+    }
+    chunked = std::make_shared<HTTPChunkedReply>();
+    auto req_copy = req;
+    auto state = chunked;
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy, state, nStatus]{
+        evhttp_connection* conn = evhttp_request_get_connection(req_copy);
+        if (conn)
+            evhttp_connection_set_closecb(conn, http_chunk_closed_cb, state.get());
+        evhttp_send_reply_start(req_copy, nStatus, nullptr);
+        http_enable_read(req_copy);
+    });
+    ev->trigger(nullptr);
+    replySent = true;
+}
+
+bool HTTPRequest::WriteChunk(const std::string& chunk)
+{
+    assert(chunked && req);
+    if (chunk.empty())
+        return true;
+    {
+        WAIT_LOCK(chunked->cs, lock);
+        const auto deadline = std::chrono::steady_clock::now() +
+                              std::chrono::seconds(gArgs.GetArg("-rpcservertimeout", DEFAULT_HTTP_SERVER_TIMEOUT));
+        while (!chunked->closed && chunked->queued + chunked->sending > MAX_HTTP_CHUNKED_PENDING) {
+            if (ShutdownRequested() || std::chrono::steady_clock::now() >= deadline) {
+                LogPrint(BCLog::HTTP, "Chunked reply stalled, %u bytes pending\n", chunked->queued + chunked->sending);
+                return false;
             }
+            chunked->cond.wait_for(lock, std::chrono::milliseconds(100));
         }
+        if (chunked->closed)
+            return false;
+        chunked->queued += chunk.size();
+    }
+    // evbuffers are thread-safe, fill it here to keep the copy off the http thread
+    struct evbuffer* evb = evbuffer_new();
+    assert(evb);
+    evbuffer_add(evb, chunk.data(), chunk.size());
+    auto req_copy = req;
+    auto state = chunked;
+    const size_t size = chunk.size();
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy, state, evb, size]{
+        {
+            LOCK(state->cs);
+            state->queued -= size;
+            if (!state->closed)
+                state->sending += size;
+            state->cond.notify_all();
+            if (state->closed) {
+                evbuffer_free(evb);
+                return;
+            }
+        }
+        evhttp_send_reply_chunk_with_cb(req_copy, evb, http_chunk_flushed_cb, state.get());
+        evbuffer_free(evb);
+    });
+    ev->trigger(nullptr);
+    return true;
+}
+
+void HTTPRequest::EndChunkedReply()
+{
+    assert(chunked && req);
+    auto req_copy = req;
+    auto state = chunked;
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy, state]{
+        {
+            LOCK(state->cs);
+            if (state->closed)
+                return;
+        }
+        evhttp_connection* conn = evhttp_request_get_connection(req_copy);
+        if (conn)
+            evhttp_connection_set_closecb(conn, nullptr, nullptr);
+        evhttp_send_reply_end(req_copy);
     });
     ev->trigger(nullptr);
-    replySent = true;
     req = nullptr; // transferred back to main thread
 }
 
@@ -642,10 +857,18 @@ HTTPRequest::RequestMethod HTTPRequest::GetRequestMethod() const
     }
 }
 
-void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPRequestHandler &handler)
+void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPRequestHandler &handler,
+                         const HTTPRequestClassifier &classifier)
 {
     LogPrint(BCLog::HTTP, "Registering HTTP handler for %s (exactmatch %d)\n", prefix, exactMatch);
-    pathHandlers.push_back(HTTPPathHandler(prefix, exactMatch, handler));
+    pathHandlers.push_back(HTTPPathHandler(prefix, exactMatch, handler, classifier));
+}
+
+void SetHTTPConcurrencyLimit(const std::string &group, size_t limit)
+{
+    assert(workQueue);
+    LogPrint(BCLog::HTTP, "Limiting HTTP request group %s to %u concurrent requests\n", group, limit);
+    workQueue->SetLimit(group, limit);
 }
 
 void UnregisterHTTPHandler(const std::string &prefix, bool exactMatch)
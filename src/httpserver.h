@@ -8,15 +8,20 @@
 #include <string>
 #include <stdint.h>
 #include <functional>
+#include <memory>
 
 static const int DEFAULT_HTTP_THREADS=4;
+static const int DEFAULT_HTTP_FAST_THREADS=1;
 static const int DEFAULT_HTTP_WORKQUEUE=16;
 static const int DEFAULT_HTTP_SERVER_TIMEOUT=30;
+/** Maximum bytes of a chunked reply waiting to be written to the socket before WriteChunk blocks */
+static const size_t MAX_HTTP_CHUNKED_PENDING=1024*1024;
 
 struct evhttp_request;
 struct event_base;
 class CService;
 class HTTPRequest;
+struct HTTPChunkedReply;
 
 /** Initialize HTTP server.
  * Call this before RegisterHTTPHandler or EventBase().
@@ -38,14 +43,34 @@ bool UpdateHTTPServerLogging(bool enable);
 
 /** Handler for requests to a certain HTTP path */
 typedef std::function<bool(HTTPRequest* req, const std::string &)> HTTPRequestHandler;
+/** How a request is scheduled on the work queue */
+struct HTTPRequestClass
+{
+    /** Cheap request, the fast lane workers pick it up besides the regular workers */
+    bool fast{false};
+    /** Requests of a group share the concurrency limit set with SetHTTPConcurrencyLimit, empty for none */
+    std::string group;
+};
+/** Classifies a request for a certain HTTP path before it is queued. This runs on
+ * the HTTP thread so it must be cheap.
+ */
+typedef std::function<HTTPRequestClass(HTTPRequest* req, const std::string &)> HTTPRequestClassifier;
 /** Register handler for prefix.
  * If multiple handlers match a prefix, the first-registered one will
- * be invoked.
+ * be invoked. Requests are not classified if no classifier is given.
  */
-void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPRequestHandler &handler);
+void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPRequestHandler &handler,
+                         const HTTPRequestClassifier &classifier = nullptr);
 /** Unregister handler for prefix */
 void UnregisterHTTPHandler(const std::string &prefix, bool exactMatch);
 
+/** Limit the number of requests of a group that are processed at the same time,
+ * 0 removes the limit. Requests of a group at its limit stay queued while the
+ * workers take the requests queued behind them.
+ * Call this after InitHTTPServer.
+ */
+void SetHTTPConcurrencyLimit(const std::string &group, size_t limit);
+
 /** Return evhttp event base. This can be used by submodules to
  * queue timers or custom events.
  */
@@ -59,6 +84,8 @@ class HTTPRequest
 private:
     struct evhttp_request* req;
     bool replySent;
+    std::shared_ptr<HTTPChunkedReply> chunked;
+    const int64_t receivedTime;
 
 public:
     explicit HTTPRequest(struct evhttp_request* req);
@@ -98,6 +125,15 @@ public:
      */
     std::string ReadBody();
 
+    /**
+     * Read request body without consuming it. Returns an empty string if the body
+     * is larger than maxSize.
+     */
+    std::string PeekBody(size_t maxSize) const;
+
+    /** Time the request was received in microseconds */
+    int64_t GetReceivedTime() const { return receivedTime; }
+
     /**
      * Write output header.
      *
@@ -114,6 +150,29 @@ public:
      * main thread, do not call any other HTTPRequest methods after calling this.
      */
     void WriteReply(int nStatus, const std::string& strReply = "");
+
+    /**
+     * Start a chunked HTTP reply. The body is sent in parts with WriteChunk and
+     * completed with EndChunkedReply.
+     *
+     * @note Write the headers before calling this. Do not call WriteReply afterwards.
+     */
+    void StartChunkedReply(int nStatus);
+
+    /**
+     * Send part of a chunked reply. Blocks while more than MAX_HTTP_CHUNKED_PENDING
+     * bytes have not been written to the socket yet.
+     * Returns false if the client disconnected or did not read the reply within
+     * -rpcservertimeout seconds, in which case the reply should be ended early.
+     */
+    bool WriteChunk(const std::string& chunk);
+
+    /**
+     * Complete a chunked reply.
+     *
+     * @note As with WriteReply, do not call any other HTTPRequest methods after calling this.
+     */
+    void EndChunkedReply();
 };
 
 /** Event handler closure.
@@ -0,0 +1,296 @@
+// Copyright (c) 2020 The Blocknet developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <index/addressindex.h>
+
+#include <hash.h>
+#include <undo.h>
+#include <util/system.h>
+#include <validation.h>
+
+/* The index database stores two record types, both keyed by the Hash160 of the scriptPubKey so
+ * that all records of a script are adjacent.
+ *
+ * Keys for the delta index have the type [DB_ADDRESS_DELTA, uint160, uint32 (BE) height, uint256
+ * txid, uint32 (BE) index, uint8 spending] and map to the signed amount. The height is represented
+ * as big-endian so that the history of a script is iterated in chain order.
+ * Keys for the unspent index have the type [DB_ADDRESS_UNSPENT, uint160, uint256 txid, uint32 (BE)
+ * vout] and map to the amount and height of the output.
+ *
+ * Spent outputs are resolved from the block undo data. On a reorg the disconnected blocks are read
+ * back from disk and their records are removed, restoring any unspent records they had erased.
+ */
+constexpr char DB_ADDRESS_DELTA = 'a';
+constexpr char DB_ADDRESS_UNSPENT = 'u';
+
+std::unique_ptr<AddressIndex> g_addressindex;
+
+namespace {
+
+struct DBDeltaKey {
+    uint160 hash;
+    int height;
+    uint256 txid;
+    uint32_t index;
+    bool spending;
+
+    DBDeltaKey() : height(0), index(0), spending(false) {}
+    DBDeltaKey(const uint160& hash_in, int height_in, const uint256& txid_in, uint32_t index_in, bool spending_in)
+        : hash(hash_in), height(height_in), txid(txid_in), index(index_in), spending(spending_in) {}
+
+    template<typename Stream>
+    void Serialize(Stream& s) const
+    {
+        ser_writedata8(s, DB_ADDRESS_DELTA);
+        hash.Serialize(s);
+        ser_writedata32be(s, height);
+        txid.Serialize(s);
+        ser_writedata32be(s, index);
+        ser_writedata8(s, spending);
+    }
+
+    template<typename Stream>
+    void Unserialize(Stream& s)
+    {
+        char prefix = ser_readdata8(s);
+        if (prefix != DB_ADDRESS_DELTA) {
+            throw std::ios_base::failure("Invalid format for address index DB delta key");
+        }
+        hash.Unserialize(s);
+        height = ser_readdata32be(s);
+        txid.Unserialize(s);
+        index = ser_readdata32be(s);
+        spending = ser_readdata8(s) != 0;
+    }
+};
+
+struct DBUnspentKey {
+    uint160 hash;
+    uint256 txid;
+    uint32_t n;
+
+    DBUnspentKey() : n(0) {}
+    DBUnspentKey(const uint160& hash_in, const uint256& txid_in, uint32_t n_in)
+        : hash(hash_in), txid(txid_in), n(n_in) {}
+
+    template<typename Stream>
+    void Serialize(Stream& s) const
+    {
+        ser_writedata8(s, DB_ADDRESS_UNSPENT);
+        hash.Serialize(s);
+        txid.Serialize(s);
+        ser_writedata32be(s, n);
+    }
+
+    template<typename Stream>
+    void Unserialize(Stream& s)
+    {
+        char prefix = ser_readdata8(s);
+        if (prefix != DB_ADDRESS_UNSPENT) {
+            throw std::ios_base::failure("Invalid format for address index DB unspent key");
+        }
+        hash.Unserialize(s);
+        txid.Unserialize(s);
+        n = ser_readdata32be(s);
+    }
+};
+
+struct DBUnspentVal {
+    CAmount amount;
+    int height;
+
+    DBUnspentVal() : amount(0), height(0) {}
+    DBUnspentVal(CAmount amount_in, int height_in) : amount(amount_in), height(height_in) {}
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(amount);
+        READWRITE(height);
+    }
+};
+
+/** Outputs without a script (e.g. the coinstake marker) and provably unspendable outputs are not indexed. */
+bool IsIndexed(const CScript& script)
+{
+    return !script.empty() && !script.IsUnspendable();
+}
+
+} // namespace
+
+AddressIndex::AddressIndex(size_t n_cache_size, bool f_memory, bool f_wipe)
+    : m_db(MakeUnique<BaseIndex::DB>(GetDataDir() / "indexes" / "addressindex", n_cache_size, f_memory, f_wipe))
+{}
+
+uint160 AddressIndex::ScriptHash(const CScript& script)
+{
+    return Hash160(script.begin(), script.end());
+}
+
+bool AddressIndex::WriteBlock(const CBlock& block, const CBlockIndex* pindex)
+{
+    // The genesis outputs are not part of the utxo set
+    if (pindex->nHeight == 0) return true;
+
+    CBlockUndo block_undo;
+    if (!UndoReadFromDisk(block_undo, pindex)) {
+        return error("%s: Failed to read undo data for block %s", __func__, pindex->GetBlockHash().ToString());
+    }
+    if (block_undo.vtxundo.size() + 1 != block.vtx.size()) {
+        return error("%s: Undo data does not match block %s", __func__, pindex->GetBlockHash().ToString());
+    }
+
+    // Transactions are processed in block order so that an output created and spent in
+    // the same block is erased after it was written in the batch.
+    CDBBatch batch(*m_db);
+    for (size_t i = 0; i < block.vtx.size(); ++i) {
+        const CTransaction& tx = *block.vtx[i];
+        const uint256& txid = tx.GetHash();
+
+        if (i > 0) {
+            const CTxUndo& tx_undo = block_undo.vtxundo[i - 1];
+            for (size_t j = 0; j < tx.vin.size(); ++j) {
+                const Coin& coin = tx_undo.vprevout[j];
+                if (!IsIndexed(coin.out.scriptPubKey)) continue;
+                const uint160 hash = ScriptHash(coin.out.scriptPubKey);
+                const COutPoint& prevout = tx.vin[j].prevout;
+                batch.Write(DBDeltaKey(hash, pindex->nHeight, txid, j, true), -coin.out.nValue);
+                batch.Erase(DBUnspentKey(hash, prevout.hash, prevout.n));
+            }
+        }
+
+        for (size_t k = 0; k < tx.vout.size(); ++k) {
+            const CTxOut& out = tx.vout[k];
+            if (!IsIndexed(out.scriptPubKey)) continue;
+            const uint160 hash = ScriptHash(out.scriptPubKey);
+            batch.Write(DBDeltaKey(hash, pindex->nHeight, txid, k, false), out.nValue);
+            batch.Write(DBUnspentKey(hash, txid, k), DBUnspentVal(out.nValue, pindex->nHeight));
+        }
+    }
+
+    return m_db->WriteBatch(batch);
+}
+
+bool AddressIndex::Rewind(const CBlockIndex* current_tip, const CBlockIndex* new_tip)
+{
+    assert(current_tip->GetAncestor(new_tip->nHeight) == new_tip);
+
+    const Consensus::Params& consensus_params = Params().GetConsensus();
+    CDBBatch batch(*m_db);
+
+    for (const CBlockIndex* pindex = current_tip; pindex != new_tip; pindex = pindex->pprev) {
+        CBlock block;
+        if (!ReadBlockFromDisk(block, pindex, consensus_params)) {
+            return error("%s: Failed to read block %s from disk", __func__, pindex->GetBlockHash().ToString());
+        }
+        CBlockUndo block_undo;
+        if (!UndoReadFromDisk(block_undo, pindex) || block_undo.vtxundo.size() + 1 != block.vtx.size()) {
+            return error("%s: Failed to read undo data for block %s", __func__, pindex->GetBlockHash().ToString());
+        }
+
+        // Undo in reverse block order, mirroring WriteBlock
+        for (size_t i = block.vtx.size(); i-- > 0;) {
+            const CTransaction& tx = *block.vtx[i];
+            const uint256& txid = tx.GetHash();
+
+            for (size_t k = 0; k < tx.vout.size(); ++k) {
+                const CTxOut& out = tx.vout[k];
+                if (!IsIndexed(out.scriptPubKey)) continue;
+                const uint160 hash = ScriptHash(out.scriptPubKey);
+                batch.Erase(DBDeltaKey(hash, pindex->nHeight, txid, k, false));
+                batch.Erase(DBUnspentKey(hash, txid, k));
+            }
+
+            if (i == 0) continue;
+            const CTxUndo& tx_undo = block_undo.vtxundo[i - 1];
+            for (size_t j = 0; j < tx.vin.size(); ++j) {
+                const Coin& coin = tx_undo.vprevout[j];
+                if (!IsIndexed(coin.out.scriptPubKey)) continue;
+                const uint160 hash = ScriptHash(coin.out.scriptPubKey);
+                const COutPoint& prevout = tx.vin[j].prevout;
+                batch.Erase(DBDeltaKey(hash, pindex->nHeight, txid, j, true));
+                batch.Write(DBUnspentKey(hash, prevout.hash, prevout.n),
+                            DBUnspentVal(coin.out.nValue, static_cast<int>(coin.nHeight)));
+            }
+        }
+    }
+
+    if (!m_db->WriteBatch(batch)) return false;
+
+    return BaseIndex::Rewind(current_tip, new_tip);
+}
+
+bool AddressIndex::FindDeltas(const CScript& script, int start_height, int end_height,
+                              std::vector<AddressDelta>& deltas) const
+{
+    if (start_height < 0) {
+        return error("%s: start height (%d) is negative", __func__, start_height);
+    }
+    if (end_height != 0 && end_height < start_height) {
+        return error("%s: end height (%d) is less than start height (%d)", __func__, end_height, start_height);
+    }
+
+    const uint160 hash = ScriptHash(script);
+    std::unique_ptr<CDBIterator> db_it(m_db->NewIterator());
+    db_it->Seek(DBDeltaKey(hash, start_height, uint256(), 0, false));
+
+    DBDeltaKey key;
+    while (db_it->Valid() && db_it->GetKey(key) && key.hash == hash) {
+        if (end_height != 0 && key.height > end_height) break;
+
+        AddressDelta delta;
+        if (!db_it->GetValue(delta.amount)) {
+            return error("%s: unable to read value in %s at height %d", __func__, GetName(), key.height);
+        }
+        delta.height = key.height;
+        delta.txid = key.txid;
+        delta.index = key.index;
+        delta.spending = key.spending;
+        deltas.push_back(std::move(delta));
+
+        db_it->Next();
+    }
+    return true;
+}
+
+bool AddressIndex::FindUnspent(const CScript& script, std::vector<AddressUnspent>& unspent) const
+{
+    const uint160 hash = ScriptHash(script);
+    std::unique_ptr<CDBIterator> db_it(m_db->NewIterator());
+    db_it->Seek(DBUnspentKey(hash, uint256(), 0));
+
+    DBUnspentKey key;
+    while (db_it->Valid() && db_it->GetKey(key) && key.hash == hash) {
+        DBUnspentVal value;
+        if (!db_it->GetValue(value)) {
+            return error("%s: unable to read value in %s for %s:%u", __func__, GetName(), key.txid.ToString(), key.n);
+        }
+        AddressUnspent utxo;
+        utxo.outpoint = COutPoint(key.txid, key.n);
+        utxo.amount = value.amount;
+        utxo.height = value.height;
+        unspent.push_back(std::move(utxo));
+
+        db_it->Next();
+    }
+    return true;
+}
+
+bool AddressIndex::GetBalance(const CScript& script, CAmount& balance, CAmount& received) const
+{
+    std::vector<AddressUnspent> unspent;
+    std::vector<AddressDelta> deltas;
+    if (!FindUnspent(script, unspent) || !FindDeltas(script, 0, 0, deltas)) {
+        return false;
+    }
+
+    balance = 0;
+    for (const auto& utxo : unspent) balance += utxo.amount;
+    received = 0;
+    for (const auto& delta : deltas) {
+        if (!delta.spending) received += delta.amount;
+    }
+    return true;
+}
@@ -0,0 +1,78 @@
+// Copyright (c) 2020 The Blocknet developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_INDEX_ADDRESSINDEX_H
+#define BITCOIN_INDEX_ADDRESSINDEX_H
+
+#include <amount.h>
+#include <chain.h>
+#include <index/base.h>
+#include <script/script.h>
+#include <uint256.h>
+
+/** A single credit (funding) or debit (spending) of a script. */
+struct AddressDelta
+{
+    int height{0};
+    uint256 txid;
+    /// Output index when funding, input index when spending.
+    uint32_t index{0};
+    bool spending{false};
+    /// Positive when funding, negative when spending.
+    CAmount amount{0};
+};
+
+/** An output paying to a script that is unspent at the index tip. */
+struct AddressUnspent
+{
+    COutPoint outpoint;
+    CAmount amount{0};
+    int height{0};
+};
+
+/**
+ * AddressIndex maps the hash of a scriptPubKey to every output that paid to it and every input that
+ * spent one of those outputs, along with the set of outputs that are still unspent. Spent outputs
+ * are resolved from the block undo data, so the index does not depend on the txindex.
+ *
+ * This index is used to serve the address RPCs and the XRouter BLOCK balance lookups.
+ */
+class AddressIndex final : public BaseIndex
+{
+private:
+    std::unique_ptr<BaseIndex::DB> m_db;
+
+protected:
+    bool WriteBlock(const CBlock& block, const CBlockIndex* pindex) override;
+
+    bool Rewind(const CBlockIndex* current_tip, const CBlockIndex* new_tip) override;
+
+    BaseIndex::DB& GetDB() const override { return *m_db; }
+
+    const char* GetName() const override { return "addressindex"; }
+
+public:
+    /// Constructs the index, which becomes available to be queried.
+    explicit AddressIndex(size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+
+    /// Key the index uses for a script.
+    static uint160 ScriptHash(const CScript& script);
+
+    /// Look up the credits and debits of a script in the inclusive height range.
+    /// An end_height of 0 means no upper bound.
+    bool FindDeltas(const CScript& script, int start_height, int end_height,
+                    std::vector<AddressDelta>& deltas) const;
+
+    /// Look up the outputs paying to a script that are unspent at the index tip.
+    bool FindUnspent(const CScript& script, std::vector<AddressUnspent>& unspent) const;
+
+    /// Sum of the unspent outputs paying to a script (balance) and of every output
+    /// that ever paid to it (received).
+    bool GetBalance(const CScript& script, CAmount& balance, CAmount& received) const;
+};
+
+/// The global address index. May be null.
+extern std::unique_ptr<AddressIndex> g_addressindex;
+
+#endif // BITCOIN_INDEX_ADDRESSINDEX_H
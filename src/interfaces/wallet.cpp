@@ -437,6 +437,51 @@ public:
         }
         return result;
     }
+    std::vector<COutPoint> listCoinOutPoints() override
+    {
+        auto locked_chain = m_wallet->chain().lock();
+        LOCK(m_wallet->cs_wallet);
+        std::vector<COutput> coins;
+        m_wallet->AvailableCoins(*locked_chain, coins);
+        std::vector<COutPoint> result;
+        result.reserve(coins.size());
+        for (const auto& coin : coins) {
+            if (coin.fSpendable)
+                result.emplace_back(coin.tx->GetHash(), coin.i);
+        }
+        std::vector<COutPoint> lockedCoins;
+        m_wallet->ListLockedCoins(lockedCoins);
+        for (const auto& output : lockedCoins) {
+            auto it = m_wallet->mapWallet.find(output.hash);
+            if (it != m_wallet->mapWallet.end() && it->second.GetDepthInMainChain(*locked_chain) >= 0 &&
+                output.n < it->second.tx->vout.size() &&
+                m_wallet->IsMine(it->second.tx->vout[output.n]) == ISMINE_SPENDABLE) {
+                result.push_back(output);
+            }
+        }
+        return result;
+    }
+    CoinsList listCoins(const std::vector<COutPoint>& outputs) override
+    {
+        auto locked_chain = m_wallet->chain().lock();
+        LOCK(m_wallet->cs_wallet);
+        CoinsList result;
+        for (const auto& output : outputs) {
+            auto it = m_wallet->mapWallet.find(output.hash);
+            if (it == m_wallet->mapWallet.end() || output.n >= it->second.tx->vout.size())
+                continue;
+            const int depth = it->second.GetDepthInMainChain(*locked_chain);
+            if (depth < 0 || m_wallet->IsMine(it->second.tx->vout[output.n]) != ISMINE_SPENDABLE ||
+                m_wallet->IsSpent(*locked_chain, output.hash, output.n)) {
+                continue;
+            }
+            CTxDestination address;
+            if (ExtractDestination(m_wallet->FindNonChangeParentOutput(*it->second.tx, output.n).scriptPubKey, address)) {
+                result[address].emplace_back(output, MakeWalletTxOut(*locked_chain, *m_wallet, it->second, output.n, depth));
+            }
+        }
+        return result;
+    }
     std::vector<WalletTxOut> getCoins(const std::vector<COutPoint>& outputs) override
     {
         auto locked_chain = m_wallet->chain().lock();
@@ -223,6 +223,14 @@ public:
     using CoinsList = std::map<CTxDestination, std::vector<std::tuple<COutPoint, WalletTxOut>>>;
     virtual CoinsList listCoins() = 0;
 
+    //! Return the outpoints of the coins returned by listCoins without looking
+    //! up their details. Use listCoins(outputs) to load them in batches.
+    virtual std::vector<COutPoint> listCoinOutPoints() = 0;
+
+    //! Return the specified coins grouped like listCoins. Coins that are no
+    //! longer available are skipped.
+    virtual CoinsList listCoins(const std::vector<COutPoint>& outputs) = 0;
+
     //! Return wallet transaction output information.
     virtual std::vector<WalletTxOut> getCoins(const std::vector<COutPoint>& outputs) = 0;
 
@@ -212,7 +212,8 @@ std::unique_ptr<CBlockTemplate> BlockAssembler::CreateNewBlock(const CScript& sc
 #ifdef ENABLE_WALLET
 std::unique_ptr<CBlockTemplate> BlockAssembler::CreateNewBlockPoS(const CInputCoin & stakeInput, const uint256 & stakeBlockHash,
                                                                   const int64_t & stakeTime, const int64_t & blockTime,
-                                                                  CWallet *keystore, const bool & disableValidationChecks)
+                                                                  CWallet *keystore, const bool & disableValidationChecks,
+                                                                  const CStakeTemplate *stakeTemplate)
 {
     int64_t nTimeStart = GetTimeMicros();
 
@@ -263,7 +264,20 @@ std::unique_ptr<CBlockTemplate> BlockAssembler::CreateNewBlockPoS(const CInputCo
         // transaction (which in most cases can be a no-op).
         fIncludeWitness = IsWitnessEnabled(pindexPrev, chainparams.GetConsensus());
 
-        addPackageTxs(nPackagesSelected, nDescendantsUpdated);
+        // Reuse the pre-assembled transactions if they were selected on top of this tip,
+        // otherwise fall back to selecting packages now.
+        if (stakeTemplate && stakeTemplate->hashPrevBlock == pindexPrev->GetBlockHash()) {
+            pblock->vtx.insert(pblock->vtx.end(), stakeTemplate->vtx.begin(), stakeTemplate->vtx.end());
+            pblocktemplate->vTxFees.insert(pblocktemplate->vTxFees.end(), stakeTemplate->vTxFees.begin(), stakeTemplate->vTxFees.end());
+            pblocktemplate->vTxSigOpsCost.insert(pblocktemplate->vTxSigOpsCost.end(), stakeTemplate->vTxSigOpsCost.begin(), stakeTemplate->vTxSigOpsCost.end());
+            nBlockWeight = stakeTemplate->nBlockWeight;
+            nBlockTx = stakeTemplate->nBlockTx;
+            nBlockSigOpsCost = stakeTemplate->nBlockSigOpsCost;
+            nFees = stakeTemplate->nFees;
+        } else {
+            stakeTemplate = nullptr;
+            addPackageTxs(nPackagesSelected, nDescendantsUpdated);
+        }
     }
 
     int64_t nTime1 = GetTimeMicros();
@@ -413,10 +427,59 @@ std::unique_ptr<CBlockTemplate> BlockAssembler::CreateNewBlockPoS(const CInputCo
     }
     int64_t nTime2 = GetTimeMicros();
 
-    LogPrint(BCLog::BENCH, "Staking - packages: %.2fms (%d packages, %d updated descendants), validity: %.2fms (total %.2fms)\n", 0.001 * (nTime1 - nTimeStart), nPackagesSelected, nDescendantsUpdated, 0.001 * (nTime2 - nTime1), 0.001 * (nTime2 - nTimeStart));
+    LogPrint(BCLog::BENCH, "Staking - packages: %.2fms (%d packages, %d updated descendants, %s), validity: %.2fms (total %.2fms)\n", 0.001 * (nTime1 - nTimeStart), nPackagesSelected, nDescendantsUpdated, stakeTemplate ? "pre-assembled" : "selected", 0.001 * (nTime2 - nTime1), 0.001 * (nTime2 - nTimeStart));
 
     return std::move(pblocktemplate);
 }
+
+std::unique_ptr<CStakeTemplate> BlockAssembler::CreateStakeTemplate()
+{
+    int64_t nTimeStart = GetTimeMicros();
+
+    resetBlock();
+
+    pblocktemplate.reset(new CBlockTemplate());
+    pblock = &pblocktemplate->block; // pointer for convenience
+
+    std::unique_ptr<CStakeTemplate> stakeTemplate(new CStakeTemplate());
+    int nPackagesSelected = 0;
+    int nDescendantsUpdated = 0;
+
+    {
+        LOCK2(cs_main, mempool.cs);
+        CBlockIndex* pindexPrev = chainActive.Tip();
+        if (!pindexPrev)
+            return nullptr;
+        nHeight = pindexPrev->nHeight + 1;
+
+        // Package selection only depends on the locktime cutoff, which is the median
+        // time past of the tip and therefore does not change until the tip does.
+        pblock->nTime = GetAdjustedTime();
+        nLockTimeCutoff = (STANDARD_LOCKTIME_VERIFY_FLAGS & LOCKTIME_MEDIAN_TIME_PAST)
+                           ? pindexPrev->GetMedianTimePast()
+                           : pblock->GetBlockTime();
+        fIncludeWitness = IsWitnessEnabled(pindexPrev, chainparams.GetConsensus());
+
+        addPackageTxs(nPackagesSelected, nDescendantsUpdated);
+
+        stakeTemplate->hashPrevBlock = pindexPrev->GetBlockHash();
+        stakeTemplate->nHeight = nHeight;
+        stakeTemplate->nTransactionsUpdated = mempool.GetTransactionsUpdated();
+    }
+
+    stakeTemplate->nTimeCreated = GetTime();
+    stakeTemplate->vtx = std::move(pblock->vtx);
+    stakeTemplate->vTxFees = std::move(pblocktemplate->vTxFees);
+    stakeTemplate->vTxSigOpsCost = std::move(pblocktemplate->vTxSigOpsCost);
+    stakeTemplate->nBlockWeight = nBlockWeight;
+    stakeTemplate->nBlockTx = nBlockTx;
+    stakeTemplate->nBlockSigOpsCost = nBlockSigOpsCost;
+    stakeTemplate->nFees = nFees;
+
+    LogPrint(BCLog::BENCH, "Staking - template for height %d: %.2fms (%d packages, %d updated descendants, %u txs)\n", nHeight, 0.001 * (GetTimeMicros() - nTimeStart), nPackagesSelected, nDescendantsUpdated, nBlockTx);
+
+    return stakeTemplate;
+}
 #endif // ENABLE_WALLET
 
 void BlockAssembler::onlyUnconfirmed(CTxMemPool::setEntries& testSet)
@@ -39,6 +39,24 @@ struct CBlockTemplate
     std::vector<unsigned char> vchCoinbaseCommitment;
 };
 
+/** Mempool transactions selected for a PoS block ahead of a kernel hit. Everything
+ *  except the coinbase, coinstake and block signature is ready to be reused as long
+ *  as the chain tip has not changed. */
+struct CStakeTemplate
+{
+    uint256 hashPrevBlock;
+    int nHeight{0};
+    unsigned int nTransactionsUpdated{0}; // mempool update counter at assembly time
+    int64_t nTimeCreated{0};
+    std::vector<CTransactionRef> vtx;
+    std::vector<CAmount> vTxFees;
+    std::vector<int64_t> vTxSigOpsCost;
+    uint64_t nBlockWeight{0};
+    uint64_t nBlockTx{0};
+    uint64_t nBlockSigOpsCost{0};
+    CAmount nFees{0};
+};
+
 // Container for tracking updates to ancestor feerate as we include (parent)
 // transactions in a block
 struct CTxMemPoolModifiedEntry {
@@ -170,7 +188,10 @@ public:
     /** Construct new PoS block */
     std::unique_ptr<CBlockTemplate> CreateNewBlockPoS(const CInputCoin & stakeInput, const uint256 & stakeBlockHash,
                                                       const int64_t & stakeTime, const int64_t & blockTime,
-                                                      CWallet *keystore, const bool & disableValidationChecks = false);
+                                                      CWallet *keystore, const bool & disableValidationChecks = false,
+                                                      const CStakeTemplate *stakeTemplate = nullptr);
+    /** Select mempool transactions for the next PoS block on top of the current tip */
+    std::unique_ptr<CStakeTemplate> CreateStakeTemplate();
 #endif // ENABLE_WALLET
 
     static Optional<int64_t> m_last_block_num_txs;
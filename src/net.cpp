@@ -31,6 +31,10 @@
 #include <poll.h>
 #endif
 
+#ifdef USE_EPOLL
+#include <sys/epoll.h>
+#endif
+
 #ifdef USE_UPNP
 #include <miniupnpc/miniupnpc.h>
 #include <miniupnpc/miniwget.h>
@@ -70,6 +74,11 @@ enum BindFlags {
 // The sleep time needs to be small to avoid new sockets stalling
 static const uint64_t SELECT_TIMEOUT_MILLISECONDS = 50;
 
+#ifdef USE_EPOLL
+/** Maximum number of events returned by one epoll_wait, the rest is returned by the next one */
+static const int EPOLL_MAX_EVENTS = 1024;
+#endif
+
 const std::string NET_MESSAGE_COMMAND_OTHER = "*other*";
 
 static const uint64_t RANDOMIZER_ID_NETGROUP = 0x6c0edd8036ef4036ULL; // SHA256("netgroup")[0:8]
@@ -87,6 +96,77 @@ std::string strSubVersion;
 
 limitedmap<uint256, int64_t> mapAlreadyAskedFor(MAX_INV_SZ);
 
+bool ParseSocketEventsMode(const std::string& str, SocketEventsMode& mode)
+{
+    if (str == "select") {
+        mode = SOCKETEVENTS_SELECT;
+        return true;
+    }
+#ifdef USE_POLL
+    if (str == "poll") {
+        mode = SOCKETEVENTS_POLL;
+        return true;
+    }
+#endif
+#ifdef USE_EPOLL
+    if (str == "epoll") {
+        mode = SOCKETEVENTS_EPOLL;
+        return true;
+    }
+#endif
+    return false;
+}
+
+std::string SocketEventsModeToString(SocketEventsMode mode)
+{
+    switch (mode) {
+    case SOCKETEVENTS_SELECT: return "select";
+    case SOCKETEVENTS_POLL: return "poll";
+    case SOCKETEVENTS_EPOLL: return "epoll";
+    }
+    return "unknown";
+}
+
+std::string GetSupportedSocketEventsModes()
+{
+    std::string modes = "select";
+#ifdef USE_POLL
+    modes += ", poll";
+#endif
+#ifdef USE_EPOLL
+    modes += ", epoll";
+#endif
+    return modes;
+}
+
+MessageClass GetMessageClass(const std::string& command)
+{
+    static const std::set<std::string> blockCommands{
+        NetMsgType::HEADERS, NetMsgType::CMPCTBLOCK, NetMsgType::BLOCK,
+        NetMsgType::GETBLOCKTXN, NetMsgType::BLOCKTXN,
+    };
+    static const std::set<std::string> overlayCommands{
+        NetMsgType::XBRIDGE, NetMsgType::XROUTER, NetMsgType::SNREGISTER,
+        NetMsgType::SNPING, NetMsgType::SNLIST, NetMsgType::SNLISTPING,
+    };
+    if (blockCommands.count(command))
+        return MSG_CLASS_BLOCK;
+    if (overlayCommands.count(command))
+        return MSG_CLASS_OVERLAY;
+    return MSG_CLASS_DEFAULT;
+}
+
+std::string MessageClassToString(MessageClass msgClass)
+{
+    switch (msgClass) {
+    case MSG_CLASS_BLOCK: return "block";
+    case MSG_CLASS_DEFAULT: return "default";
+    case MSG_CLASS_OVERLAY: return "overlay";
+    case MSG_CLASS_COUNT: break;
+    }
+    return "unknown";
+}
+
 void CConnman::AddOneShot(const std::string& strDest)
 {
     LOCK(cs_vOneShots);
@@ -526,6 +606,15 @@ void CNode::copyStats(CNodeStats &stats)
         X(mapRecvBytesPerMsgCmd);
         X(nRecvBytes);
     }
+    {
+        LOCK(cs_msgStats);
+        X(mapProcessStatsPerMsgCmd);
+    }
+    {
+        LOCK(cs_vProcessMsg);
+        for (int i = 0; i < MSG_CLASS_COUNT; ++i)
+            stats.vProcessQueued[i] = vProcessMsg[i].size();
+    }
     X(fWhitelisted);
     {
         LOCK(cs_feeFilter);
@@ -968,10 +1057,7 @@ void CConnman::AcceptConnection(const ListenSocket& hListenSocket) {
 
     LogPrint(BCLog::NET, "connection from %s accepted\n", addr.ToString());
 
-    {
-        LOCK(cs_vNodes);
-        vNodes.push_back(pnode);
-    }
+    AddConnectedNode(pnode);
 }
 
 void CConnman::DisconnectNodes()
@@ -1129,8 +1215,66 @@ bool CConnman::GenerateSelectSet(std::set<SOCKET> &recv_set, std::set<SOCKET> &s
     return !recv_set.empty() || !send_set.empty() || !error_set.empty();
 }
 
+#ifdef USE_EPOLL
+bool CConnman::InitEpoll()
+{
+    epollfd = epoll_create1(EPOLL_CLOEXEC);
+    if (epollfd == -1) {
+        LogPrintf("epoll_create1 failed: %s\n", NetworkErrorString(errno));
+        return false;
+    }
+    // Listen sockets are level-triggered, a pending connection that is not
+    // accepted in this loop is reported again
+    for (const ListenSocket& hListenSocket : vhListenSocket) {
+        RegisterEpoll(hListenSocket.socket, false);
+    }
+    return true;
+}
+
+void CConnman::RegisterEpoll(SOCKET hSocket, bool fEdgeTriggered)
+{
+    struct epoll_event event{};
+    event.events = EPOLLIN | EPOLLRDHUP;
+    if (fEdgeTriggered)
+        event.events |= EPOLLOUT | EPOLLET;
+    event.data.fd = hSocket;
+    if (epoll_ctl(epollfd, EPOLL_CTL_ADD, hSocket, &event) != 0)
+        LogPrintf("epoll_ctl failed for socket %d: %s\n", hSocket, NetworkErrorString(errno));
+}
+
+void CConnman::SocketEventsEpoll(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_set, std::set<SOCKET> &error_set)
+{
+    // Sockets are registered once and removed by the kernel when they are closed,
+    // so a wait only costs the number of sockets that became ready. Readiness of
+    // node sockets is edge-triggered, SocketHandler remembers it on the node
+    // until the socket would block and asks for a non-blocking wait meanwhile.
+    struct epoll_event events[EPOLL_MAX_EVENTS];
+    const int timeout = fSocketEventsPending ? 0 : SELECT_TIMEOUT_MILLISECONDS;
+    fSocketEventsPending = false;
+    int nEvents = epoll_wait(epollfd, events, EPOLL_MAX_EVENTS, timeout);
+
+    if (interruptNet) return;
+
+    if (nEvents < 0) {
+        int nErr = WSAGetLastError();
+        if (nErr != WSAEINTR)
+            LogPrintf("socket epoll_wait error %s\n", NetworkErrorString(nErr));
+        return;
+    }
+    if (nEvents == EPOLL_MAX_EVENTS)
+        fSocketEventsPending = true;
+
+    for (int i = 0; i < nEvents; ++i) {
+        const SOCKET hSocket = events[i].data.fd;
+        if (events[i].events & EPOLLIN)                          recv_set.insert(hSocket);
+        if (events[i].events & EPOLLOUT)                         send_set.insert(hSocket);
+        if (events[i].events & (EPOLLERR|EPOLLHUP|EPOLLRDHUP))   error_set.insert(hSocket);
+    }
+}
+#endif
+
 #ifdef USE_POLL
-void CConnman::SocketEvents(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_set, std::set<SOCKET> &error_set)
+void CConnman::SocketEventsPoll(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_set, std::set<SOCKET> &error_set)
 {
     std::set<SOCKET> recv_select_set, send_select_set, error_select_set;
     if (!GenerateSelectSet(recv_select_set, send_select_set, error_select_set)) {
@@ -1171,8 +1315,9 @@ void CConnman::SocketEvents(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_s
         if (pollfd_entry.revents & (POLLERR|POLLHUP)) error_set.insert(pollfd_entry.fd);
     }
 }
-#else
-void CConnman::SocketEvents(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_set, std::set<SOCKET> &error_set)
+#endif
+
+void CConnman::SocketEventsSelect(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_set, std::set<SOCKET> &error_set)
 {
     std::set<SOCKET> recv_select_set, send_select_set, error_select_set;
     if (!GenerateSelectSet(recv_select_set, send_select_set, error_select_set)) {
@@ -1245,7 +1390,38 @@ void CConnman::SocketEvents(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_s
         }
     }
 }
+
+void CConnman::SocketEvents(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_set, std::set<SOCKET> &error_set)
+{
+    switch (socketEventsMode) {
+#ifdef USE_EPOLL
+    case SOCKETEVENTS_EPOLL:
+        SocketEventsEpoll(recv_set, send_set, error_set);
+        break;
+#endif
+#ifdef USE_POLL
+    case SOCKETEVENTS_POLL:
+        SocketEventsPoll(recv_set, send_set, error_set);
+        break;
+#endif
+    default:
+        SocketEventsSelect(recv_set, send_set, error_set);
+        break;
+    }
+}
+
+void CConnman::AddConnectedNode(CNode* pnode)
+{
+#ifdef USE_EPOLL
+    if (socketEventsMode == SOCKETEVENTS_EPOLL && epollfd != -1) {
+        LOCK(pnode->cs_hSocket);
+        if (pnode->hSocket != INVALID_SOCKET)
+            RegisterEpoll(pnode->hSocket, true);
+    }
 #endif
+    LOCK(cs_vNodes);
+    vNodes.push_back(pnode);
+}
 
 void CConnman::SocketHandler()
 {
@@ -1294,6 +1470,20 @@ void CConnman::SocketHandler()
             sendSet = send_set.count(pnode->hSocket) > 0;
             errorSet = error_set.count(pnode->hSocket) > 0;
         }
+        if (socketEventsMode == SOCKETEVENTS_EPOLL)
+        {
+            // Apply the policy of GenerateSelectSet to the remembered readiness:
+            // drain the send buffer before receiving more
+            pnode->fRecvReady |= recvSet || errorSet;
+            pnode->fSendReady |= sendSet;
+            bool hasSendData;
+            {
+                LOCK(pnode->cs_vSend);
+                hasSendData = !pnode->vSendMsg.empty();
+            }
+            sendSet = hasSendData && pnode->fSendReady;
+            recvSet = !hasSendData && pnode->fRecvReady && !pnode->fPauseRecv;
+        }
         if (recvSet || errorSet)
         {
             // typical socket buffer is 8K-64K
@@ -1305,6 +1495,9 @@ void CConnman::SocketHandler()
                     continue;
                 nBytes = recv(pnode->hSocket, pchBuf, sizeof(pchBuf), MSG_DONTWAIT);
             }
+            // A short read drained the socket, more data arriving triggers a new edge
+            if (nBytes < (int)sizeof(pchBuf))
+                pnode->fRecvReady = false;
             if (nBytes > 0)
             {
                 bool notify = false;
@@ -1312,17 +1505,20 @@ void CConnman::SocketHandler()
                     pnode->CloseSocketDisconnect();
                 RecordBytesRecv(nBytes);
                 if (notify) {
-                    size_t nSizeAdded = 0;
-                    auto it(pnode->vRecvMsg.begin());
-                    for (; it != pnode->vRecvMsg.end(); ++it) {
-                        if (!it->complete())
-                            break;
-                        nSizeAdded += it->vRecv.size() + CMessageHeader::HEADER_SIZE;
-                    }
+                    // Until the handshake is done all messages stay in order in the
+                    // default queue
+                    const bool fPrioritize = pnode->fSuccessfullyConnected;
                     {
                         LOCK(pnode->cs_vProcessMsg);
-                        pnode->vProcessMsg.splice(pnode->vProcessMsg.end(), pnode->vRecvMsg, pnode->vRecvMsg.begin(), it);
-                        pnode->nProcessQueueSize += nSizeAdded;
+                        while (!pnode->vRecvMsg.empty() && pnode->vRecvMsg.front().complete()) {
+                            const CNetMessage& msg = pnode->vRecvMsg.front();
+                            const MessageClass msgClass = fPrioritize ? GetMessageClass(msg.hdr.GetCommand()) : MSG_CLASS_DEFAULT;
+                            const size_t nSize = msg.vRecv.size() + CMessageHeader::HEADER_SIZE;
+                            auto& queue = pnode->vProcessMsg[msgClass];
+                            queue.splice(queue.end(), pnode->vRecvMsg, pnode->vRecvMsg.begin());
+                            pnode->nProcessQueueSize += nSize;
+                            pnode->nProcessQueueClassSize[msgClass] += nSize;
+                        }
                         pnode->fPauseRecv = pnode->nProcessQueueSize > nReceiveFloodSize;
                     }
                     WakeMessageHandler();
@@ -1359,6 +1555,14 @@ void CConnman::SocketHandler()
             if (nBytes) {
                 RecordBytesSent(nBytes);
             }
+            // Data left behind means the socket would block
+            pnode->fSendReady = pnode->vSendMsg.empty();
+        }
+
+        if (socketEventsMode == SOCKETEVENTS_EPOLL && !fSocketEventsPending)
+        {
+            LOCK(pnode->cs_vSend);
+            fSocketEventsPending = pnode->vSendMsg.empty() ? pnode->fRecvReady && !pnode->fPauseRecv : pnode->fSendReady;
         }
 
         InactivityCheck(pnode);
@@ -1940,10 +2144,92 @@ void CConnman::OpenNetworkConnection(const CAddress& addrConnect, bool fCountFai
         pnode->m_manual_connection = true;
 
     m_msgproc->InitializeNode(pnode);
+    AddConnectedNode(pnode);
+}
+
+bool CConnman::PollMessage(CNode* pnode, std::list<CNetMessage>& msgs, bool& fMoreWork)
+{
+    LOCK(pnode->cs_vProcessMsg);
+    auto& queues = pnode->vProcessMsg;
+    MessageClass msgClass;
+    if (!queues[MSG_CLASS_BLOCK].empty()) {
+        msgClass = MSG_CLASS_BLOCK;
+    } else if (!queues[MSG_CLASS_DEFAULT].empty() &&
+               (queues[MSG_CLASS_OVERLAY].empty() || pnode->nProcessDefaultRun < MSG_CLASS_DEFAULT_WEIGHT)) {
+        msgClass = MSG_CLASS_DEFAULT;
+        ++pnode->nProcessDefaultRun;
+    } else if (!queues[MSG_CLASS_OVERLAY].empty()) {
+        msgClass = MSG_CLASS_OVERLAY;
+        pnode->nProcessDefaultRun = 0;
+    } else {
+        fMoreWork = false;
+        return false;
+    }
+
+    // Just take one message
+    auto& queue = queues[msgClass];
+    msgs.splice(msgs.begin(), queue, queue.begin());
+    const size_t nSize = msgs.front().vRecv.size() + CMessageHeader::HEADER_SIZE;
+    pnode->nProcessQueueSize -= nSize;
+    pnode->nProcessQueueClassSize[msgClass] -= nSize;
+    pnode->fPauseRecv = pnode->nProcessQueueSize > nReceiveFloodSize;
+    fMoreWork = pnode->nProcessQueueSize > 0;
+
+    MessageClassCounters& counters = msgClassCounters[msgClass];
+    const uint64_t nLatency = std::max<int64_t>(GetTimeMicros() - msgs.front().nTime, 0);
+    ++counters.nProcessed;
+    counters.nLatencyTotal += nLatency;
+    uint64_t nMax = counters.nLatencyMax;
+    while (nLatency > nMax && !counters.nLatencyMax.compare_exchange_weak(nMax, nLatency));
+    return true;
+}
+
+void CMsgCmdStats::Add(uint64_t bytes, int64_t time, bool dropped)
+{
+    const uint64_t nTime = std::max<int64_t>(time, 0);
+    ++nCount;
+    nBytes += bytes;
+    nTimeTotal += nTime;
+    nTimeMax = std::max(nTimeMax, nTime);
+    if (dropped)
+        ++nDropped;
+}
+
+void CConnman::RecordProcessedMessage(CNode* pnode, const std::string& strCommand, uint64_t nBytes, int64_t nTime, bool fDropped)
+{
+    static const std::set<std::string> knownCommands(getAllNetMessageTypes().begin(), getAllNetMessageTypes().end());
+    const std::string& key = knownCommands.count(strCommand) ? strCommand : NET_MESSAGE_COMMAND_OTHER;
     {
-        LOCK(cs_vNodes);
-        vNodes.push_back(pnode);
+        LOCK(pnode->cs_msgStats);
+        pnode->mapProcessStatsPerMsgCmd[key].Add(nBytes, nTime, fDropped);
     }
+    LOCK(cs_msgStats);
+    mapMsgStats[key].Add(nBytes, nTime, fDropped);
+}
+
+mapMsgCmdStats CConnman::GetMessageStats()
+{
+    LOCK(cs_msgStats);
+    return mapMsgStats;
+}
+
+std::vector<CConnman::MessageClassStats> CConnman::GetMessageClassStats()
+{
+    std::vector<MessageClassStats> stats(MSG_CLASS_COUNT);
+    for (int i = 0; i < MSG_CLASS_COUNT; ++i) {
+        stats[i].nProcessed = msgClassCounters[i].nProcessed;
+        stats[i].nLatencyTotal = msgClassCounters[i].nLatencyTotal;
+        stats[i].nLatencyMax = msgClassCounters[i].nLatencyMax;
+    }
+    LOCK(cs_vNodes);
+    for (CNode* pnode : vNodes) {
+        LOCK(pnode->cs_vProcessMsg);
+        for (int i = 0; i < MSG_CLASS_COUNT; ++i) {
+            stats[i].nQueued += pnode->vProcessMsg[i].size();
+            stats[i].nQueuedBytes += pnode->nProcessQueueClassSize[i];
+        }
+    }
+    return stats;
 }
 
 void CConnman::ThreadMessageHandler()
@@ -1961,6 +2247,23 @@ void CConnman::ThreadMessageHandler()
 
         bool fMoreWork = false;
 
+        // Block relay of any peer goes ahead of the other traffic of all peers,
+        // PollMessage only orders the queues of a single peer
+        for (CNode* pnode : vNodesCopy)
+        {
+            if (pnode->fDisconnect)
+                continue;
+            {
+                LOCK(pnode->cs_vProcessMsg);
+                if (pnode->vProcessMsg[MSG_CLASS_BLOCK].empty())
+                    continue;
+            }
+            bool fMoreNodeWork = m_msgproc->ProcessMessages(pnode, flagInterruptMsgProc);
+            fMoreWork |= (fMoreNodeWork && !pnode->fPauseSend);
+            if (flagInterruptMsgProc)
+                return;
+        }
+
         for (CNode* pnode : vNodesCopy)
         {
             if (pnode->fDisconnect)
@@ -2202,6 +2505,17 @@ bool CConnman::Start(CScheduler& scheduler, const Options& connOptions)
         return false;
     }
 
+#ifdef USE_EPOLL
+    if (socketEventsMode == SOCKETEVENTS_EPOLL && !InitEpoll()) {
+        if (clientInterface) {
+            clientInterface->ThreadSafeMessageBox(
+                _("Failed to initialize epoll, try -socketevents=poll."),
+                "", CClientUIInterface::MSG_ERROR);
+        }
+        return false;
+    }
+#endif
+
     for (const auto& strDest : connOptions.vSeedNodes) {
         AddOneShot(strDest);
     }
@@ -2359,6 +2673,12 @@ void CConnman::Stop()
     vNodes.clear();
     vNodesDisconnected.clear();
     vhListenSocket.clear();
+#ifdef USE_EPOLL
+    if (epollfd != -1) {
+        close(epollfd);
+        epollfd = -1;
+    }
+#endif
     semOutbound.reset();
     semAddnode.reset();
 }
@@ -2695,6 +3015,16 @@ bool CConnman::NodeFullyConnected(const CNode* pnode)
     return pnode && pnode->fSuccessfullyConnected && !pnode->fDisconnect;
 }
 
+/** Serialize the header of a message into data, data should be empty */
+static void SerializeMessageHeader(const CSerializedNetMsg& msg, std::vector<unsigned char>& data)
+{
+    uint256 hash = Hash(msg.data.data(), msg.data.data() + msg.data.size());
+    CMessageHeader hdr(Params().MessageStart(), msg.command.c_str(), msg.data.size());
+    memcpy(hdr.pchChecksum, hash.begin(), CMessageHeader::CHECKSUM_SIZE);
+
+    CVectorWriter{SER_NETWORK, INIT_PROTO_VERSION, data, 0, hdr};
+}
+
 void CConnman::PushMessage(CNode* pnode, CSerializedNetMsg&& msg)
 {
     size_t nMessageSize = msg.data.size();
@@ -2703,11 +3033,7 @@ void CConnman::PushMessage(CNode* pnode, CSerializedNetMsg&& msg)
 
     std::vector<unsigned char> serializedHeader;
     serializedHeader.reserve(CMessageHeader::HEADER_SIZE);
-    uint256 hash = Hash(msg.data.data(), msg.data.data() + nMessageSize);
-    CMessageHeader hdr(Params().MessageStart(), msg.command.c_str(), nMessageSize);
-    memcpy(hdr.pchChecksum, hash.begin(), CMessageHeader::CHECKSUM_SIZE);
-
-    CVectorWriter{SER_NETWORK, INIT_PROTO_VERSION, serializedHeader, 0, hdr};
+    SerializeMessageHeader(msg, serializedHeader);
 
     size_t nBytesSent = 0;
     {
@@ -2720,9 +3046,48 @@ void CConnman::PushMessage(CNode* pnode, CSerializedNetMsg&& msg)
 
         if (pnode->nSendSize > nSendBufferMaxSize)
             pnode->fPauseSend = true;
-        pnode->vSendMsg.push_back(std::move(serializedHeader));
+        pnode->vSendMsg.emplace_back(std::move(serializedHeader));
         if (nMessageSize)
-            pnode->vSendMsg.push_back(std::move(msg.data));
+            pnode->vSendMsg.emplace_back(std::move(msg.data));
+
+        // If write queue empty, attempt "optimistic write"
+        if (optimisticSend == true)
+            nBytesSent = SocketSendData(pnode);
+    }
+    if (nBytesSent)
+        RecordBytesSent(nBytesSent);
+}
+
+CSharedNetMsg CConnman::MakeSharedMessage(CSerializedNetMsg&& msg) const
+{
+    auto data = std::make_shared<std::vector<unsigned char>>();
+    data->reserve(CMessageHeader::HEADER_SIZE + msg.data.size());
+    SerializeMessageHeader(msg, *data);
+    data->insert(data->end(), msg.data.begin(), msg.data.end());
+
+    CSharedNetMsg shared;
+    shared.command = std::move(msg.command);
+    shared.data = std::move(data);
+    return shared;
+}
+
+void CConnman::PushMessage(CNode* pnode, const CSharedNetMsg& msg)
+{
+    size_t nTotalSize = msg.data->size();
+    LogPrint(BCLog::NET, "sending %s (%d bytes) peer=%d\n",  SanitizeString(msg.command.c_str()), nTotalSize - CMessageHeader::HEADER_SIZE, pnode->GetId());
+
+    size_t nBytesSent = 0;
+    {
+        LOCK(pnode->cs_vSend);
+        bool optimisticSend(pnode->vSendMsg.empty());
+
+        //log total amount of bytes per command
+        pnode->mapSendBytesPerMsgCmd[msg.command] += nTotalSize;
+        pnode->nSendSize += nTotalSize;
+
+        if (pnode->nSendSize > nSendBufferMaxSize)
+            pnode->fPauseSend = true;
+        pnode->vSendMsg.emplace_back(msg.data);
 
         // If write queue empty, attempt "optimistic write"
         if (optimisticSend == true)
@@ -2732,6 +3097,15 @@ void CConnman::PushMessage(CNode* pnode, CSerializedNetMsg&& msg)
         RecordBytesSent(nBytesSent);
 }
 
+void CConnman::BroadcastMessage(CSerializedNetMsg&& msg, const std::function<bool(CNode* pnode)>& filter)
+{
+    const CSharedNetMsg shared = MakeSharedMessage(std::move(msg));
+    ForEachNode([&](CNode* pnode) {
+        if (!filter || filter(pnode))
+            PushMessage(pnode, shared);
+    });
+}
+
 bool CConnman::ForNode(NodeId id, std::function<bool(CNode* pnode)> func)
 {
     CNode* found = nullptr;
@@ -2825,10 +3199,7 @@ CNode* CConnman::OpenXRouterConnection(const CAddress & addrConnect, const char
     pnode->fXRouter = true;
 
     m_msgproc->InitializeNode(pnode);
-    {
-        LOCK(cs_vNodes);
-        vNodes.push_back(pnode);
-    }
+    AddConnectedNode(pnode);
 
     return pnode;
 }
\ No newline at end of file
@@ -82,6 +82,55 @@ static const bool DEFAULT_BLOCKSONLY = false;
 /** -peertimeout default */
 static const int64_t DEFAULT_PEER_CONNECT_TIMEOUT = 60;
 
+/** Backend the socket handler uses to wait for socket readiness (-socketevents) */
+enum SocketEventsMode {
+    SOCKETEVENTS_SELECT = 0,
+    SOCKETEVENTS_POLL = 1,
+    SOCKETEVENTS_EPOLL = 2,
+};
+
+/** -socketevents default, epoll is opt-in */
+#if defined(USE_POLL)
+static const char* const DEFAULT_SOCKETEVENTS = "poll";
+#else
+static const char* const DEFAULT_SOCKETEVENTS = "select";
+#endif
+
+/** Parse a -socketevents value, returns false if the mode is not supported on this platform */
+bool ParseSocketEventsMode(const std::string& str, SocketEventsMode& mode);
+/** Name of a socket events mode */
+std::string SocketEventsModeToString(SocketEventsMode mode);
+/** Comma separated list of the socket events modes supported on this platform */
+std::string GetSupportedSocketEventsModes();
+
+/** Classes of received messages, each peer has a processing queue per class (see CConnman::PollMessage) */
+enum MessageClass {
+    MSG_CLASS_BLOCK = 0,    //!< Block relay, preempts all other traffic
+    MSG_CLASS_DEFAULT,      //!< Everything that is not block relay or overlay gossip
+    MSG_CLASS_OVERLAY,      //!< XBridge, XRouter and service node gossip
+    MSG_CLASS_COUNT
+};
+
+/** Number of default class messages processed per overlay message while both are queued */
+static const unsigned int MSG_CLASS_DEFAULT_WEIGHT = 4;
+
+/** Class of a received message by its command */
+MessageClass GetMessageClass(const std::string& command);
+/** Name of a message class */
+std::string MessageClassToString(MessageClass msgClass);
+
+/** Processing of received messages of one command */
+struct CMsgCmdStats {
+    uint64_t nCount{0};
+    uint64_t nBytes{0};
+    uint64_t nTimeTotal{0}; //!< Microseconds spent in the message handler
+    uint64_t nTimeMax{0};
+    uint64_t nDropped{0};   //!< Messages failing header or checksum checks, or rejected by the handler
+
+    void Add(uint64_t bytes, int64_t time, bool dropped);
+};
+typedef std::map<std::string, CMsgCmdStats> mapMsgCmdStats; //command, processing stats
+
 static const bool DEFAULT_FORCEDNSSEED = false;
 static const size_t DEFAULT_MAXRECEIVEBUFFER = 5 * 1000;
 static const size_t DEFAULT_MAXSENDBUFFER    = 1 * 1000;
@@ -112,12 +161,44 @@ struct CSerializedNetMsg
     std::string command;
 };
 
+/** A message with its header serialized and checksummed once, to be queued to many peers */
+struct CSharedNetMsg
+{
+    std::string command;
+    //! Header followed by the payload
+    std::shared_ptr<const std::vector<unsigned char>> data;
+};
+
+/** Data queued to be sent to a peer, owned by the peer or shared by the peers a message was broadcast to */
+class CNetSendBuffer
+{
+public:
+    explicit CNetSendBuffer(std::vector<unsigned char>&& data) : owned(std::move(data)) {}
+    explicit CNetSendBuffer(std::shared_ptr<const std::vector<unsigned char>> data) : shared(std::move(data)) {}
+
+    const unsigned char* data() const { return shared ? shared->data() : owned.data(); }
+    size_t size() const { return shared ? shared->size() : owned.size(); }
 
+private:
+    std::vector<unsigned char> owned;
+    std::shared_ptr<const std::vector<unsigned char>> shared;
+};
+
+
+class CNetMessage;
 class NetEventsInterface;
 class CConnman
 {
 public:
 
+    struct MessageClassStats {
+        size_t nQueued{0};          //!< Messages waiting in the queues of all peers
+        size_t nQueuedBytes{0};
+        uint64_t nProcessed{0};
+        uint64_t nLatencyTotal{0};  //!< Microseconds between receipt and processing, summed
+        uint64_t nLatencyMax{0};
+    };
+
     enum NumConnections {
         CONNECTIONS_NONE = 0,
         CONNECTIONS_IN = (1U << 0),
@@ -148,6 +229,7 @@ public:
         std::vector<std::string> m_specified_outgoing;
         std::vector<std::string> m_added_nodes;
         bool unit_test_mode{false};
+        SocketEventsMode socketEventsMode = SOCKETEVENTS_SELECT;
     };
 
     void Init(const Options& connOptions) {
@@ -164,6 +246,7 @@ public:
         nSendBufferMaxSize = connOptions.nSendBufferMaxSize;
         nReceiveFloodSize = connOptions.nReceiveFloodSize;
         m_peer_connect_timeout = connOptions.m_peer_connect_timeout;
+        socketEventsMode = connOptions.socketEventsMode;
         {
             LOCK(cs_totalBytesSent);
             nMaxOutboundTimeframe = connOptions.nMaxOutboundTimeframe;
@@ -202,6 +285,16 @@ public:
     bool ForNode(NodeId id, std::function<bool(CNode* pnode)> func);
 
     void PushMessage(CNode* pnode, CSerializedNetMsg&& msg);
+    void PushMessage(CNode* pnode, const CSharedNetMsg& msg);
+
+    /** Serialize the header of a message for PushMessage to many peers without copying it per peer */
+    CSharedNetMsg MakeSharedMessage(CSerializedNetMsg&& msg) const;
+
+    /**
+     * Queue a message to the fully connected peers filter returns true for, or to all
+     * of them without a filter. The message is serialized and checksummed only once.
+     */
+    void BroadcastMessage(CSerializedNetMsg&& msg, const std::function<bool(CNode* pnode)>& filter = nullptr);
 
     template<typename Callable>
     void ForEachNode(Callable&& func)
@@ -270,6 +363,27 @@ public:
     std::vector<AddedNodeInfo> GetAddedNodeInfo();
 
     size_t GetNodeCount(NumConnections num);
+    SocketEventsMode GetSocketEventsMode() const { return socketEventsMode; }
+    std::vector<MessageClassStats> GetMessageClassStats();
+
+    /**
+     * Take the next received message of a peer to process. Block relay is taken
+     * first, default and overlay messages share the rest MSG_CLASS_DEFAULT_WEIGHT:1
+     * while both are queued. Returns false if nothing is queued, fMoreWork is set if
+     * more messages are left.
+     */
+    bool PollMessage(CNode* pnode, std::list<CNetMessage>& msgs, bool& fMoreWork);
+
+    /**
+     * Account a received message after the message processor is done with it, to the
+     * peer and to the totals since startup. Unknown commands are counted as
+     * NET_MESSAGE_COMMAND_OTHER.
+     * @param nBytes Message size including the header
+     * @param nTime Microseconds spent processing the message
+     * @param fDropped The message was invalid or its handler failed
+     */
+    void RecordProcessedMessage(CNode* pnode, const std::string& strCommand, uint64_t nBytes, int64_t nTime, bool fDropped);
+    mapMsgCmdStats GetMessageStats();
     void GetNodeStats(std::vector<CNodeStats>& vstats);
     bool DisconnectNode(const std::string& node);
     bool DisconnectNode(const CSubNet& subnet);
@@ -342,7 +456,18 @@ private:
     void NotifyNumConnectionsChanged();
     void InactivityCheck(CNode *pnode);
     bool GenerateSelectSet(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_set, std::set<SOCKET> &error_set);
+#ifdef USE_EPOLL
+    bool InitEpoll();
+    void RegisterEpoll(SOCKET hSocket, bool fEdgeTriggered);
+    void SocketEventsEpoll(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_set, std::set<SOCKET> &error_set);
+#endif
+#ifdef USE_POLL
+    void SocketEventsPoll(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_set, std::set<SOCKET> &error_set);
+#endif
+    void SocketEventsSelect(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_set, std::set<SOCKET> &error_set);
     void SocketEvents(std::set<SOCKET> &recv_set, std::set<SOCKET> &send_set, std::set<SOCKET> &error_set);
+    /** Add a new node to vNodes and register its socket with the socket events backend */
+    void AddConnectedNode(CNode* pnode);
     void SocketHandler();
     void ThreadSocketHandler();
     void ThreadDNSAddressSeed();
@@ -394,6 +519,22 @@ private:
     unsigned int nSendBufferMaxSize{0};
     unsigned int nReceiveFloodSize{0};
 
+    SocketEventsMode socketEventsMode{SOCKETEVENTS_SELECT};
+
+    struct MessageClassCounters {
+        std::atomic<uint64_t> nProcessed{0};
+        std::atomic<uint64_t> nLatencyTotal{0};
+        std::atomic<uint64_t> nLatencyMax{0};
+    };
+    MessageClassCounters msgClassCounters[MSG_CLASS_COUNT];
+
+    CCriticalSection cs_msgStats;
+    mapMsgCmdStats mapMsgStats GUARDED_BY(cs_msgStats);
+    /** epoll instance node and listen sockets stay registered with for their lifetime */
+    int epollfd{-1};
+    /** Remembered readiness is left to service, don't block in the next wait. Only used by the SocketHandler thread */
+    bool fSocketEventsPending{false};
+
     std::vector<ListenSocket> vhListenSocket;
     std::atomic<bool> fNetworkActive{true};
     bool fAddressesInitialized{false};
@@ -452,6 +593,7 @@ private:
     std::atomic<int64_t> lastLookupTimeBlockHeights{0};
 
     friend struct CConnmanTest;
+    friend struct CConnmanSocketTest;
 };
 extern std::unique_ptr<CConnman> g_connman;
 extern std::unique_ptr<BanMan> g_banman;
@@ -569,6 +711,9 @@ public:
     mapMsgCmdSize mapSendBytesPerMsgCmd;
     uint64_t nRecvBytes;
     mapMsgCmdSize mapRecvBytesPerMsgCmd;
+    mapMsgCmdStats mapProcessStatsPerMsgCmd;
+    // Messages waiting to be processed, per message class
+    size_t vProcessQueued[MSG_CLASS_COUNT];
     bool fWhitelisted;
     double dPingTime;
     double dPingWait;
@@ -640,14 +785,18 @@ public:
     size_t nSendSize{0}; // total size of all vSendMsg entries
     size_t nSendOffset{0}; // offset inside the first vSendMsg already sent
     uint64_t nSendBytes GUARDED_BY(cs_vSend){0};
-    std::deque<std::vector<unsigned char>> vSendMsg GUARDED_BY(cs_vSend);
+    std::deque<CNetSendBuffer> vSendMsg GUARDED_BY(cs_vSend);
     CCriticalSection cs_vSend;
     CCriticalSection cs_hSocket;
     CCriticalSection cs_vRecv;
+    CCriticalSection cs_msgStats;
 
     CCriticalSection cs_vProcessMsg;
-    std::list<CNetMessage> vProcessMsg GUARDED_BY(cs_vProcessMsg);
+    std::list<CNetMessage> vProcessMsg[MSG_CLASS_COUNT] GUARDED_BY(cs_vProcessMsg);
     size_t nProcessQueueSize{0};
+    size_t nProcessQueueClassSize[MSG_CLASS_COUNT] GUARDED_BY(cs_vProcessMsg){};
+    // Default class messages taken since the last overlay message, see CConnman::PollMessage
+    unsigned int nProcessDefaultRun GUARDED_BY(cs_vProcessMsg){0};
 
     CCriticalSection cs_sendProcessing;
 
@@ -696,10 +845,15 @@ public:
     const uint64_t nKeyedNetGroup;
     std::atomic_bool fPauseRecv{false};
     std::atomic_bool fPauseSend{false};
+    // Edge-triggered readiness reported by epoll that was not consumed yet, it is
+    // kept until recv/send would block. Only used by the SocketHandler thread
+    bool fRecvReady{false};
+    bool fSendReady{true};
 
 protected:
     mapMsgCmdSize mapSendBytesPerMsgCmd;
     mapMsgCmdSize mapRecvBytesPerMsgCmd GUARDED_BY(cs_vRecv);
+    mapMsgCmdStats mapProcessStatsPerMsgCmd GUARDED_BY(cs_msgStats);
 
 public:
     uint256 hashContinue;
@@ -2918,74 +2918,70 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
 
         // Relay xbridge packets only if state is good
         if (dos <= 0) {
-            connman->ForEachNode([&](CNode *pnode) {
-                if (!pnode->fSuccessfullyConnected)
-                    return;
-                connman->PushMessage(pnode, msgMaker.Make(NetMsgType::XBRIDGE, rawcopy));
-            });
+            connman->BroadcastMessage(msgMaker.Make(NetMsgType::XBRIDGE, rawcopy));
         }
 
         return true;
     }
 
     if (strCommand == NetMsgType::SNREGISTER) { // handle snode registrations
-        sn::ServiceNode snode;
+        // Signature and collateral checks run on the snode validation threads, the
+        // registration is relayed once it's been validated and added.
+        const NodeId from = pfrom->GetId();
+        const int sendVersion = pfrom->GetSendVersion();
         try {
-            if (!smgr.processRegistration(vRecv, snode))
-                return true;
+            smgr.queueRegistration(vRecv, [connman,from,sendVersion](const sn::ServiceNode & snode) {
+                auto & smgr = sn::ServiceNodeMgr::instance();
+                // Send the ping out if we are a snode waiting for registration
+                if (smgr.hasActiveSn() && smgr.getActiveSn().keyId() == snode.getSnodePubKey().GetID()) {
+                    sn::ServiceNodeMgr::writeSnRegistration(snode);
+                    if (!smgr.sendPing(XROUTER_PROTOCOL_VERSION, xbridge::App::instance().myServicesJSON(), connman))
+                        LogPrintf("Service node ping failed after registration for %s\n", smgr.getActiveSn().alias);
+                }
+
+                // Relay packets
+                const CNetMsgMaker msgMaker(sendVersion);
+                connman->BroadcastMessage(msgMaker.Make(NetMsgType::SNREGISTER, snode), [from](CNode* pnode) {
+                    return pnode->GetId() != from;
+                });
+            });
         } catch (std::exception & e) {
             LOCK(cs_main);
             LogPrint(BCLog::NET, "servicenode packet from peer=%d %s processed with error: %s\n",
                      pfrom->GetId(), pfrom->cleanSubVer, std::string(e.what()));
             // bad packet, small penalty
             Misbehaving(pfrom->GetId(), 10);
-            return true;
-        }
-
-        // Send the ping out if we are a snode waiting for registration
-        if (smgr.hasActiveSn() && smgr.getActiveSn().keyId() == snode.getSnodePubKey().GetID()) {
-            sn::ServiceNodeMgr::writeSnRegistration(snode);
-            if (!smgr.sendPing(XROUTER_PROTOCOL_VERSION, xapp.myServicesJSON(), connman))
-                LogPrintf("Service node ping failed after registration for %s\n", smgr.getActiveSn().alias);
         }
 
-        // Relay packets
-        connman->ForEachNode([&](CNode* pnode) {
-            if (pfrom == pnode)
-                return;
-            connman->PushMessage(pnode, msgMaker.Make(NetMsgType::SNREGISTER, snode));
-        });
-
         return true;
     }
 
     if (strCommand == NetMsgType::SNPING || strCommand == NetMsgType::SNLISTPING) { // handle snode pings
-        sn::ServiceNodePing ping;
+        // Relay packets only on SNPING (not SNLISTPING)
+        const bool relay = strCommand == NetMsgType::SNPING;
+        const NodeId from = pfrom->GetId();
+        const int sendVersion = pfrom->GetSendVersion();
         try {
-            if (!smgr.processPing(vRecv, ping))
-                return true;
+            smgr.queuePing(vRecv, [connman,from,sendVersion,relay](const sn::ServiceNodePing & ping) {
+                if (relay) {
+                    const CNetMsgMaker msgMaker(sendVersion);
+                    connman->BroadcastMessage(msgMaker.Make(NetMsgType::SNPING, ping), [from](CNode* pnode) {
+                        return pnode->GetId() != from;
+                    });
+                }
+
+                bool isReady = xrouter::App::isEnabled() && xrouter::App::instance().isReady();
+                if (isReady)
+                    xrouter::App::instance().processConfigMessage(ping.getSnode());
+            });
         } catch (std::exception & e) {
             LOCK(cs_main);
             LogPrint(BCLog::NET, "servicenode packet from peer=%d %s processed with error: %s\n",
                      pfrom->GetId(), pfrom->cleanSubVer, std::string(e.what()));
             // bad packet, small penalty
             Misbehaving(pfrom->GetId(), 10);
-            return true;
-        }
-
-        // Relay packets only on SNPING (not SNLISTPING)
-        if (strCommand == NetMsgType::SNPING) {
-            connman->ForEachNode([&](CNode* pnode) {
-                if (pfrom == pnode)
-                    return;
-                connman->PushMessage(pnode, msgMaker.Make(NetMsgType::SNPING, ping));
-            });
         }
 
-        bool isReady = xrouter::App::isEnabled() && xrouter::App::instance().isReady();
-        if (isReady)
-            xrouter::App::instance().processConfigMessage(ping.getSnode());
-
         return true;
     }
 
@@ -3101,14 +3097,9 @@ bool PeerLogicValidation::ProcessMessages(CNode* pfrom, std::atomic<bool>& inter
 
     std::list<CNetMessage> msgs;
     {
-        LOCK(pfrom->cs_vProcessMsg);
-        if (pfrom->vProcessMsg.empty())
+        // Just take one message, block relay first
+        if (!connman->PollMessage(pfrom, msgs, fMoreWork))
             return false;
-        // Just take one message
-        msgs.splice(msgs.begin(), pfrom->vProcessMsg, pfrom->vProcessMsg.begin());
-        pfrom->nProcessQueueSize -= msgs.front().vRecv.size() + CMessageHeader::HEADER_SIZE;
-        pfrom->fPauseRecv = pfrom->nProcessQueueSize > connman->GetReceiveFloodSize();
-        fMoreWork = !pfrom->vProcessMsg.empty();
     }
     CNetMessage& msg(msgs.front());
 
@@ -3125,6 +3116,7 @@ bool PeerLogicValidation::ProcessMessages(CNode* pfrom, std::atomic<bool>& inter
     if (!hdr.IsValid(chainparams.MessageStart()))
     {
         LogPrint(BCLog::NET, "PROCESSMESSAGE: ERRORS IN HEADER %s peer=%d\n", SanitizeString(hdr.GetCommand()), pfrom->GetId());
+        connman->RecordProcessedMessage(pfrom, hdr.GetCommand(), msg.vRecv.size() + CMessageHeader::HEADER_SIZE, 0, true);
         return fMoreWork;
     }
     std::string strCommand = hdr.GetCommand();
@@ -3141,11 +3133,13 @@ bool PeerLogicValidation::ProcessMessages(CNode* pfrom, std::atomic<bool>& inter
            SanitizeString(strCommand), nMessageSize,
            HexStr(hash.begin(), hash.begin()+CMessageHeader::CHECKSUM_SIZE),
            HexStr(hdr.pchChecksum, hdr.pchChecksum+CMessageHeader::CHECKSUM_SIZE));
+        connman->RecordProcessedMessage(pfrom, strCommand, nMessageSize + CMessageHeader::HEADER_SIZE, 0, true);
         return fMoreWork;
     }
 
     // Process message
     bool fRet = false;
+    const int64_t nTimeStart = GetTimeMicros();
     try
     {
         fRet = ProcessMessage(pfrom, strCommand, vRecv, msg.nTime, chainparams, connman, interruptMsgProc, m_enable_bip61);
@@ -3159,6 +3153,8 @@ bool PeerLogicValidation::ProcessMessages(CNode* pfrom, std::atomic<bool>& inter
         LogPrint(BCLog::NET, "%s(%s, %u bytes): Unknown exception caught\n", __func__, SanitizeString(strCommand), nMessageSize);
     }
 
+    connman->RecordProcessedMessage(pfrom, strCommand, nMessageSize + CMessageHeader::HEADER_SIZE, GetTimeMicros() - nTimeStart, !fRet);
+
     if (!fRet) {
         LogPrint(BCLog::NET, "%s(%s, %u bytes) FAILED peer=%d\n", __func__, SanitizeString(strCommand), nMessageSize, pfrom->GetId());
     }
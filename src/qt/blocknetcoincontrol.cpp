@@ -21,6 +21,10 @@
 #include <QSettings>
 #include <QSizePolicy>
 
+#include <algorithm>
+#include <map>
+#include <set>
+
 /**
  * @brief Dialog encapsulates the coin control table. The default size is 960x580
  * @param parent
@@ -125,6 +129,9 @@ BlocknetCoinControlDialog::BlocknetCoinControlDialog(WalletModel *w, QWidget *pa
         Q_EMIT reject();
     });
     connect(cc, &BlocknetCoinControl::tableUpdated, this, &BlocknetCoinControlDialog::updateLabels);
+    connect(walletModel, &WalletModel::balanceChanged, this, [this](const interfaces::WalletBalances &) {
+        refreshUnspentTransactions();
+    });
 
     updateLabels();
 }
@@ -171,23 +178,54 @@ void BlocknetCoinControlDialog::updateLabels() {
 }
 
 void BlocknetCoinControlDialog::populateUnspentTransactions(const QVector<BlocknetSimpleUTXO> & txSelectedUtxos) {
+    std::set<COutPoint> selected;
+    for (auto & outpt : txSelectedUtxos)
+        selected.insert(COutPoint(outpt.hash, outpt.vout));
+
+    // Selected coins and coins that were already loaded are loaded up front so that
+    // selections carry over and the list can merge its rows, the rest as it scrolls
+    std::set<COutPoint> loadFirst(selected);
+    if (getCC()->getData()) {
+        for (auto *utxo : getCC()->getData()->data)
+            loadFirst.insert(COutPoint(uint256S(utxo->transaction.toStdString()), utxo->vout));
+    }
+    auto coins = walletModel->wallet().listCoinOutPoints();
+    auto preload = std::stable_partition(coins.begin(), coins.end(), [&loadFirst](const COutPoint & out) {
+        return loadFirst.count(out) > 0;
+    });
+
+    auto ccData = std::make_shared<BlocknetCoinControl::Model>();
+    ccData->freeThreshold = COIN * 576 / 250; // TODO Blocknet Qt handle free threshold
+    ccData->pending.assign(coins.begin(), coins.end());
+    // address table lookups are linear, only look up each address once
+    auto labels = std::make_shared<std::map<QString, QString>>();
+    auto *w = walletModel;
+    ccData->loader = [w, selected, labels](const std::vector<COutPoint> & batch) {
+        return loadUtxos(w, batch, selected, *labels);
+    };
+    ccData->load(static_cast<int>(std::distance(coins.begin(), preload)));
+    getCC()->setData(ccData);
+    
+    if (standaloneMode) // only process utxo state changes in standalone mode
+        connect(getCC(), &BlocknetCoinControl::tableUpdated, this, &BlocknetCoinControlDialog::updateUTXOState, Qt::UniqueConnection);
+}
+
+QVector<BlocknetCoinControl::UTXO*> BlocknetCoinControlDialog::loadUtxos(WalletModel *walletModel,
+                                                                         const std::vector<COutPoint> & coins,
+                                                                         const std::set<COutPoint> & selected,
+                                                                         std::map<QString, QString> & labels)
+{
     int displayUnit = walletModel->getOptionsModel()->getDisplayUnit();
     QVector<BlocknetCoinControl::UTXO*> utxos;
 
-    auto mapCoins = walletModel->wallet().listCoins();
+    auto mapCoins = walletModel->wallet().listCoins(coins);
     for (auto & item : mapCoins) {
-        CAmount nSum = 0;
-        double dPrioritySum = 0;
-        int nChildren = 0;
-        int nInputSum = 0;
         const auto sWalletAddress = EncodeDestination(item.first);
 
         for (auto & tup : item.second) {
             const auto & out = std::get<0>(tup);
             const auto & walletTx = std::get<1>(tup);
             int nInputSize = 0;
-            nSum += walletTx.txout.nValue;
-            nChildren++;
 
             auto *utxo = new BlocknetCoinControl::UTXO;
             utxo->checked = false;
@@ -208,10 +246,14 @@ void BlocknetCoinControlDialog::populateUnspentTransactions(const QVector<Blockn
             if (!(sAddress.toStdString() == sWalletAddress)) { // if change
                 utxo->label = tr("(change)");
             } else {
-                QString sLabel = walletModel->getAddressTableModel()->labelForAddress(sAddress);
-                if (sLabel.isEmpty())
-                    sLabel = tr("(no label)");
-                utxo->label = sLabel;
+                auto it = labels.find(sAddress);
+                if (it == labels.end()) {
+                    QString sLabel = walletModel->getAddressTableModel()->labelForAddress(sAddress);
+                    if (sLabel.isEmpty())
+                        sLabel = tr("(no label)");
+                    it = labels.emplace(sAddress, sLabel).first;
+                }
+                utxo->label = it->second;
             }
 
             // amount
@@ -227,8 +269,6 @@ void BlocknetCoinControlDialog::populateUnspentTransactions(const QVector<Blockn
             // priority
             double dPriority = ((double)walletTx.txout.nValue / (nInputSize + 78)) * (walletTx.depth_in_main_chain + 1); // 78 = 2 * 34 + 10
             utxo->priority = dPriority;
-            dPrioritySum += (double)walletTx.txout.nValue * (walletTx.depth_in_main_chain + 1);
-            nInputSum += nInputSize;
 
             // transaction hash & vout
             uint256 txhash = out.hash;
@@ -240,24 +280,29 @@ void BlocknetCoinControlDialog::populateUnspentTransactions(const QVector<Blockn
             utxo->unlocked = !utxo->locked;
 
             // selected coins
-            for (auto &outpt : txSelectedUtxos) {
-                if (outpt.hash == txhash && outpt.vout == static_cast<uint>(out.n) && !utxo->locked) {
-                    utxo->checked = true;
-                    break;
-                }
-            }
+            if (!utxo->locked && selected.count(out))
+                utxo->checked = true;
 
             utxos.push_back(utxo);
         }
     }
 
-    auto ccData = std::make_shared<BlocknetCoinControl::Model>();
-    ccData->freeThreshold = COIN * 576 / 250; // TODO Blocknet Qt handle free threshold
-    ccData->data = utxos;
-    getCC()->setData(ccData);
-    
-    if (standaloneMode) // only process utxo state changes in standalone mode
-        connect(getCC(), &BlocknetCoinControl::tableUpdated, this, &BlocknetCoinControlDialog::updateUTXOState);
+    return utxos;
+}
+
+/**
+ * @brief Reloads the wallet utxos while the dialog is open. The coin control model merges
+ *        the new list into the existing rows so that selection and scroll position are kept.
+ */
+void BlocknetCoinControlDialog::refreshUnspentTransactions() {
+    if (!isVisible() || !getCC()->getData())
+        return;
+    QVector<BlocknetSimpleUTXO> selected;
+    for (auto *utxo : getCC()->getData()->data) {
+        if (utxo->checked)
+            selected.push_back(BlocknetSimpleUTXO(uint256S(utxo->transaction.toStdString()), utxo->vout));
+    }
+    populateUnspentTransactions(selected);
 }
 
 void BlocknetCoinControlDialog::updateUTXOState() {
@@ -279,7 +324,7 @@ void BlocknetCoinControlDialog::updateUTXOState() {
  * @param w Wallet model
  */
 BlocknetCoinControl::BlocknetCoinControl(QWidget *parent, WalletModel *w) : QFrame(parent), walletModel(w), layout(new QVBoxLayout),
-    table(new BlocknetTableWidget), tree(new QTreeWidget), contextMenu(new QMenu)
+    table(new QTableView), tableModel(new BlocknetCoinControlModel(w, this)), tree(new QTreeWidget), contextMenu(new QMenu)
 {
     // this->setStyleSheet("border: 1px solid red");
     this->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
@@ -287,12 +332,13 @@ BlocknetCoinControl::BlocknetCoinControl(QWidget *parent, WalletModel *w) : QFra
     this->setLayout(layout);
 
     // table
+    table->setModel(tableModel);
     table->setContentsMargins(QMargins());
-    table->setColumnCount(COLUMN_TXVOUT + 1);
     table->setEditTriggers(QAbstractItemView::NoEditTriggers);
     table->setSelectionBehavior(QAbstractItemView::SelectRows);
     table->setSelectionMode(QAbstractItemView::ExtendedSelection);
     table->setAlternatingRowColors(true);
+    table->setWordWrap(false);
     table->setColumnWidth(COLUMN_PADDING1, BGU::spi(1));
     table->setColumnWidth(COLUMN_PADDING2, BGU::spi(1));
     table->setColumnWidth(COLUMN_PADDING3, BGU::spi(1));
@@ -317,10 +363,13 @@ BlocknetCoinControl::BlocknetCoinControl(QWidget *parent, WalletModel *w) : QFra
     table->horizontalHeader()->setSectionResizeMode(COLUMN_PADDING4, QHeaderView::Fixed);
     table->horizontalHeader()->setSectionResizeMode(COLUMN_PADDING5, QHeaderView::Fixed);
     table->horizontalHeader()->setSectionResizeMode(COLUMN_PADDING6, QHeaderView::Fixed);
-    table->horizontalHeader()->setSectionResizeMode(COLUMN_CHECKBOX, QHeaderView::ResizeToContents);
-    table->horizontalHeader()->setSectionResizeMode(COLUMN_AMOUNT, QHeaderView::ResizeToContents);
-    table->horizontalHeader()->setSectionResizeMode(COLUMN_ADDRESS, QHeaderView::ResizeToContents);
-    table->setHorizontalHeaderLabels({ "", "", "", tr("Amount"), "", tr("Label"), "", tr("Address"), "", tr("Date"), "", tr("Confirmations"), "" });
+    // ResizeToContents would measure every row, size these columns to their header instead
+    table->horizontalHeader()->setSectionResizeMode(COLUMN_CHECKBOX, QHeaderView::Fixed);
+    table->horizontalHeader()->setSectionResizeMode(COLUMN_AMOUNT, QHeaderView::Interactive);
+    table->horizontalHeader()->setSectionResizeMode(COLUMN_ADDRESS, QHeaderView::Interactive);
+    table->setColumnWidth(COLUMN_CHECKBOX, BGU::spi(30));
+    table->setColumnWidth(COLUMN_AMOUNT, BGU::spi(150));
+    table->setColumnWidth(COLUMN_ADDRESS, BGU::spi(300));
 
     // tree
     tree->setContentsMargins(QMargins());
@@ -363,8 +412,13 @@ BlocknetCoinControl::BlocknetCoinControl(QWidget *parent, WalletModel *w) : QFra
     treeBox->setContentsMargins(QMargins());
     treeBox->setLayout(treeBoxLayout);
     treeBoxLayout->setSpacing(BGU::spi(20));
+    filterLe = new QLineEdit;
+    filterLe->setPlaceholderText(tr("Filter by label, address or transaction ID"));
+    filterLe->setClearButtonEnabled(true);
+    filterLe->setMinimumWidth(BGU::spi(250));
     listRb = new QRadioButton(tr("List mode"));
     treeRb = new QRadioButton(tr("Tree mode"));
+    treeBoxLayout->addWidget(filterLe);
     treeBoxLayout->addStretch(1);
     treeBoxLayout->addWidget(listRb);
     treeBoxLayout->addWidget(treeRb);
@@ -414,6 +468,19 @@ BlocknetCoinControl::BlocknetCoinControl(QWidget *parent, WalletModel *w) : QFra
     layout->addWidget(table);
     layout->addWidget(treeBox);
 
+    // Restore sorting preferences, the model keeps the sort order across updates. Coins
+    // are listed in wallet order until a column is sorted because sorting loads every coin.
+    {
+        QSettings s;
+        table->setSortingEnabled(true);
+        if (s.contains("nCoinControlSortColumn") && s.contains("nCoinControlSortOrder")) {
+            table->horizontalHeader()->setSortIndicator(s.value("nCoinControlSortColumn").toInt(),
+                                                        static_cast<Qt::SortOrder>(s.value("nCoinControlSortOrder").toInt()));
+        } else {
+            table->horizontalHeader()->setSortIndicator(-1, Qt::SortOrder::AscendingOrder);
+        }
+    }
+
     // By default hide the tree view
     {
         QSettings settings;
@@ -430,14 +497,14 @@ BlocknetCoinControl::BlocknetCoinControl(QWidget *parent, WalletModel *w) : QFra
         }
     }
 
-    connect(table, &QTableWidget::customContextMenuRequested, this, &BlocknetCoinControl::showContextMenu);
-    connect(tree, &QTableWidget::customContextMenuRequested, this, &BlocknetCoinControl::showContextMenu);
+    connect(table, &QTableView::customContextMenuRequested, this, &BlocknetCoinControl::showContextMenu);
+    connect(tree, &QTreeWidget::customContextMenuRequested, this, &BlocknetCoinControl::showContextMenu);
     connect(table->horizontalHeader(), &QHeaderView::sortIndicatorChanged, this, [this](int column, Qt::SortOrder order) {
         QSettings settings;
         // ignore sorting on columns less than or equal to pad2
         if (column <= COLUMN_PADDING2 || column == COLUMN_PADDING3 || column == COLUMN_PADDING4
             || column == COLUMN_PADDING5 || column == COLUMN_PADDING6) {
-            table->horizontalHeader()->setSortIndicator(settings.value("nCoinControlSortColumn").toInt(),
+            table->horizontalHeader()->setSortIndicator(settings.value("nCoinControlSortColumn", -1).toInt(),
                     static_cast<Qt::SortOrder>(settings.value("nCoinControlSortOrder").toInt()));
             return;
         }
@@ -449,13 +516,20 @@ BlocknetCoinControl::BlocknetCoinControl(QWidget *parent, WalletModel *w) : QFra
         // ignore sorting on columns less than or equal to pad2
         if (column <= COLUMN_PADDING2 || column == COLUMN_PADDING3 || column == COLUMN_PADDING4
             || column == COLUMN_PADDING5 || column == COLUMN_PADDING6) {
-            tree->header()->setSortIndicator(settings.value("nCoinControlTreeSortColumn").toInt(),
+            tree->header()->setSortIndicator(settings.value("nCoinControlTreeSortColumn", COLUMN_LABEL).toInt(),
                     static_cast<Qt::SortOrder>(settings.value("nCoinControlTreeSortOrder").toInt()));
             return;
         }
         settings.setValue("nCoinControlTreeSortOrder", static_cast<int>(order));
         settings.setValue("nCoinControlTreeSortColumn", column);
     });
+    connect(filterLe, &QLineEdit::textChanged, this, [this](const QString & text) {
+        tableModel->setFilter(text.trimmed());
+    });
+    connect(tableModel, &BlocknetCoinControlModel::checkStateToggled, this, [this](UTXO*) {
+        treeDirty = true;
+        Q_EMIT tableUpdated();
+    });
 
     // Tree mode
     connect(group, static_cast<void(QButtonGroup::*)(int)>(&QButtonGroup::buttonClicked), this, [this](int button) {
@@ -470,19 +544,16 @@ BlocknetCoinControl::BlocknetCoinControl(QWidget *parent, WalletModel *w) : QFra
             auto items = tree->selectedItems();
             if (!items.empty()) {
                 unwatch();
-                updateTableUtxos(updateTreeCheckStates(items, Qt::Checked));
+                tableModel->utxosChanged(updateTreeCheckStates(items, Qt::Checked));
                 watch();
                 Q_EMIT tableUpdated();
             }
             return;
         }
         // Update the list
-        auto *select = table->selectionModel();
-        if (select->hasSelection()) {
-            unwatch();
-            auto idxs = select->selectedRows(COLUMN_CHECKBOX);
-            updateTreeUtxos(updateTableCheckStates(idxs, Qt::Checked));
-            watch();
+        auto utxos = selectedTableUtxos();
+        if (!utxos.empty()) {
+            updateTableCheckStates(utxos, Qt::Checked);
             Q_EMIT tableUpdated();
         }
     });
@@ -491,66 +562,61 @@ BlocknetCoinControl::BlocknetCoinControl(QWidget *parent, WalletModel *w) : QFra
             auto items = tree->selectedItems();
             if (!items.empty()) {
                 unwatch();
-                updateTableUtxos(updateTreeCheckStates(items, Qt::Unchecked));
+                tableModel->utxosChanged(updateTreeCheckStates(items, Qt::Unchecked));
                 watch();
                 Q_EMIT tableUpdated();
             }
             return;
         }
         // Update the list
-        auto *select = table->selectionModel();
-        if (select->hasSelection()) {
-            unwatch();
-            auto idxs = select->selectedRows(COLUMN_CHECKBOX);
-            updateTreeUtxos(updateTableCheckStates(idxs, Qt::Unchecked));
-            watch();
+        auto utxos = selectedTableUtxos();
+        if (!utxos.empty()) {
+            updateTableCheckStates(utxos, Qt::Unchecked);
             Q_EMIT tableUpdated();
         }
     });
 
     connect(selectAllCoins, &QAction::triggered, this, [this]() {
-        unwatch();
-        updateTableUtxos(updateTreeCheckStates(allTreeItems(), Qt::Checked));
-        watch();
+        if (treeMode()) {
+            unwatch();
+            tableModel->utxosChanged(updateTreeCheckStates(allTreeItems(), Qt::Checked));
+            watch();
+        } else if (dataModel) {
+            tableModel->loadAll();
+            updateTableCheckStates(dataModel->data.toList(), Qt::Checked);
+        }
         Q_EMIT tableUpdated();
     });
     connect(deselectAllCoins, &QAction::triggered, this, [this]() {
-        unwatch();
-        updateTableUtxos(updateTreeCheckStates(allTreeItems(), Qt::Unchecked));
-        watch();
+        if (treeMode()) {
+            unwatch();
+            tableModel->utxosChanged(updateTreeCheckStates(allTreeItems(), Qt::Unchecked));
+            watch();
+        } else if (dataModel) {
+            tableModel->loadAll();
+            updateTableCheckStates(dataModel->data.toList(), Qt::Unchecked);
+        }
         Q_EMIT tableUpdated();
     });
 
     connect(copyAmountAction, &QAction::triggered, this, [this]() {
-        UTXO *utxo = nullptr;
-        if (treeMode()) {
-            if (contextItemTr && utxoForHash(getTransactionHash(contextItemTr), getVOut(contextItemTr), utxo) && utxo != nullptr && utxo->isValid())
-                setClipboard(utxo->amount);
-        } else if (contextItem && utxoForHash(getTransactionHash(contextItem), getVOut(contextItem), utxo) && utxo != nullptr && utxo->isValid())
+        UTXO *utxo = getContextUtxo();
+        if (utxo)
             setClipboard(utxo->amount);
     });
     connect(copyLabelAction, &QAction::triggered, this, [this]() {
-        UTXO *utxo = nullptr;
-        if (treeMode()) {
-            if (contextItemTr && utxoForHash(getTransactionHash(contextItemTr), getVOut(contextItemTr), utxo) && utxo != nullptr && utxo->isValid())
-                setClipboard(utxo->label);
-        } else if (contextItem && utxoForHash(getTransactionHash(contextItem), getVOut(contextItem), utxo) && utxo != nullptr && utxo->isValid())
+        UTXO *utxo = getContextUtxo();
+        if (utxo)
             setClipboard(utxo->label);
     });
     connect(copyAddressAction, &QAction::triggered, this, [this]() {
-        UTXO *utxo = nullptr;
-        if (treeMode()) {
-            if (contextItemTr && utxoForHash(getTransactionHash(contextItemTr), getVOut(contextItemTr), utxo) && utxo != nullptr && utxo->isValid())
-                setClipboard(utxo->address);
-        } else if (contextItem && utxoForHash(getTransactionHash(contextItem), getVOut(contextItem), utxo) && utxo != nullptr && utxo->isValid())
+        UTXO *utxo = getContextUtxo();
+        if (utxo)
             setClipboard(utxo->address);
     });
     connect(copyTransactionAction, &QAction::triggered, this, [this]() {
-        UTXO *utxo = nullptr;
-        if (treeMode()) {
-            if (contextItemTr && utxoForHash(getTransactionHash(contextItemTr), getVOut(contextItemTr), utxo) && utxo != nullptr && utxo->isValid())
-                setClipboard(utxo->transaction);
-        } else if (contextItem && utxoForHash(getTransactionHash(contextItem), getVOut(contextItem), utxo) && utxo != nullptr && utxo->isValid())
+        UTXO *utxo = getContextUtxo();
+        if (utxo)
             setClipboard(utxo->transaction);
     });
 
@@ -560,19 +626,16 @@ BlocknetCoinControl::BlocknetCoinControl(QWidget *parent, WalletModel *w) : QFra
             auto items = tree->selectedItems();
             if (!items.empty()) {
                 unwatch();
-                updateTableUtxos(updateTreeCheckStates(items, Qt::Unchecked, &locked));
+                tableModel->utxosChanged(updateTreeCheckStates(items, Qt::Unchecked, &locked));
                 watch();
                 Q_EMIT tableUpdated();
             }
             return;
         }
         // Update the list
-        auto *select = table->selectionModel();
-        if (select->hasSelection()) {
-            unwatch();
-            auto idxs = select->selectedRows(COLUMN_CHECKBOX);
-            updateTreeUtxos(updateTableCheckStates(idxs, Qt::Unchecked, &locked));
-            watch();
+        auto utxos = selectedTableUtxos();
+        if (!utxos.empty()) {
+            updateTableCheckStates(utxos, Qt::Unchecked, &locked);
             Q_EMIT tableUpdated();
         }
     });
@@ -582,19 +645,16 @@ BlocknetCoinControl::BlocknetCoinControl(QWidget *parent, WalletModel *w) : QFra
             auto items = tree->selectedItems();
             if (!items.empty()) {
                 unwatch();
-                updateTableUtxos(updateTreeCheckStates(items, Qt::Unchecked, &locked));
+                tableModel->utxosChanged(updateTreeCheckStates(items, Qt::Unchecked, &locked));
                 watch();
                 Q_EMIT tableUpdated();
             }
             return;
         }
         // Update the list
-        auto *select = table->selectionModel();
-        if (select->hasSelection()) {
-            unwatch();
-            auto idxs = select->selectedRows(COLUMN_CHECKBOX);
-            updateTreeUtxos(updateTableCheckStates(idxs, Qt::Unchecked, &locked));
-            watch();
+        auto utxos = selectedTableUtxos();
+        if (!utxos.empty()) {
+            updateTableCheckStates(utxos, Qt::Unchecked, &locked);
             Q_EMIT tableUpdated();
         }
     });
@@ -612,19 +672,39 @@ BlocknetCoinControl::BlocknetCoinControl(QWidget *parent, WalletModel *w) : QFra
 
 void BlocknetCoinControl::setData(ModelPtr dataModel) {
     this->dataModel = dataModel;
+    tableModel->setUtxos(dataModel);
+
+    treeDirty = true;
+    if (treeMode())
+        buildTree();
+}
+
+BlocknetCoinControl::ModelPtr BlocknetCoinControl::getData() {
+    return dataModel;
+}
+
+void BlocknetCoinControl::clear() {
+    if (dataModel == nullptr)
+        return;
+    tableModel->clear();
+    unwatch();
+    tree->clear();
+    treeDirty = true;
+    watch();
+}
+
+void BlocknetCoinControl::buildTree() {
+    // The tree groups every coin by address
+    tableModel->loadAll();
 
     unwatch();
-    table->clearContents();
-    table->setRowCount(dataModel->data.count());
-    table->setSortingEnabled(false);
     tree->clear();
     tree->setSortingEnabled(false);
 
     std::map<QString, BlocknetCoinControl::TreeWidgetItem*> topLevelItems;
+    const auto displayUnit = walletModel->getOptionsModel()->getDisplayUnit();
 
-    for (int i = 0; i < dataModel->data.count(); ++i) {
-        auto *d = dataModel->data[i];
-
+    for (auto *d : dataModel ? dataModel->data : QVector<UTXO*>{}) {
         // Tree top level item
         BlocknetCoinControl::TreeWidgetItem *topLevelItemTr = nullptr;
         if (topLevelItems.count(d->address))
@@ -643,94 +723,50 @@ void BlocknetCoinControl::setData(ModelPtr dataModel) {
         auto *treeItem = new BlocknetCoinControl::TreeWidgetItem(topLevelItemTr);
 
         // checkbox
-        auto *cbItem = new QTableWidgetItem;
-        if (d->locked) {
-            cbItem->setIcon(QIcon(":/redesign/lock_closed_white"));
+        if (d->locked)
             treeItem->setIcon(COLUMN_CHECKBOX, QIcon(":/redesign/lock_closed_white"));
-        } else {
-            cbItem->setCheckState(d->checked ? Qt::Checked : Qt::Unchecked);
+        else
             treeItem->setCheckState(COLUMN_CHECKBOX, d->checked ? Qt::Checked : Qt::Unchecked);
-        }
-        table->setItem(i, COLUMN_CHECKBOX, cbItem);
 
         // amount
-        auto *amountItem = new BlocknetCoinControl::NumberItem;
-        amountItem->setData(Qt::DisplayRole, d->amount);
         treeItem->setData(COLUMN_AMOUNT, Qt::DisplayRole, d->amount);
         treeItem->setData(COLUMN_AMOUNT, Qt::UserRole, static_cast<long long>(d->camount));
-        table->setItem(i, COLUMN_AMOUNT, amountItem);
         // Add the amount to the associated top level item's total
         topLevelItemTr->camount += d->camount;
-        topLevelItemTr->setData(COLUMN_AMOUNT, Qt::DisplayRole, BitcoinUnits::format(walletModel->getOptionsModel()->getDisplayUnit(), topLevelItemTr->camount));
-        topLevelItemTr->setData(COLUMN_AMOUNT, Qt::UserRole, static_cast<long long>(topLevelItemTr->camount));
 
-        // label
-        auto *labelItem = new LabelItem;
-        labelItem->setText(d->label);
-        table->setItem(i, COLUMN_LABEL, labelItem);
         treeItem->setText(COLUMN_LABEL, d->label);
-
-        // address
-        auto *addressItem = new QTableWidgetItem;
-        addressItem->setText(d->address);
-        table->setItem(i, COLUMN_ADDRESS, addressItem);
         treeItem->setText(COLUMN_ADDRESS, d->address);
-
-        // date
-        auto *dateItem = new QTableWidgetItem;
-        auto localDate = d->date.toLocalTime();
-        dateItem->setData(Qt::DisplayRole, d->date);
         treeItem->setData(COLUMN_DATE, Qt::DisplayRole, d->date);
         treeItem->setData(COLUMN_DATE, Qt::UserRole, d->date);
-        table->setItem(i, COLUMN_DATE, dateItem);
-
-        // confirmations
-        auto *confItem = new BlocknetCoinControl::NumberItem;
-        confItem->setData(Qt::DisplayRole, QString::number(d->confirmations));
         treeItem->setData(COLUMN_CONFIRMATIONS, Qt::DisplayRole, static_cast<int>(d->confirmations));
         treeItem->setData(COLUMN_CONFIRMATIONS, Qt::UserRole, static_cast<int>(d->confirmations));
-        table->setItem(i, COLUMN_CONFIRMATIONS, confItem);
-
-        // txhash
-        auto *txhashItem = new QTableWidgetItem;
-        txhashItem->setData(Qt::DisplayRole, d->transaction);
         treeItem->setData(COLUMN_TXHASH, Qt::DisplayRole, d->transaction);
-        table->setItem(i, COLUMN_TXHASH, txhashItem);
-
-        // tx vout
-        auto *txvoutItem = new QTableWidgetItem;
-        txvoutItem->setData(Qt::DisplayRole, d->vout);
         treeItem->setData(COLUMN_TXVOUT, Qt::DisplayRole, d->vout);
-        table->setItem(i, COLUMN_TXVOUT, txvoutItem);
     }
 
-    table->setSortingEnabled(true);
+    // Format the totals once per address
+    for (auto & item : topLevelItems) {
+        item.second->setData(COLUMN_AMOUNT, Qt::DisplayRole, BitcoinUnits::format(displayUnit, item.second->camount));
+        item.second->setData(COLUMN_AMOUNT, Qt::UserRole, static_cast<long long>(item.second->camount));
+    }
+
     tree->setSortingEnabled(true);
 
     // Restore sorting preferences
     QSettings s;
-    if (s.contains("nCoinControlSortColumn") && s.contains("nCoinControlSortOrder")) {
-        table->horizontalHeader()->setSortIndicator(s.value("nCoinControlSortColumn").toInt(),
-                                                    static_cast<Qt::SortOrder>(s.value("nCoinControlSortOrder").toInt()));
-    } else {
-        table->horizontalHeader()->setSortIndicator(COLUMN_LABEL, Qt::SortOrder::AscendingOrder);
-    }
-    if (s.contains("nCoinControlTreeSortOrder") && s.contains("nCoinControlTreeSortOrder")) {
-        tree->header()->setSortIndicator(s.value("nCoinControlTreeSortOrder").toInt(),
+    if (s.contains("nCoinControlTreeSortColumn") && s.contains("nCoinControlTreeSortOrder")) {
+        tree->header()->setSortIndicator(s.value("nCoinControlTreeSortColumn").toInt(),
                                          static_cast<Qt::SortOrder>(s.value("nCoinControlTreeSortOrder").toInt()));
     } else {
         tree->header()->setSortIndicator(COLUMN_LABEL, Qt::SortOrder::AscendingOrder);
     }
 
+    treeDirty = false;
     watch();
 }
 
-BlocknetCoinControl::ModelPtr BlocknetCoinControl::getData() {
-    return dataModel;
-}
-
 void BlocknetCoinControl::sizeTo(const int minimumHeight, const int maximumHeight) {
-    int h = dataModel ? dataModel->data.count() * 25 : minimumHeight;
+    int h = dataModel ? (dataModel->data.count() + static_cast<int>(dataModel->pending.size())) * 25 : minimumHeight;
     if (h > maximumHeight)
         h = maximumHeight;
     table->setFixedHeight(h);
@@ -757,7 +793,7 @@ void BlocknetCoinControl::showContextMenu(QPoint pt) {
         copyAddressAction->setEnabled(item->childCount() <= 0);
         copyTransactionAction->setEnabled(item->childCount() <= 0);
         contextItemTr = item;
-        contextItem = nullptr;
+        contextIndex = QPersistentModelIndex();
     } else {
         auto *select = table->selectionModel();
         selectCoins->setEnabled(select->hasSelection());
@@ -768,16 +804,16 @@ void BlocknetCoinControl::showContextMenu(QPoint pt) {
         unlockAction->setEnabled(select->hasSelection());
         expandAll->setEnabled(false);
         collapseAll->setEnabled(false);
-        auto *item = table->itemAt(pt);
-        if (!item) {
-            contextItem = nullptr;
+        const auto idx = table->indexAt(pt);
+        if (!idx.isValid()) {
+            contextIndex = QPersistentModelIndex();
             return;
         }
         copyAmountAction->setEnabled(true);
         copyLabelAction->setEnabled(true);
         copyAddressAction->setEnabled(true);
         copyTransactionAction->setEnabled(true);
-        contextItem = item;
+        contextIndex = idx;
         contextItemTr = nullptr;
     }
     contextMenu->exec(QCursor::pos());
@@ -819,39 +855,25 @@ QString BlocknetCoinControl::getPriorityLabel(double dPriority) {
 }
 
 void BlocknetCoinControl::unwatch() {
-    table->blockSignals(true);
     tree->blockSignals(true);
-    table->setEnabled(false);
     tree->setEnabled(false);
-    disconnect(table, &QTableWidget::itemChanged, this, &BlocknetCoinControl::onItemChanged);
     disconnect(tree, &QTreeWidget::itemChanged, this, &BlocknetCoinControl::onTreeItemChanged);
 }
 
 void BlocknetCoinControl::watch() {
-    table->blockSignals(false);
     tree->blockSignals(false);
-    table->setEnabled(true);
     tree->setEnabled(true);
-    connect(table, &QTableWidget::itemChanged, this, &BlocknetCoinControl::onItemChanged);
     connect(tree, &QTreeWidget::itemChanged, this, &BlocknetCoinControl::onTreeItemChanged);
 }
 
 bool BlocknetCoinControl::utxoForHash(const QString transaction, const uint vout, UTXO *&utxo) {
-    for (auto *item : dataModel->data) {
-        if (transaction == item->transaction && vout == item->vout) {
-            utxo = item;
-            return true;
-        }
-    }
-    return false;
-}
-
-QString BlocknetCoinControl::getTransactionHash(QTableWidgetItem *item) {
-    return table->item(item->row(), COLUMN_TXHASH)->data(Qt::DisplayRole).toString();
-}
-
-uint BlocknetCoinControl::getVOut(QTableWidgetItem *item) {
-    return table->item(item->row(), COLUMN_TXVOUT)->data(Qt::DisplayRole).toUInt();
+    if (!dataModel)
+        return false;
+    auto it = dataModel->index.find(UTXO::key(transaction, vout));
+    if (it == dataModel->index.end())
+        return false;
+    utxo = it->second;
+    return true;
 }
 
 QString BlocknetCoinControl::getTransactionHash(QTreeWidgetItem *item) {
@@ -868,8 +890,11 @@ bool BlocknetCoinControl::treeMode() {
 
 void BlocknetCoinControl::showTree(bool yes) {
     if (yes) {
+        if (treeDirty)
+            buildTree();
         table->setDisabled(true);
         table->hide();
+        filterLe->hide();
         tree->setDisabled(false);
         tree->show();
         tree->setFocus(Qt::FocusReason::MouseFocusReason);
@@ -878,16 +903,20 @@ void BlocknetCoinControl::showTree(bool yes) {
         tree->hide();
         table->setDisabled(false);
         table->show();
+        filterLe->show();
         table->setFocus(Qt::FocusReason::MouseFocusReason);
     }
 }
 
-BlocknetCoinControl::UTXO* BlocknetCoinControl::getTableUtxo(QTableWidgetItem *item, int row) {
+BlocknetCoinControl::UTXO* BlocknetCoinControl::getContextUtxo() {
     UTXO *utxo = nullptr;
-    if (utxoForHash(getTransactionHash(item), getVOut(item), utxo)) {
-        if (!utxo->isValid())
-            utxo = nullptr;
-    }
+    if (treeMode()) {
+        if (contextItemTr)
+            utxo = getTreeUtxo(contextItemTr);
+    } else if (contextIndex.isValid())
+        utxo = tableModel->utxoAt(contextIndex.row());
+    if (utxo && !utxo->isValid())
+        utxo = nullptr;
     return utxo;
 }
 
@@ -900,16 +929,14 @@ BlocknetCoinControl::UTXO* BlocknetCoinControl::getTreeUtxo(QTreeWidgetItem *ite
     return utxo;
 }
 
-void BlocknetCoinControl::onItemChanged(QTableWidgetItem *item) {
-    unwatch();
-    auto idx = table->itemIndex(item);
-    UTXO *utxo = getTableUtxo(item, idx.row());
-    if (utxo && utxo->locked)
-        item->setCheckState(Qt::Unchecked);
-    else
-        updateTreeUtxos(updateTableCheckStates({idx}, item->checkState()));
-    watch();
-    Q_EMIT tableUpdated();
+QList<BlocknetCoinControl::UTXO*> BlocknetCoinControl::selectedTableUtxos() {
+    QList<UTXO*> utxos;
+    for (const auto & idx : table->selectionModel()->selectedRows(COLUMN_CHECKBOX)) {
+        auto *utxo = tableModel->utxoAt(idx.row());
+        if (utxo)
+            utxos.push_back(utxo);
+    }
+    return utxos;
 }
 
 void BlocknetCoinControl::onTreeItemChanged(QTreeWidgetItem *item) {
@@ -920,7 +947,7 @@ void BlocknetCoinControl::onTreeItemChanged(QTreeWidgetItem *item) {
     if (utxo && utxo->locked)
         item->setCheckState(COLUMN_CHECKBOX, Qt::Unchecked);
     else
-        updateTableUtxos(updateTreeCheckStates({item}, item->checkState(COLUMN_CHECKBOX)));
+        tableModel->utxosChanged(updateTreeCheckStates({item}, item->checkState(COLUMN_CHECKBOX)));
     watch();
     Q_EMIT tableUpdated();
 }
@@ -930,51 +957,27 @@ bool BlocknetCoinControl::eventFilter(QObject *obj, QEvent *event) {
         auto *keyEvent = dynamic_cast<QKeyEvent*>(event);
         if (keyEvent->key() == Qt::Key_Space) {
             if (obj == table && table->selectionModel()->hasSelection()) {
-                auto *select = table->selectionModel();
-                if (select->hasSelection()) {
-                    unwatch();
-                    QMap<std::string, UTXO*> utxos;
-                    auto idxs = select->selectedRows(COLUMN_CHECKBOX);
-                    for (auto & idx : idxs) {
-                        auto *item = table->item(idx.row(), idx.column());
-                        if (item) {
-                            UTXO *utxo = getTableUtxo(item, idx.row());
-                            if (utxo && !utxo->locked)
-                                utxos[utxo->toString()] = utxo;
-                        }
-                    }
-                    // First check if they're all selected to determine
-                    // whether to deselect. Only deselect if all utxos
-                    // are selected.
-                    bool shouldDeselect{true};
-                    for (auto & item : utxos) {
-                        if (!item->checked) {
-                            shouldDeselect = false;
-                            break;
-                        }
-                    }
-                    for (auto & item : utxos)
-                        item->checked = !shouldDeselect;
-                    // Update list
-                    for (auto & idx : idxs) {
-                        auto *item = table->item(idx.row(), idx.column());
-                        if (item)
-                            item->setCheckState(!shouldDeselect ? Qt::Checked : Qt::Unchecked);
-                    }
-                    // Update tree
-                    for (int i = 0; i < tree->topLevelItemCount(); ++i) {
-                        auto *topLevelItem = tree->topLevelItem(i);
-                        for (int j = 0; j < topLevelItem->childCount(); ++j) {
-                            auto *item = topLevelItem->child(j);
-                            auto *utxo = getTreeUtxo(item);
-                            if (utxo && utxos.count(utxo->toString()))
-                                item->setCheckState(COLUMN_CHECKBOX, utxos[utxo->toString()]->checked ? Qt::Checked : Qt::Unchecked);
-                        }
+                QMap<std::string, UTXO*> utxos;
+                for (auto *utxo : selectedTableUtxos()) {
+                    if (!utxo->locked)
+                        utxos[utxo->toString()] = utxo;
+                }
+                // First check if they're all selected to determine
+                // whether to deselect. Only deselect if all utxos
+                // are selected.
+                bool shouldDeselect{true};
+                for (auto & item : utxos) {
+                    if (!item->checked) {
+                        shouldDeselect = false;
+                        break;
                     }
-                    watch();
-                    table->setFocus(Qt::FocusReason::MouseFocusReason);
-                    Q_EMIT tableUpdated();
                 }
+                for (auto & item : utxos)
+                    item->checked = !shouldDeselect;
+                tableModel->utxosChanged(utxos);
+                treeDirty = true;
+                table->setFocus(Qt::FocusReason::MouseFocusReason);
+                Q_EMIT tableUpdated();
             } else if (obj == tree && !tree->selectedItems().isEmpty()) {
                 auto items = tree->selectedItems();
                 if (!items.empty()) {
@@ -1010,14 +1013,7 @@ bool BlocknetCoinControl::eventFilter(QObject *obj, QEvent *event) {
                     for (auto & qitem : qitems)
                         qitem->setCheckState(COLUMN_CHECKBOX, !shouldDeselect ? Qt::Checked : Qt::Unchecked);
                     // Update list
-                    for (int row = 0; row < table->rowCount(); row++) {
-                        auto *item = table->item(row, COLUMN_TXHASH);
-                        auto *utxo = getTableUtxo(item, row);
-                        if (utxo && utxos.count(utxo->toString())) {
-                            item = table->item(row, COLUMN_CHECKBOX);
-                            item->setCheckState(!shouldDeselect ? Qt::Checked : Qt::Unchecked);
-                        }
-                    }
+                    tableModel->utxosChanged(utxos);
                     watch();
                     tree->setFocus(Qt::FocusReason::MouseFocusReason);
                     Q_EMIT tableUpdated();
@@ -1029,76 +1025,27 @@ bool BlocknetCoinControl::eventFilter(QObject *obj, QEvent *event) {
     return QObject::eventFilter(obj, event);
 }
 
-void BlocknetCoinControl::updateTableUtxos(const QMap<std::string, UTXO*> & utxos) {
-    for (int row = 0; row < table->rowCount(); row++) {
-        auto *item = table->item(row, COLUMN_TXHASH);
-        auto *utxo = getTableUtxo(item, row);
-        if (utxo && utxos.count(utxo->toString())) {
-            auto *putxo = utxos[utxo->toString()];
-            auto *cbItem = new QTableWidgetItem;
-            if (putxo->locked) {
-                cbItem->setIcon(QIcon(":/redesign/lock_closed_white"));
-                cbItem->setFlags(cbItem->flags() ^ Qt::ItemIsEditable);
-            } else {
-                cbItem->setCheckState(putxo->checked ? Qt::Checked : Qt::Unchecked);
-                cbItem->setFlags(cbItem->flags() | Qt::ItemIsEditable);
-            }
-            table->setItem(row, COLUMN_CHECKBOX, cbItem);
-        }
-    }
-}
-
-void BlocknetCoinControl::updateTreeUtxos(const QMap<std::string, UTXO*> & utxos) {
-    for (int i = 0; i < tree->topLevelItemCount(); ++i) {
-        auto *topLevelItem = tree->topLevelItem(i);
-        for (int j = 0; j < topLevelItem->childCount(); ++j) {
-            auto *item = topLevelItem->child(j);
-            auto *utxo = getTreeUtxo(item);
-            if (utxo && utxos.count(utxo->toString())) {
-                auto *putxo = utxos[utxo->toString()];
-                if (putxo->locked) {
-                    item->setIcon(COLUMN_CHECKBOX, QIcon(":/redesign/lock_closed_white"));
-                    item->setCheckState(COLUMN_CHECKBOX, Qt::Unchecked);
-                    item->setFlags(item->flags() ^ Qt::ItemIsEditable);
-                } else {
-                    item->setIcon(COLUMN_CHECKBOX, QIcon());
-                    item->setCheckState(COLUMN_CHECKBOX, putxo->checked ? Qt::Checked : Qt::Unchecked);
-                    item->setFlags(item->flags() | Qt::ItemIsEditable);
-                }
-            }
-        }
-    }
-}
-
-QMap<std::string, BlocknetCoinControl::UTXO*> BlocknetCoinControl::updateTableCheckStates(const QList<QModelIndex> & idxs, Qt::CheckState checkState, const bool *lockState) {
+QMap<std::string, BlocknetCoinControl::UTXO*> BlocknetCoinControl::updateTableCheckStates(const QList<UTXO*> & utxoList, Qt::CheckState checkState, const bool *lockState) {
     QMap<std::string, UTXO*> utxos;
-    for (auto & idx : idxs) {
-        auto *item = table->item(idx.row(), idx.column());
-        if (item) {
-            UTXO *utxo = getTableUtxo(item, idx.row());
-            if (lockState == nullptr && utxo && !utxo->locked && utxo->isValid()) {
-                utxo->checked = checkState == Qt::Checked;
-                item->setCheckState(checkState);
-                utxos[utxo->toString()] = utxo;
-            } else if (lockState != nullptr && utxo && utxo->isValid()) { // if lock state
-                utxo->locked = *lockState;
-                utxo->unlocked = !utxo->locked;
-                utxo->checked = false;
-                auto *cbItem = new QTableWidgetItem;
-                if (utxo->locked) {
-                    cbItem->setIcon(QIcon(":/redesign/lock_closed_white"));
-                    cbItem->setFlags(cbItem->flags() ^ Qt::ItemIsEditable);
-                    walletModel->wallet().lockCoin({uint256S(utxo->transaction.toStdString()), utxo->vout});
-                } else {
-                    cbItem->setCheckState(Qt::Unchecked);
-                    cbItem->setFlags(cbItem->flags() | Qt::ItemIsEditable);
-                    walletModel->wallet().unlockCoin({uint256S(utxo->transaction.toStdString()), utxo->vout});
-                }
-                table->setItem(idx.row(), COLUMN_CHECKBOX, cbItem);
-                utxos[utxo->toString()] = utxo;
-            }
+    for (auto *utxo : utxoList) {
+        if (!utxo || !utxo->isValid())
+            continue;
+        if (lockState == nullptr && !utxo->locked) {
+            utxo->checked = checkState == Qt::Checked;
+            utxos[utxo->toString()] = utxo;
+        } else if (lockState != nullptr) { // if lock state
+            utxo->locked = *lockState;
+            utxo->unlocked = !utxo->locked;
+            utxo->checked = false;
+            if (utxo->locked)
+                walletModel->wallet().lockCoin({uint256S(utxo->transaction.toStdString()), utxo->vout});
+            else
+                walletModel->wallet().unlockCoin({uint256S(utxo->transaction.toStdString()), utxo->vout});
+            utxos[utxo->toString()] = utxo;
         }
     }
+    tableModel->utxosChanged(utxos);
+    treeDirty = true;
     return utxos;
 }
 
@@ -1152,4 +1099,361 @@ QList<QTreeWidgetItem*> BlocknetCoinControl::allTreeItems() {
         }
     }
     return r;
-}
\ No newline at end of file
+}
+
+QVector<BlocknetCoinControl::UTXO*> BlocknetCoinControl::Model::load(const int count) {
+    QVector<UTXO*> loaded;
+    const auto n = std::min(static_cast<size_t>(std::max(count, 0)), pending.size());
+    if (n == 0 || !loader)
+        return loaded;
+    std::vector<COutPoint> coins(pending.begin(), pending.begin() + n);
+    pending.erase(pending.begin(), pending.begin() + n);
+    loaded = loader(coins);
+    for (auto *utxo : loaded) {
+        data.push_back(utxo);
+        index[utxo->toString()] = utxo;
+    }
+    return loaded;
+}
+
+const int BlocknetCoinControlModel::FETCH_BATCH;
+
+BlocknetCoinControlModel::BlocknetCoinControlModel(WalletModel *w, QObject *parent) : QAbstractTableModel(parent),
+    walletModel(w), lockIcon(":/redesign/lock_closed_white")
+{
+}
+
+void BlocknetCoinControlModel::setUtxos(BlocknetCoinControl::ModelPtr m) {
+    // Keep the previous utxos alive until the rows referencing them are replaced
+    auto previous = dataModel;
+
+    // Sorting and filtering cover every coin
+    if (m && (sortColumn >= 0 || !filter.isEmpty()))
+        m->loadAll();
+
+    if (!previous || rows.isEmpty() || !m || m->data.isEmpty()) {
+        beginResetModel();
+        dataModel = m;
+        rows.clear();
+        if (dataModel) {
+            for (auto *utxo : dataModel->data) {
+                if (matchesFilter(utxo))
+                    rows.push_back(utxo);
+            }
+            // Load the first batch so that the view starts out filled
+            if (rows.size() < FETCH_BATCH && dataModel->hasPending()) {
+                for (auto *utxo : dataModel->load(FETCH_BATCH - rows.size()))
+                    rows.push_back(utxo); // no filter, the filter loads everything
+            }
+        }
+        sortRows();
+        reindex();
+        fetched = std::min(rows.size(), FETCH_BATCH);
+        endResetModel();
+        return;
+    }
+
+    std::unordered_map<std::string, BlocknetCoinControl::UTXO*> incoming;
+    incoming.reserve(static_cast<size_t>(m->data.size()));
+    for (auto *utxo : m->data)
+        incoming[utxo->toString()] = utxo;
+
+    // Remove the spent utxos, from the back so that pending rows don't shift
+    for (int i = rows.size() - 1; i >= 0; --i) {
+        if (incoming.count(rows[i]->toString()))
+            continue;
+        if (i < fetched) {
+            beginRemoveRows(QModelIndex(), i, i);
+            rows.remove(i);
+            --fetched;
+            endRemoveRows();
+        } else
+            rows.remove(i);
+    }
+
+    // Point the remaining rows at the new utxos
+    std::unordered_set<std::string> existing;
+    existing.reserve(static_cast<size_t>(rows.size()));
+    for (auto & row : rows) {
+        auto key = row->toString();
+        row = incoming[key];
+        existing.insert(std::move(key));
+    }
+    dataModel = m;
+    if (fetched > 0)
+        Q_EMIT dataChanged(index(0, 0), index(fetched - 1, columnCount() - 1));
+
+    // Append the new utxos
+    QVector<BlocknetCoinControl::UTXO*> added;
+    for (auto *utxo : m->data) {
+        if (!existing.count(utxo->toString()) && matchesFilter(utxo))
+            added.push_back(utxo);
+    }
+    if (!added.isEmpty()) {
+        const bool allFetched = fetched == rows.size();
+        if (allFetched)
+            beginInsertRows(QModelIndex(), rows.size(), rows.size() + added.size() - 1);
+        rows += added;
+        if (allFetched) {
+            fetched = rows.size();
+            endInsertRows();
+        }
+    }
+
+    relayout();
+}
+
+void BlocknetCoinControlModel::clear() {
+    beginResetModel();
+    dataModel.reset();
+    rows.clear();
+    rowIndex.clear();
+    fetched = 0;
+    endResetModel();
+}
+
+void BlocknetCoinControlModel::loadAll() {
+    if (dataModel && dataModel->hasPending())
+        appendRows(dataModel->loadAll());
+}
+
+void BlocknetCoinControlModel::setFilter(const QString & f) {
+    if (f == filter)
+        return;
+    beginResetModel();
+    filter = f;
+    rows.clear();
+    if (dataModel) {
+        if (!filter.isEmpty())
+            dataModel->loadAll();
+        for (auto *utxo : dataModel->data) {
+            if (matchesFilter(utxo))
+                rows.push_back(utxo);
+        }
+    }
+    sortRows();
+    reindex();
+    fetched = std::min(rows.size(), FETCH_BATCH);
+    endResetModel();
+}
+
+void BlocknetCoinControlModel::utxosChanged(const QMap<std::string, BlocknetCoinControl::UTXO*> & utxos) {
+    // One range covering every changed row the view knows about
+    int first{-1}, last{-1};
+    for (auto it = utxos.constBegin(); it != utxos.constEnd(); ++it) {
+        auto row = rowIndex.find(it.key());
+        if (row == rowIndex.end() || row->second >= fetched)
+            continue;
+        if (first == -1 || row->second < first)
+            first = row->second;
+        if (row->second > last)
+            last = row->second;
+    }
+    if (first != -1)
+        Q_EMIT dataChanged(index(first, BlocknetCoinControl::COLUMN_CHECKBOX), index(last, BlocknetCoinControl::COLUMN_CHECKBOX));
+}
+
+BlocknetCoinControl::UTXO* BlocknetCoinControlModel::utxoAt(const int row) const {
+    if (row < 0 || row >= fetched)
+        return nullptr;
+    return rows[row];
+}
+
+int BlocknetCoinControlModel::rowCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : fetched;
+}
+
+int BlocknetCoinControlModel::columnCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : BlocknetCoinControl::COLUMN_TXVOUT + 1;
+}
+
+QVariant BlocknetCoinControlModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || index.row() >= fetched)
+        return QVariant();
+    auto *utxo = rows[index.row()];
+
+    switch (role) {
+        case Qt::DisplayRole:
+            switch (index.column()) {
+                case BlocknetCoinControl::COLUMN_AMOUNT:
+                    return utxo->amount;
+                case BlocknetCoinControl::COLUMN_LABEL:
+                    return utxo->label;
+                case BlocknetCoinControl::COLUMN_ADDRESS:
+                    return utxo->address;
+                case BlocknetCoinControl::COLUMN_DATE:
+                    return utxo->date;
+                case BlocknetCoinControl::COLUMN_CONFIRMATIONS:
+                    return QString::number(utxo->confirmations);
+                case BlocknetCoinControl::COLUMN_TXHASH:
+                    return utxo->transaction;
+                case BlocknetCoinControl::COLUMN_TXVOUT:
+                    return utxo->vout;
+                default:
+                    return QVariant();
+            }
+        case Qt::CheckStateRole:
+            if (index.column() == BlocknetCoinControl::COLUMN_CHECKBOX && !utxo->locked)
+                return utxo->checked ? Qt::Checked : Qt::Unchecked;
+            return QVariant();
+        case Qt::DecorationRole:
+            if (index.column() == BlocknetCoinControl::COLUMN_CHECKBOX && utxo->locked)
+                return lockIcon;
+            return QVariant();
+        default:
+            return QVariant();
+    }
+}
+
+bool BlocknetCoinControlModel::setData(const QModelIndex &index, const QVariant &value, int role) {
+    if (!index.isValid() || index.row() >= fetched || role != Qt::CheckStateRole
+        || index.column() != BlocknetCoinControl::COLUMN_CHECKBOX)
+        return false;
+    auto *utxo = rows[index.row()];
+    if (utxo->locked || !utxo->isValid())
+        return false;
+    utxo->checked = static_cast<Qt::CheckState>(value.toInt()) == Qt::Checked;
+    Q_EMIT dataChanged(index, index);
+    Q_EMIT checkStateToggled(utxo);
+    return true;
+}
+
+QVariant BlocknetCoinControlModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+        return QVariant();
+    switch (section) {
+        case BlocknetCoinControl::COLUMN_AMOUNT:
+            return tr("Amount");
+        case BlocknetCoinControl::COLUMN_LABEL:
+            return tr("Label");
+        case BlocknetCoinControl::COLUMN_ADDRESS:
+            return tr("Address");
+        case BlocknetCoinControl::COLUMN_DATE:
+            return tr("Date");
+        case BlocknetCoinControl::COLUMN_CONFIRMATIONS:
+            return tr("Confirmations");
+        default:
+            return QString();
+    }
+}
+
+Qt::ItemFlags BlocknetCoinControlModel::flags(const QModelIndex &index) const {
+    if (!index.isValid() || index.row() >= fetched)
+        return Qt::NoItemFlags;
+    Qt::ItemFlags f = Qt::ItemIsSelectable | Qt::ItemIsEnabled;
+    if (index.column() == BlocknetCoinControl::COLUMN_CHECKBOX && !rows[index.row()]->locked)
+        f |= Qt::ItemIsUserCheckable;
+    return f;
+}
+
+void BlocknetCoinControlModel::sort(int column, Qt::SortOrder order) {
+    switch (column) {
+        case BlocknetCoinControl::COLUMN_CHECKBOX:
+        case BlocknetCoinControl::COLUMN_AMOUNT:
+        case BlocknetCoinControl::COLUMN_LABEL:
+        case BlocknetCoinControl::COLUMN_ADDRESS:
+        case BlocknetCoinControl::COLUMN_DATE:
+        case BlocknetCoinControl::COLUMN_CONFIRMATIONS:
+            break;
+        default:
+            return; // padding and hidden columns
+    }
+    sortColumn = column;
+    sortOrder = order;
+    loadAll();
+    relayout();
+}
+
+bool BlocknetCoinControlModel::canFetchMore(const QModelIndex &parent) const {
+    return !parent.isValid() && (fetched < rows.size() || (dataModel && dataModel->hasPending()));
+}
+
+void BlocknetCoinControlModel::fetchMore(const QModelIndex &parent) {
+    if (parent.isValid())
+        return;
+    if (rows.size() - fetched < FETCH_BATCH && dataModel && dataModel->hasPending())
+        appendRows(dataModel->load(FETCH_BATCH));
+    const int count = std::min(rows.size() - fetched, FETCH_BATCH);
+    if (count <= 0)
+        return;
+    beginInsertRows(QModelIndex(), fetched, fetched + count - 1);
+    fetched += count;
+    endInsertRows();
+}
+
+bool BlocknetCoinControlModel::matchesFilter(BlocknetCoinControl::UTXO *utxo) const {
+    return filter.isEmpty()
+        || utxo->label.contains(filter, Qt::CaseInsensitive)
+        || utxo->address.contains(filter, Qt::CaseInsensitive)
+        || utxo->transaction.contains(filter, Qt::CaseInsensitive);
+}
+
+void BlocknetCoinControlModel::appendRows(const QVector<BlocknetCoinControl::UTXO*> & utxos) {
+    for (auto *utxo : utxos) {
+        if (!matchesFilter(utxo))
+            continue;
+        rowIndex[utxo->toString()] = rows.size();
+        rows.push_back(utxo);
+    }
+}
+
+void BlocknetCoinControlModel::sortRows() {
+    if (sortColumn < 0)
+        return;
+    const int column = sortColumn;
+    auto lessThan = [column](BlocknetCoinControl::UTXO *a, BlocknetCoinControl::UTXO *b) -> bool {
+        switch (column) {
+            case BlocknetCoinControl::COLUMN_CHECKBOX:
+                return a->checked < b->checked;
+            case BlocknetCoinControl::COLUMN_AMOUNT:
+                return a->camount < b->camount;
+            case BlocknetCoinControl::COLUMN_LABEL:
+                return BlocknetCoinControl::labelLessThan(a->label, b->label);
+            case BlocknetCoinControl::COLUMN_ADDRESS:
+                return a->address < b->address;
+            case BlocknetCoinControl::COLUMN_DATE:
+                return a->date < b->date;
+            case BlocknetCoinControl::COLUMN_CONFIRMATIONS:
+                return a->confirmations < b->confirmations;
+            default:
+                return false;
+        }
+    };
+    if (sortOrder == Qt::AscendingOrder)
+        std::stable_sort(rows.begin(), rows.end(), lessThan);
+    else
+        std::stable_sort(rows.begin(), rows.end(), [&lessThan](BlocknetCoinControl::UTXO *a, BlocknetCoinControl::UTXO *b) {
+            return lessThan(b, a);
+        });
+}
+
+void BlocknetCoinControlModel::relayout() {
+    Q_EMIT layoutAboutToBeChanged();
+    // Remember which utxo every persistent index (selection, current item) points at
+    const auto persistent = persistentIndexList();
+    QVector<BlocknetCoinControl::UTXO*> persistentUtxos;
+    for (const auto & idx : persistent)
+        persistentUtxos.push_back(idx.row() < fetched ? rows[idx.row()] : nullptr);
+
+    sortRows();
+    reindex();
+
+    QModelIndexList moved;
+    for (int i = 0; i < persistent.size(); ++i) {
+        auto *utxo = persistentUtxos[i];
+        auto it = utxo ? rowIndex.find(utxo->toString()) : rowIndex.end();
+        if (it == rowIndex.end() || it->second >= fetched)
+            moved.push_back(QModelIndex());
+        else
+            moved.push_back(index(it->second, persistent[i].column()));
+    }
+    changePersistentIndexList(persistent, moved);
+    Q_EMIT layoutChanged();
+}
+
+void BlocknetCoinControlModel::reindex() {
+    rowIndex.clear();
+    rowIndex.reserve(static_cast<size_t>(rows.size()));
+    for (int i = 0; i < rows.size(); ++i)
+        rowIndex[rows[i]->toString()] = i;
+}
@@ -11,23 +11,36 @@
 
 #include <qt/walletmodel.h>
 
+#include <primitives/transaction.h>
+
+#include <deque>
+#include <functional>
+#include <map>
 #include <memory>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
 
 #include <QDateTime>
 #include <QDialog>
 #include <QGridLayout>
 #include <QFrame>
+#include <QIcon>
 #include <QLabel>
 #include <QMenu>
+#include <QAbstractTableModel>
+#include <QLineEdit>
+#include <QPersistentModelIndex>
 #include <QRadioButton>
 #include <QStyledItemDelegate>
-#include <QTableWidget>
-#include <QTableWidgetItem>
+#include <QTableView>
 #include <QTreeWidget>
 #include <QVBoxLayout>
 #include <QVector>
 #include <QWidget>
 
+class BlocknetCoinControlModel;
+
 class BlocknetCoinControl : public QFrame {
     Q_OBJECT
 public:
@@ -56,36 +69,62 @@ public:
             return key(transaction, vout);
         }
     };
+    /**
+     * Owns the utxos. The wallet's coins are listed as outpoints up front and the
+     * utxos are only created by the loader when they're needed, see load().
+     */
     struct Model {
+        typedef std::function<QVector<UTXO*>(const std::vector<COutPoint> &)> Loader;
         double freeThreshold;
         double mempoolPriority;
+        //! Loaded utxos
         QVector<UTXO*> data;
-        void copy(Model &m) {
-            freeThreshold = m.freeThreshold;
-            mempoolPriority = m.mempoolPriority;
-            data = m.data;
+        //! Utxo lookup by key, see UTXO::toString()
+        std::unordered_map<std::string, UTXO*> index;
+        //! Coins that haven't been loaded yet
+        std::deque<COutPoint> pending;
+        //! Creates the utxos of the specified coins, coins that are gone are skipped
+        Loader loader;
+        Model() = default;
+        Model(const Model &) = delete;
+        Model& operator=(const Model &) = delete;
+        ~Model() {
+            qDeleteAll(data);
+        }
+        bool hasPending() const {
+            return !pending.empty();
         }
-        void copy(Model *m) {
-            copy(*m);
+        /** Loads the next count pending coins and returns the new utxos */
+        QVector<UTXO*> load(int count);
+        QVector<UTXO*> loadAll() {
+            return load(static_cast<int>(pending.size()));
         }
     };
     typedef std::shared_ptr<Model> ModelPtr;
 
+    enum {
+        COLUMN_PADDING1,
+        COLUMN_CHECKBOX,
+        COLUMN_PADDING2,
+        COLUMN_AMOUNT,
+        COLUMN_PADDING3,
+        COLUMN_LABEL,
+        COLUMN_PADDING4,
+        COLUMN_ADDRESS,
+        COLUMN_PADDING5,
+        COLUMN_DATE,
+        COLUMN_PADDING6,
+        COLUMN_CONFIRMATIONS,
+        COLUMN_TXHASH,
+        COLUMN_TXVOUT,
+    };
+
     void setData(ModelPtr dataModel);
     ModelPtr getData();
 
-    void clear() {
-        table->blockSignals(true);
-        if (dataModel != nullptr)
-            table->clearContents();
-        table->blockSignals(false);
-        tree->blockSignals(true);
-        if (dataModel != nullptr)
-            tree->clear();
-        tree->blockSignals(false);
-    };
+    void clear();
 
-    QTableWidget* getTable() {
+    QTableView* getTable() {
         return table;
     }
 
@@ -99,26 +138,19 @@ public Q_SLOTS:
 
 private Q_SLOTS:
     void showContextMenu(QPoint);
-    void onItemChanged(QTableWidgetItem *item);
     void onTreeItemChanged(QTreeWidgetItem *item);
 
-private:
-    class BlocknetTableWidget : public QTableWidget {
-    public:
-        QModelIndex itemIndex(QTableWidgetItem *item) {
-            return indexFromItem(item);
-        }
-    };
-
 private:
     WalletModel *walletModel = nullptr;
     QVBoxLayout *layout;
-    BlocknetTableWidget *table;
+    QTableView *table;
+    BlocknetCoinControlModel *tableModel;
     QTreeWidget *tree;
+    QLineEdit *filterLe;
     QRadioButton *listRb;
     QRadioButton *treeRb;
     QMenu *contextMenu;
-    QTableWidgetItem *contextItem = nullptr;
+    QPersistentModelIndex contextIndex;
     QTreeWidgetItem *contextItemTr = nullptr;
     QAction *selectCoins;
     QAction *deselectCoins;
@@ -134,98 +166,38 @@ private:
     QAction *collapseAll;
 
     ModelPtr dataModel = nullptr;
+    //! The tree is only built when it's shown, and rebuilt if the list changed in the meantime
+    bool treeDirty{true};
 
     void setClipboard(const QString &str);
     void unwatch();
     void watch();
     bool utxoForHash(QString transaction, uint vout, UTXO *&utxo);
-    QString getTransactionHash(QTableWidgetItem *item);
     QString getTransactionHash(QTreeWidgetItem *item);
-    uint getVOut(QTableWidgetItem *item);
     uint getVOut(QTreeWidgetItem *item);
     bool treeMode();
     void showTree(bool yes);
+    void buildTree();
 
-    UTXO* getTableUtxo(QTableWidgetItem *item, int row);
+    UTXO* getContextUtxo();
     UTXO* getTreeUtxo(QTreeWidgetItem *item);
-    void updateTableUtxos(const QMap<std::string, UTXO*> & utxos);
-    void updateTreeUtxos(const QMap<std::string, UTXO*> & utxos);
-    QMap<std::string, UTXO*> updateTableCheckStates(const QList<QModelIndex> & idxs, Qt::CheckState checkState, const bool *lockState=nullptr);
+    QList<UTXO*> selectedTableUtxos();
+    QMap<std::string, UTXO*> updateTableCheckStates(const QList<UTXO*> & utxos, Qt::CheckState checkState, const bool *lockState=nullptr);
     QMap<std::string, UTXO*> updateTreeCheckStates(const QList<QTreeWidgetItem*> & items, Qt::CheckState checkState, const bool *lockState=nullptr);
     QList<QTreeWidgetItem*> allTreeItems();
 
 private:
     bool eventFilter(QObject *obj, QEvent *event) override;
 
-    enum {
-        COLUMN_PADDING1,
-        COLUMN_CHECKBOX,
-        COLUMN_PADDING2,
-        COLUMN_AMOUNT,
-        COLUMN_PADDING3,
-        COLUMN_LABEL,
-        COLUMN_PADDING4,
-        COLUMN_ADDRESS,
-        COLUMN_PADDING5,
-        COLUMN_DATE,
-        COLUMN_PADDING6,
-        COLUMN_CONFIRMATIONS,
-        COLUMN_TXHASH,
-        COLUMN_TXVOUT,
-    };
-
-    class NumberItem : public QTableWidgetItem {
-    public:
-        explicit NumberItem() = default;
-        bool operator < (const QTableWidgetItem &other) const override {
-            auto i1 = text().toDouble();
-            auto i2 = other.text().toDouble();
-            return i1 < i2;
-        };
-    };
-    class PriorityItem : public QTableWidgetItem {
-    public:
-        explicit PriorityItem() = default;
-        enum {
-            PriorityRole = 200
-        };
-        bool operator < (const QTableWidgetItem &other) const override {
-            return data(PriorityRole).toDouble() < other.data(PriorityRole).toDouble();
-        };
-    };
-    class LabelItem : public QTableWidgetItem {
-    public:
-        explicit LabelItem() = default;
-        bool operator < (const QTableWidgetItem & other) const override {
-            auto label = data(Qt::DisplayRole).toString();
-            auto otherlabel = other.data(Qt::DisplayRole).toString();
-            if (label.contains("(") && otherlabel.contains("("))
-                return label.toStdString() < otherlabel.toStdString();
-            if (label.contains("("))
-                return false;
-            if (otherlabel.contains("("))
-                return true;
-            return label.toStdString() < otherlabel.toStdString();
-        };
-    };
-
     class TreeWidgetItem : public QTreeWidgetItem {
     public:
         explicit TreeWidgetItem(QTreeWidgetItem *parent = nullptr) : QTreeWidgetItem(parent) { }
         bool operator<(const QTreeWidgetItem & other) const {
             int column = treeWidget()->sortColumn();
 
-            if (column == COLUMN_LABEL) {
-                auto label = data(column, Qt::DisplayRole).toString();
-                auto otherlabel = other.data(column, Qt::DisplayRole).toString();
-                if (label.contains("(") && otherlabel.contains("("))
-                    return label.toStdString() < otherlabel.toStdString();
-                if (label.contains("("))
-                    return false;
-                if (otherlabel.contains("("))
-                    return true;
-                return label.toStdString() < otherlabel.toStdString();
-            }
+            if (column == COLUMN_LABEL)
+                return BlocknetCoinControl::labelLessThan(data(column, Qt::DisplayRole).toString(),
+                                                          other.data(column, Qt::DisplayRole).toString());
 
             if (column == BlocknetCoinControl::COLUMN_AMOUNT || column == BlocknetCoinControl::COLUMN_CONFIRMATIONS)
                 return data(column, Qt::UserRole).toLongLong() < other.data(column, Qt::UserRole).toLongLong();
@@ -244,6 +216,94 @@ private:
             return { s.width(), BGU::spi(25) };
         }
     };
+
+public:
+    /** Labels sort alphabetically with "(change)" and "(no label)" last */
+    static bool labelLessThan(const QString & label, const QString & otherlabel) {
+        if (label.contains("(") && otherlabel.contains("("))
+            return label.toStdString() < otherlabel.toStdString();
+        if (label.contains("("))
+            return false;
+        if (otherlabel.contains("("))
+            return true;
+        return label.toStdString() < otherlabel.toStdString();
+    }
+};
+
+/**
+ * Table model over the coin control utxos. Utxos are loaded from the wallet and handed
+ * to the view in batches as it scrolls (canFetchMore/fetchMore) and the display values
+ * are formatted on request, so opening the list doesn't depend on the number of coins
+ * in the wallet. Sorting and filtering need every coin and load the rest first, they
+ * reorder the row pointers in the model instead of rebuilding view items.
+ */
+class BlocknetCoinControlModel : public QAbstractTableModel {
+    Q_OBJECT
+public:
+    explicit BlocknetCoinControlModel(WalletModel *w, QObject *parent = nullptr);
+
+    /**
+     * Replaces the utxos. If the model already holds utxos the update is applied
+     * incrementally: spent utxos are removed, new utxos are added and the check
+     * state of existing utxos is carried over. The existing utxos should already
+     * be loaded in the new model, otherwise they're treated as spent.
+     * @param dataModel
+     */
+    void setUtxos(BlocknetCoinControl::ModelPtr dataModel);
+    void clear();
+
+    /** Loads the coins that haven't been loaded yet, e.g. before acting on all coins */
+    void loadAll();
+
+    /** Only utxos with a label, address or transaction id containing the filter are shown */
+    void setFilter(const QString & filter);
+
+    /** Notifies the view that the check or lock state of the utxos changed */
+    void utxosChanged(const QMap<std::string, BlocknetCoinControl::UTXO*> & utxos);
+
+    BlocknetCoinControl::UTXO* utxoAt(int row) const;
+
+    /** @name Methods overridden from QAbstractTableModel
+        @{*/
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role) const override;
+    bool setData(const QModelIndex &index, const QVariant &value, int role) override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role) const override;
+    Qt::ItemFlags flags(const QModelIndex &index) const override;
+    void sort(int column, Qt::SortOrder order) override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+    /*@}*/
+
+Q_SIGNALS:
+    /** Emitted when the user toggles a checkbox in the view */
+    void checkStateToggled(BlocknetCoinControl::UTXO *utxo);
+
+private:
+    /** Number of rows handed to the view per fetchMore */
+    static const int FETCH_BATCH = 256;
+
+    WalletModel *walletModel;
+    QIcon lockIcon;
+    BlocknetCoinControl::ModelPtr dataModel;
+    //! Filtered and sorted utxos
+    QVector<BlocknetCoinControl::UTXO*> rows;
+    //! Row of each utxo in rows
+    std::unordered_map<std::string, int> rowIndex;
+    //! Number of rows the view knows about
+    int fetched{0};
+    QString filter;
+    int sortColumn{-1};
+    Qt::SortOrder sortOrder{Qt::AscendingOrder};
+
+    bool matchesFilter(BlocknetCoinControl::UTXO *utxo) const;
+    /** Adds the utxos that match the filter to the rows past the ones the view knows about */
+    void appendRows(const QVector<BlocknetCoinControl::UTXO*> & utxos);
+    void sortRows();
+    /** Re-sorts the rows and moves the persistent indexes (selection) along with their utxos */
+    void relayout();
+    void reindex();
 };
 
 class BlocknetCoinControlDialog : public QDialog {
@@ -296,6 +356,10 @@ private:
     CAmount payAmount;
     bool standaloneMode;
     void updateLabels();
+    void refreshUnspentTransactions();
+    static QVector<BlocknetCoinControl::UTXO*> loadUtxos(WalletModel *walletModel, const std::vector<COutPoint> & coins,
+                                                         const std::set<COutPoint> & selected,
+                                                         std::map<QString, QString> & labels);
 };
 
 #endif // BLOCKNET_QT_BLOCKNETCOINCONTROL_H
@@ -21,6 +21,7 @@
 #include <uint256.h>
 #include <wallet/coincontrol.h>
 
+#include <set>
 #include <utility>
 
 #include <QAbstractItemView>
@@ -248,15 +249,29 @@ void BlocknetProposals::initialize() {
 
     const auto currentBlock = getChainHeight();
     const auto nextSuperblock = gov::Governance::nextSuperblock(Params().GetConsensus(), currentBlock);
+    // Read the generation first, changes made while loading are picked up on the next refresh
+    lastGeneration = gov::Governance::instance().getGeneration();
+    lastSuperblock = nextSuperblock;
     auto proposals = gov::Governance::instance().getProposals();
-    std::map<int, std::map<gov::Proposal, gov::Tally>> superblockResults;
 
-    // Get all superblock results
+    // Get all superblock results, only superblocks that changed are recomputed
+    std::set<int> superblocks;
     for (const auto & proposal : proposals) {
         const int superblock = proposal.getSuperblock();
-        if (superblockResults.count(superblock))
+        if (!superblocks.insert(superblock).second)
             continue;
-        superblockResults[superblock] = gov::Governance::instance().getSuperblockResults(superblock, Params().GetConsensus(), true);
+        const auto generation = gov::Governance::instance().getGeneration(superblock);
+        auto it = superblockResults.find(superblock);
+        if (it != superblockResults.end() && it->second.first == generation)
+            continue;
+        superblockResults[superblock] = std::make_pair(generation,
+                gov::Governance::instance().getSuperblockResults(superblock, Params().GetConsensus(), true));
+    }
+    for (auto it = superblockResults.begin(); it != superblockResults.end(); ) {
+        if (!superblocks.count(it->first))
+            it = superblockResults.erase(it);
+        else
+            ++it;
     }
     // Sort proposals descending
     std::sort(proposals.begin(), proposals.end(), [](const gov::Proposal & a, const gov::Proposal & b) {
@@ -264,7 +279,7 @@ void BlocknetProposals::initialize() {
     });
 
     for (const auto & proposal : proposals) {
-        const auto & sbResults = superblockResults[proposal.getSuperblock()];
+        const auto & sbResults = superblockResults[proposal.getSuperblock()].second;
 
         QString status = tr("Voting");
         QString results = tr("Failing");
@@ -552,7 +567,7 @@ bool BlocknetProposals::canVote() {
  * @param force Set true to force a refresh (bypass all checks).
  */
 void BlocknetProposals::refresh(bool force) {
-    if (!force && dataModel.size() == static_cast<int>(gov::Governance::instance().getProposals().size())) // ignore if the proposal list hasn't changed
+    if (!force && lastGeneration == gov::Governance::instance().getGeneration()) // ignore if the governance data hasn't changed
         return;
     initialize();
     onFilter();
@@ -641,11 +656,10 @@ void BlocknetProposals::showProposalDetails(const BlocknetProposal & proposal) {
 void BlocknetProposals::setNumBlocks(int count, const QDateTime &blockDate, double nVerificationProgress,
                                      bool header)
 {
-    // Only refresh proposal data if the cache changes
-    const auto newVotes = static_cast<int>(gov::Governance::instance().getVotes(gov::NextSuperblock(Params().GetConsensus(), count)).size());
-    const auto newProposals = static_cast<int>(gov::Governance::instance().getProposals().size());
-    if (lastVotes != newVotes || dataModel.size() != newProposals) {
-        lastVotes = newVotes;
+    // Only refresh proposal data if the governance data changes or a new voting period starts
+    if (lastGeneration != gov::Governance::instance().getGeneration()
+        || lastSuperblock != gov::NextSuperblock(Params().GetConsensus(), count))
+    {
         // refresh data
         initialize();
         onFilter();
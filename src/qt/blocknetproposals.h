@@ -101,7 +101,11 @@ private:
     int lastRow = -1;
     qint64 lastSelection = 0;
     bool syncInProgress = false;
-    int lastVotes{0};
+    //! Governance generation the data model was built from
+    uint64_t lastGeneration{0};
+    int lastSuperblock{0};
+    //! Superblock results and the superblock generation they were computed for
+    std::map<int, std::pair<uint64_t, std::map<gov::Proposal, gov::Tally>>> superblockResults;
 
     void initialize();
     void setData(QVector<BlocknetProposal> data);
@@ -0,0 +1,148 @@
+// Copyright (c) 2020 The Blocknet developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <qt/test/coincontroltests.h>
+
+#include <qt/blocknetcoincontrol.h>
+
+#include <uint256.h>
+
+#include <set>
+#include <vector>
+
+#include <QPersistentModelIndex>
+
+namespace {
+
+const uint256 txhash = uint256S("b1e8f1b1ae0c6f3d8b5c8e9d0a1b2c3d4e5f60718293a4b5c6d7e8f901234567");
+
+//! Coin n is output n of txhash with an amount of n
+BlocknetCoinControl::ModelPtr makeModel(const std::vector<uint32_t> & coins, const std::set<uint32_t> & selected = {}) {
+    auto m = std::make_shared<BlocknetCoinControl::Model>();
+    for (const auto n : coins)
+        m->pending.emplace_back(txhash, n);
+    m->loader = [selected](const std::vector<COutPoint> & batch) {
+        QVector<BlocknetCoinControl::UTXO*> utxos;
+        for (const auto & out : batch) {
+            auto *utxo = new BlocknetCoinControl::UTXO;
+            utxo->checked = selected.count(out.n) > 0;
+            utxo->amount = QString::number(out.n);
+            utxo->camount = out.n;
+            utxo->label = QString("label%1").arg(out.n);
+            utxo->address = QString("address%1").arg(out.n);
+            utxo->date = QDateTime::currentDateTime();
+            utxo->confirmations = out.n;
+            utxo->priority = 0;
+            utxo->transaction = QString::fromStdString(out.hash.GetHex());
+            utxo->vout = out.n;
+            utxo->locked = false;
+            utxo->unlocked = true;
+            utxos.push_back(utxo);
+        }
+        return utxos;
+    };
+    return m;
+}
+
+std::vector<uint32_t> range(const uint32_t begin, const uint32_t end) {
+    std::vector<uint32_t> r;
+    for (uint32_t n = begin; n < end; ++n)
+        r.push_back(n);
+    return r;
+}
+
+} // namespace
+
+void CoinControlTests::fetchTests()
+{
+    BlocknetCoinControlModel model(nullptr);
+    auto data = makeModel(range(0, 600));
+    model.setUtxos(data);
+
+    // Only the first batch is loaded from the wallet
+    QCOMPARE(model.rowCount(), 256);
+    QCOMPARE(data->data.size(), 256);
+    QVERIFY(data->hasPending());
+    QVERIFY(model.canFetchMore(QModelIndex()));
+
+    model.fetchMore(QModelIndex());
+    QCOMPARE(model.rowCount(), 512);
+    QCOMPARE(data->data.size(), 512);
+    QCOMPARE(model.utxoAt(300)->vout, 300u);
+
+    model.fetchMore(QModelIndex());
+    QCOMPARE(model.rowCount(), 600);
+    QVERIFY(!data->hasPending());
+    QVERIFY(!model.canFetchMore(QModelIndex()));
+
+    // Filtering searches every coin
+    BlocknetCoinControlModel filtered(nullptr);
+    auto filteredData = makeModel(range(0, 600));
+    filtered.setUtxos(filteredData);
+    filtered.setFilter("address59");
+    QVERIFY(!filteredData->hasPending());
+    QCOMPARE(filtered.rowCount(), 11); // 59, 590-599
+    QVERIFY(!filtered.canFetchMore(QModelIndex()));
+}
+
+void CoinControlTests::mergeTests()
+{
+    BlocknetCoinControlModel model(nullptr);
+    model.setUtxos(makeModel(range(0, 10)));
+    QCOMPARE(model.rowCount(), 10);
+
+    QVERIFY(model.setData(model.index(3, BlocknetCoinControl::COLUMN_CHECKBOX), Qt::Checked, Qt::CheckStateRole));
+    QPersistentModelIndex seven(model.index(7, BlocknetCoinControl::COLUMN_AMOUNT));
+
+    // Coin 5 was spent and coin 10 was received, the dialog loads the previously
+    // loaded coins up front and passes the checked coins as selected
+    auto coins = range(0, 11);
+    coins.erase(coins.begin() + 5);
+    auto next = makeModel(coins, {3});
+    next->load(static_cast<int>(coins.size()));
+    model.setUtxos(next);
+
+    QCOMPARE(model.rowCount(), 10);
+    for (int row = 0; row < model.rowCount(); ++row) {
+        auto *utxo = model.utxoAt(row);
+        QVERIFY(utxo->vout != 5u);
+        // rows point at the new utxos
+        QCOMPARE(next->index[utxo->toString()], utxo);
+    }
+    QCOMPARE(model.utxoAt(9)->vout, 10u);
+    QVERIFY(model.utxoAt(3)->checked);
+    QCOMPARE(model.data(model.index(3, BlocknetCoinControl::COLUMN_CHECKBOX), Qt::CheckStateRole).toInt(), static_cast<int>(Qt::Checked));
+
+    // The persistent index moved up with its utxo
+    QVERIFY(seven.isValid());
+    QCOMPARE(seven.row(), 6);
+    QCOMPARE(model.utxoAt(seven.row())->vout, 7u);
+}
+
+void CoinControlTests::relayoutTests()
+{
+    BlocknetCoinControlModel model(nullptr);
+    auto data = makeModel(range(0, 300));
+    model.setUtxos(data);
+    QVERIFY(data->hasPending());
+
+    QPersistentModelIndex high(model.index(200, BlocknetCoinControl::COLUMN_LABEL));
+    QPersistentModelIndex low(model.index(10, BlocknetCoinControl::COLUMN_LABEL));
+
+    // Sorting loads every coin and moves the persistent indexes along with their utxos
+    model.sort(BlocknetCoinControl::COLUMN_AMOUNT, Qt::DescendingOrder);
+    QVERIFY(!data->hasPending());
+    QCOMPARE(model.rowCount(), 256);
+    QCOMPARE(model.utxoAt(0)->vout, 299u);
+    QVERIFY(high.isValid());
+    QCOMPARE(high.row(), 99);
+    QCOMPARE(high.column(), static_cast<int>(BlocknetCoinControl::COLUMN_LABEL));
+    QCOMPARE(model.utxoAt(high.row())->vout, 200u);
+
+    // Coin 10 moved past the rows the view has fetched
+    QVERIFY(!low.isValid());
+    model.fetchMore(QModelIndex());
+    QCOMPARE(model.rowCount(), 300);
+    QCOMPARE(model.utxoAt(289)->vout, 10u);
+}
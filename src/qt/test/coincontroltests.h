@@ -0,0 +1,21 @@
+// Copyright (c) 2020 The Blocknet developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BLOCKNET_QT_TEST_COINCONTROLTESTS_H
+#define BLOCKNET_QT_TEST_COINCONTROLTESTS_H
+
+#include <QObject>
+#include <QTest>
+
+class CoinControlTests : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void fetchTests();
+    void mergeTests();
+    void relayoutTests();
+};
+
+#endif // BLOCKNET_QT_TEST_COINCONTROLTESTS_H
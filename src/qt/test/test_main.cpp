@@ -17,6 +17,7 @@
 
 #ifdef ENABLE_WALLET
 #include <qt/test/addressbooktests.h>
+#include <qt/test/coincontroltests.h>
 #ifdef ENABLE_BIP70
 #include <qt/test/paymentservertests.h>
 #endif // ENABLE_BIP70
@@ -107,6 +108,10 @@ int main(int argc, char *argv[])
     if (QTest::qExec(&test6) != 0) {
         fInvalid = true;
     }
+    CoinControlTests test7;
+    if (QTest::qExec(&test7) != 0) {
+        fInvalid = true;
+    }
 #endif
 
     fs::remove_all(pathTemp);
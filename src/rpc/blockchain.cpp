@@ -14,6 +14,8 @@
 #include <consensus/validation.h>
 #include <core_io.h>
 #include <hash.h>
+#include <index/addressindex.h>
+#include <index/blockfilterindex.h>
 #include <index/txindex.h>
 #include <key_io.h>
 #include <policy/feerate.h>
@@ -465,9 +467,9 @@ static void entryToJSON(UniValue &info, const CTxMemPoolEntry &e) EXCLUSIVE_LOCK
     info.pushKV("bip125-replaceable", rbfStatus);
 }
 
-UniValue mempoolToJSON(bool fVerbose)
+UniValue mempoolToJSON(bool fVerbose, JSONRPCStream* stream)
 {
-    if (fVerbose)
+    if (fVerbose && !stream)
     {
         LOCK(mempool.cs);
         UniValue o(UniValue::VOBJ);
@@ -480,16 +482,38 @@ UniValue mempoolToJSON(bool fVerbose)
         }
         return o;
     }
+    else if (fVerbose)
+    {
+        // Don't hold the mempool lock while the client reads the reply,
+        // transactions removed in the meantime are skipped.
+        std::vector<uint256> vtxid;
+        mempool.queryHashes(vtxid);
+
+        JSONRPCResultWriter o(stream, UniValue::VOBJ);
+        for (const uint256& hash : vtxid)
+        {
+            UniValue info(UniValue::VOBJ);
+            {
+                LOCK(mempool.cs);
+                const auto it = mempool.GetIter(hash);
+                if (!it)
+                    continue;
+                entryToJSON(info, **it);
+            }
+            o.pushKV(hash.ToString(), info);
+        }
+        return o.Finish();
+    }
     else
     {
         std::vector<uint256> vtxid;
         mempool.queryHashes(vtxid);
 
-        UniValue a(UniValue::VARR);
+        JSONRPCResultWriter a(stream, UniValue::VARR);
         for (const uint256& hash : vtxid)
             a.push_back(hash.ToString());
 
-        return a;
+        return a.Finish();
     }
 }
 
@@ -525,7 +549,7 @@ static UniValue getrawmempool(const JSONRPCRequest& request)
     if (!request.params[0].isNull())
         fVerbose = request.params[0].get_bool();
 
-    return mempoolToJSON(fVerbose);
+    return mempoolToJSON(fVerbose, request.stream);
 }
 
 static UniValue getmempoolancestors(const JSONRPCRequest& request)
@@ -2294,6 +2318,239 @@ UniValue scantxoutset(const JSONRPCRequest& request)
     return result;
 }
 
+static UniValue getblockfilter(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() < 1 || request.params.size() > 2)
+        throw std::runtime_error(
+            RPCHelpMan{"getblockfilter",
+                "\nRetrieve a BIP 157 content filter for a particular block.\n",
+                {
+                    {"blockhash", RPCArg::Type::STR_HEX, RPCArg::Optional::NO, "The hash of the block"},
+                    {"filtertype", RPCArg::Type::STR, /* default */ "basic", "The type name of the filter"},
+                },
+                RPCResult{
+            "{\n"
+            "  \"filter\" : (string) the hex-encoded filter data\n"
+            "  \"header\" : (string) the hex-encoded filter header\n"
+            "}\n"
+                },
+                RPCExamples{
+                    HelpExampleCli("getblockfilter", "\"00000000c937983704a73af28acdec37b049d214adbda81d7e2a3dd146f6ed09\" \"basic\"")
+            + HelpExampleRpc("getblockfilter", "\"00000000c937983704a73af28acdec37b049d214adbda81d7e2a3dd146f6ed09\", \"basic\"")
+                },
+            }.ToString());
+
+    uint256 block_hash = ParseHashV(request.params[0], "blockhash");
+    std::string filtertype_name = "basic";
+    if (!request.params[1].isNull()) {
+        filtertype_name = request.params[1].get_str();
+    }
+
+    BlockFilterType filtertype;
+    if (!BlockFilterTypeByName(filtertype_name, filtertype)) {
+        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Unknown filtertype");
+    }
+
+    BlockFilterIndex* index = GetBlockFilterIndex(filtertype);
+    if (!index) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Index is not enabled for filtertype " + filtertype_name);
+    }
+
+    const CBlockIndex* block_index;
+    bool block_was_connected;
+    {
+        LOCK(cs_main);
+        block_index = LookupBlockIndex(block_hash);
+        if (!block_index) {
+            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Block not found");
+        }
+        block_was_connected = block_index->IsValid(BLOCK_VALID_SCRIPTS);
+    }
+
+    bool index_ready = index->BlockUntilSyncedToCurrentChain();
+
+    BlockFilter filter;
+    uint256 filter_header;
+    if (!index->LookupFilter(block_index, filter) ||
+        !index->LookupFilterHeader(block_index, filter_header)) {
+        int err_code;
+        std::string errmsg = "Filter not found.";
+
+        if (!block_was_connected) {
+            err_code = RPC_INVALID_ADDRESS_OR_KEY;
+            errmsg += " Block was not connected to active chain.";
+        } else if (!index_ready) {
+            err_code = RPC_MISC_ERROR;
+            errmsg += " Block filters are still in the process of being indexed.";
+        } else {
+            err_code = RPC_INTERNAL_ERROR;
+            errmsg += " This error is unexpected and indicates index corruption.";
+        }
+
+        throw JSONRPCError(err_code, errmsg);
+    }
+
+    UniValue ret(UniValue::VOBJ);
+    ret.pushKV("filter", HexStr(filter.GetEncodedFilter()));
+    ret.pushKV("header", filter_header.GetHex());
+    return ret;
+}
+
+/** Returns the address index after it caught up with the chain, throws if -addressindex is off. */
+static AddressIndex& GetAddressIndex()
+{
+    if (!g_addressindex) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Address index is not enabled, restart with -addressindex");
+    }
+    g_addressindex->BlockUntilSyncedToCurrentChain();
+    return *g_addressindex;
+}
+
+static CScript ParseAddressScript(const UniValue& param)
+{
+    const std::string& address = param.get_str();
+    const CTxDestination dest = DecodeDestination(address);
+    if (!IsValidDestination(dest)) {
+        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, strprintf("'address' parameter %s is invalid", address));
+    }
+    return GetScriptForDestination(dest);
+}
+
+static UniValue getaddressutxos(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() != 1)
+        throw std::runtime_error(
+            RPCHelpMan{"getaddressutxos",
+                "\nReturns the unspent outputs paying to an address. Requires -addressindex.\n",
+                {
+                    {"address", RPCArg::Type::STR, RPCArg::Optional::NO, "The blocknet address"},
+                },
+                RPCResult{
+            "[\n"
+            "  {\n"
+            "    \"txid\" : \"hash\",          (string) The transaction id\n"
+            "    \"vout\" : n,               (numeric) The output index\n"
+            "    \"amount\" : x.xxx,         (numeric) The output value in " + CURRENCY_UNIT + "\n"
+            "    \"height\" : n,             (numeric) The height of the block containing the output\n"
+            "    \"scriptPubKey\" : \"hex\"    (string) The hex-encoded scriptPubKey of the output\n"
+            "  }\n"
+            "  ,...\n"
+            "]\n"
+                },
+                RPCExamples{
+                    HelpExampleCli("getaddressutxos", "\"Bdu16u6WPBkDh5f23Zhqo5k8Dp6DS4ffJa\"")
+            + HelpExampleRpc("getaddressutxos", "\"Bdu16u6WPBkDh5f23Zhqo5k8Dp6DS4ffJa\"")
+                },
+            }.ToString());
+
+    const CScript script = ParseAddressScript(request.params[0]);
+    std::vector<AddressUnspent> unspent;
+    if (!GetAddressIndex().FindUnspent(script, unspent)) {
+        throw JSONRPCError(RPC_INTERNAL_ERROR, "Failed to read the address index");
+    }
+
+    const std::string scriptHex = HexStr(script.begin(), script.end());
+    UniValue ret(UniValue::VARR);
+    for (const auto& utxo : unspent) {
+        UniValue o(UniValue::VOBJ);
+        o.pushKV("txid", utxo.outpoint.hash.GetHex());
+        o.pushKV("vout", static_cast<int>(utxo.outpoint.n));
+        o.pushKV("amount", ValueFromAmount(utxo.amount));
+        o.pushKV("height", utxo.height);
+        o.pushKV("scriptPubKey", scriptHex);
+        ret.push_back(o);
+    }
+    return ret;
+}
+
+static UniValue getaddressbalance(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() != 1)
+        throw std::runtime_error(
+            RPCHelpMan{"getaddressbalance",
+                "\nReturns the confirmed balance of an address and the total it received. Requires -addressindex.\n",
+                {
+                    {"address", RPCArg::Type::STR, RPCArg::Optional::NO, "The blocknet address"},
+                },
+                RPCResult{
+            "{\n"
+            "  \"balance\" : x.xxx,          (numeric) The sum of the unspent outputs in " + CURRENCY_UNIT + "\n"
+            "  \"received\" : x.xxx          (numeric) The sum of all outputs ever paid to the address in " + CURRENCY_UNIT + "\n"
+            "}\n"
+                },
+                RPCExamples{
+                    HelpExampleCli("getaddressbalance", "\"Bdu16u6WPBkDh5f23Zhqo5k8Dp6DS4ffJa\"")
+            + HelpExampleRpc("getaddressbalance", "\"Bdu16u6WPBkDh5f23Zhqo5k8Dp6DS4ffJa\"")
+                },
+            }.ToString());
+
+    const CScript script = ParseAddressScript(request.params[0]);
+    CAmount balance{0}, received{0};
+    if (!GetAddressIndex().GetBalance(script, balance, received)) {
+        throw JSONRPCError(RPC_INTERNAL_ERROR, "Failed to read the address index");
+    }
+
+    UniValue ret(UniValue::VOBJ);
+    ret.pushKV("balance", ValueFromAmount(balance));
+    ret.pushKV("received", ValueFromAmount(received));
+    return ret;
+}
+
+static UniValue getaddressdeltas(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() < 1 || request.params.size() > 3)
+        throw std::runtime_error(
+            RPCHelpMan{"getaddressdeltas",
+                "\nReturns every credit and debit of an address in chain order. Requires -addressindex.\n",
+                {
+                    {"address", RPCArg::Type::STR, RPCArg::Optional::NO, "The blocknet address"},
+                    {"start", RPCArg::Type::NUM, /* default */ "0", "The first block height to include"},
+                    {"end", RPCArg::Type::NUM, /* default */ "0", "The last block height to include, 0 for the chain tip"},
+                },
+                RPCResult{
+            "[\n"
+            "  {\n"
+            "    \"txid\" : \"hash\",          (string) The transaction id\n"
+            "    \"index\" : n,              (numeric) The output index when receiving, the input index when spending\n"
+            "    \"spending\" : true|false,  (boolean) Whether the transaction spends from the address\n"
+            "    \"amount\" : x.xxx,         (numeric) The change in " + CURRENCY_UNIT + ", negative when spending\n"
+            "    \"height\" : n              (numeric) The height of the block containing the transaction\n"
+            "  }\n"
+            "  ,...\n"
+            "]\n"
+                },
+                RPCExamples{
+                    HelpExampleCli("getaddressdeltas", "\"Bdu16u6WPBkDh5f23Zhqo5k8Dp6DS4ffJa\"")
+            + HelpExampleCli("getaddressdeltas", "\"Bdu16u6WPBkDh5f23Zhqo5k8Dp6DS4ffJa\" 1000 2000")
+            + HelpExampleRpc("getaddressdeltas", "\"Bdu16u6WPBkDh5f23Zhqo5k8Dp6DS4ffJa\", 1000, 2000")
+                },
+            }.ToString());
+
+    const CScript script = ParseAddressScript(request.params[0]);
+    const int start = request.params[1].isNull() ? 0 : request.params[1].get_int();
+    const int end = request.params[2].isNull() ? 0 : request.params[2].get_int();
+    if (start < 0 || end < 0 || (end != 0 && end < start)) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid start or end height");
+    }
+
+    std::vector<AddressDelta> deltas;
+    if (!GetAddressIndex().FindDeltas(script, start, end, deltas)) {
+        throw JSONRPCError(RPC_INTERNAL_ERROR, "Failed to read the address index");
+    }
+
+    UniValue ret(UniValue::VARR);
+    for (const auto& delta : deltas) {
+        UniValue o(UniValue::VOBJ);
+        o.pushKV("txid", delta.txid.GetHex());
+        o.pushKV("index", static_cast<int>(delta.index));
+        o.pushKV("spending", delta.spending);
+        o.pushKV("amount", ValueFromAmount(delta.amount));
+        o.pushKV("height", delta.height);
+        ret.push_back(o);
+    }
+    return ret;
+}
+
 // clang-format off
 static const CRPCCommand commands[] =
 { //  category              name                      actor (function)         argNames
@@ -2321,6 +2578,10 @@ static const CRPCCommand commands[] =
 
     { "blockchain",         "preciousblock",          &preciousblock,          {"blockhash"} },
     { "blockchain",         "scantxoutset",           &scantxoutset,           {"action", "scanobjects"} },
+    { "blockchain",         "getblockfilter",         &getblockfilter,         {"blockhash", "filtertype"} },
+    { "blockchain",         "getaddressutxos",        &getaddressutxos,        {"address"} },
+    { "blockchain",         "getaddressbalance",      &getaddressbalance,      {"address"} },
+    { "blockchain",         "getaddressdeltas",       &getaddressdeltas,       {"address", "start", "end"} },
 
     /* Not shown in help */
     { "hidden",             "invalidateblock",        &invalidateblock,        {"blockhash"} },
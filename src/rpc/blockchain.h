@@ -11,6 +11,7 @@
 
 class CBlock;
 class CBlockIndex;
+class JSONRPCStream;
 class UniValue;
 
 static constexpr int NUM_GETBLOCKSTATS_PERCENTILES = 5;
@@ -32,8 +33,8 @@ UniValue blockToJSON(const CBlock& block, const CBlockIndex* tip, const CBlockIn
 /** Mempool information to JSON */
 UniValue mempoolInfoToJSON();
 
-/** Mempool to JSON */
-UniValue mempoolToJSON(bool fVerbose = false);
+/** Mempool to JSON, streamed when a stream is given (see JSONRPCResultWriter) */
+UniValue mempoolToJSON(bool fVerbose = false, JSONRPCStream* stream = nullptr);
 
 /** Block header to JSON */
 UniValue blockheaderToJSON(const CBlockIndex* tip, const CBlockIndex* blockindex);
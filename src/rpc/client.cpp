@@ -71,6 +71,8 @@ static const CRPCConvertParam vRPCConvertParams[] =
     { "sendmany", 6 , "conf_target" },
     { "deriveaddresses", 1, "range" },
     { "scantxoutset", 1, "scanobjects" },
+    { "getaddressdeltas", 1, "start" },
+    { "getaddressdeltas", 2, "end" },
     { "addmultisigaddress", 0, "nrequired" },
     { "addmultisigaddress", 1, "keys" },
     { "createmultisig", 0, "nrequired" },
@@ -166,6 +168,7 @@ static const CRPCConvertParam vRPCConvertParams[] =
     { "createwallet", 1, "disable_private_keys"},
     { "createwallet", 2, "blank"},
     { "getnodeaddresses", 0, "count"},
+    { "getnetmsgstats", 0, "peers" },
     { "stop", 0, "wait" },
     { "servicenodecreateinputs", 1, "nodecount" },
     { "servicenodecreateinputs", 2, "inputsize" },
@@ -209,6 +212,7 @@ static const CRPCConvertParam vRPCConvertParams[] =
     { "xrDecodeRawTransaction", 2, "arg2" },
     { "xrSendTransaction", 2, "arg2" },
     { "xrServiceConsensus", 0, "arg0" },
+    { "xrSubmitQuery", 2, "arg2" },
     { "xrUpdateConfigs", 0, "arg0" },
     { "xrGetBalance", 2, "arg2" },
     { "xrGetTxBloomFilter", 2, "arg2" },
@@ -147,7 +147,7 @@ static UniValue listproposals(const JSONRPCRequest& request)
     const auto proposals = gov::Governance::instance().getProposalsSince(sinceBlock);
     std::map<int, std::map<gov::Proposal, gov::Tally>> superblockResults;
 
-    UniValue ret(UniValue::VARR);
+    JSONRPCResultWriter ret(request, UniValue::VARR);
     for (const auto & proposal : proposals) {
         auto results = superblockResults[proposal.getSuperblock()];
         if (proposal.getSuperblock() <= superblock && results.empty()) {
@@ -180,7 +180,7 @@ static UniValue listproposals(const JSONRPCRequest& request)
         prop.pushKV("status", status);
         ret.push_back(prop);
     }
-    return ret;
+    return ret.Finish();
 }
 
 static UniValue vote(const JSONRPCRequest& request)
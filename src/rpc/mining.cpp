@@ -994,6 +994,9 @@ static UniValue getstakingstatus(const JSONRPCRequest& request)
                     "  \"lastblockprocessed\": n,   (numeric) Last block processed for staking\n"
                     "  \"fullyunlocked\": n,        (boolean) Wallet fully unlocked\n"
                     "  \"unlockedforstaking\": n,   (boolean) Wallet unlocked for staking only\n"
+                    "  \"templateheight\": n,       (numeric) Height of the pre-assembled staking block template (0 if none)\n"
+                    "  \"templatetxs\": n,          (numeric) Number of mempool transactions in the staking block template\n"
+                    "  \"lasttimetobroadcast\": n,  (numeric) Milliseconds between the last kernel hit and its block being relayed\n"
                     "  \"status\": \"xxx\",         (string) Status message\n"
                     "}\n"
                 },
@@ -1017,6 +1020,8 @@ static UniValue getstakingstatus(const JSONRPCRequest& request)
     const auto lastUpdatedTime = g_staker ? g_staker->LastUpdateTime() : 0;
     const auto lastUpdatedStr = xbridge::iso8601(boost::posix_time::from_time_t(lastUpdatedTime));
     const auto lastBlock = g_staker ? g_staker->LastBlockHeight() : 0;
+    const auto stakeTemplate = g_staker ? g_staker->GetStakeTemplate() : nullptr;
+    const auto lastTimeToBroadcast = g_staker ? g_staker->LastTimeToBroadcast() : 0;
 
     CAmount balance{0};
     bool allLocked{true};
@@ -1048,6 +1053,9 @@ static UniValue getstakingstatus(const JSONRPCRequest& request)
     obj.pushKV("lastblockprocessed", lastBlock);
     obj.pushKV("fullyunlocked", !allLocked && !util::unlockedForStakingOnly);
     obj.pushKV("unlockedforstaking", util::unlockedForStakingOnly);
+    obj.pushKV("templateheight", stakeTemplate ? stakeTemplate->nHeight : 0);
+    obj.pushKV("templatetxs", stakeTemplate ? static_cast<int64_t>(stakeTemplate->nBlockTx) : 0);
+    obj.pushKV("lasttimetobroadcast", static_cast<double>(lastTimeToBroadcast) / 1000.0);
     obj.pushKV("hasoutgoingpeers", connected);
     obj.pushKV("status", msg);
     return obj;
@@ -1058,6 +1066,9 @@ static UniValue getstakingstatus(const JSONRPCRequest& request)
     obj.pushKV("lastblockprocessed", 0);
     obj.pushKV("fullyunlocked", false);
     obj.pushKV("unlockedforstaking", false);
+    obj.pushKV("templateheight", 0);
+    obj.pushKV("templatetxs", 0);
+    obj.pushKV("lasttimetobroadcast", 0);
     obj.pushKV("hasoutgoingpeers", connected);
     obj.pushKV("status", "Staking is inactive because the wallet is disabled");
     return obj;
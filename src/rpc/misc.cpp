@@ -18,6 +18,7 @@
 #include <rpc/util.h>
 #include <script/descriptor.h>
 #include <timedata.h>
+#include <txcache.h>
 #include <util/system.h>
 #include <util/strencodings.h>
 #include <warnings.h>
@@ -413,6 +414,22 @@ static UniValue RPCLockedMemoryInfo()
     return obj;
 }
 
+static UniValue RPCTxCacheInfo()
+{
+    UniValue obj(UniValue::VOBJ);
+    if (!g_txcache)
+        return obj;
+    const auto stats = g_txcache->GetStats();
+    const uint64_t lookups = stats.hits + stats.misses;
+    obj.pushKV("entries", uint64_t(stats.entries));
+    obj.pushKV("usage", uint64_t(stats.usage));
+    obj.pushKV("max_usage", uint64_t(stats.maxUsage));
+    obj.pushKV("hits", stats.hits);
+    obj.pushKV("misses", stats.misses);
+    obj.pushKV("hit_rate", lookups > 0 ? static_cast<double>(stats.hits) / lookups : 0.0);
+    return obj;
+}
+
 #ifdef HAVE_MALLOC_INFO
 static std::string RPCMallocInfo()
 {
@@ -456,6 +473,14 @@ static UniValue getmemoryinfo(const JSONRPCRequest& request)
             "    \"locked\": xxxxxx,       (numeric) Amount of bytes that succeeded locking. If this number is smaller than total, locking pages failed at some point and key data could be swapped to disk.\n"
             "    \"chunks_used\": xxxxx,   (numeric) Number allocated chunks\n"
             "    \"chunks_free\": xxxxx,   (numeric) Number unused chunks\n"
+            "  },\n"
+            "  \"txcache\": {              (json object) Information about the confirmed transaction cache, empty if disabled\n"
+            "    \"entries\": xxxxx,       (numeric) Number of cached transactions\n"
+            "    \"usage\": xxxxx,         (numeric) Number of bytes used\n"
+            "    \"max_usage\": xxxxx,     (numeric) Maximum number of bytes, see -txcache\n"
+            "    \"hits\": xxxxx,          (numeric) Lookups served from the cache\n"
+            "    \"misses\": xxxxx,        (numeric) Lookups that were not cached\n"
+            "    \"hit_rate\": x.xxx       (numeric) Fraction of lookups served from the cache\n"
             "  }\n"
             "}\n"
                     },
@@ -473,6 +498,7 @@ static UniValue getmemoryinfo(const JSONRPCRequest& request)
     if (mode == "stats") {
         UniValue obj(UniValue::VOBJ);
         obj.pushKV("locked", RPCLockedMemoryInfo());
+        obj.pushKV("txcache", RPCTxCacheInfo());
         return obj;
     } else if (mode == "mallocinfo") {
 #ifdef HAVE_MALLOC_INFO
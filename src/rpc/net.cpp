@@ -125,6 +125,10 @@ static UniValue getpeerinfo(const JSONRPCRequest& request)
             "                               When a message type is not listed in this json object, the bytes received are 0.\n"
             "                               Only known message types can appear as keys in the object and all bytes received of unknown message types are listed under '"+NET_MESSAGE_COMMAND_OTHER+"'.\n"
             "       ...\n"
+            "    },\n"
+            "    \"queued_per_class\": {\n"
+            "       \"class\": n,             (numeric) Received messages waiting to be processed per priority class (block, default, overlay)\n"
+            "       ...\n"
             "    }\n"
             "  }\n"
             "  ,...\n"
@@ -203,6 +207,11 @@ static UniValue getpeerinfo(const JSONRPCRequest& request)
         }
         obj.pushKV("bytesrecv_per_msg", recvPerMsgCmd);
 
+        UniValue queuedPerClass(UniValue::VOBJ);
+        for (int i = 0; i < MSG_CLASS_COUNT; ++i)
+            queuedPerClass.pushKV(MessageClassToString(static_cast<MessageClass>(i)), (uint64_t)stats.vProcessQueued[i]);
+        obj.pushKV("queued_per_class", queuedPerClass);
+
         ret.push_back(obj);
     }
 
@@ -423,6 +432,86 @@ static UniValue getnettotals(const JSONRPCRequest& request)
     return obj;
 }
 
+static UniValue MsgCmdStatsToJSON(const mapMsgCmdStats& mapStats)
+{
+    UniValue ret(UniValue::VOBJ);
+    for (const auto& i : mapStats) {
+        const CMsgCmdStats& stats = i.second;
+        if (stats.nCount == 0)
+            continue;
+        UniValue obj(UniValue::VOBJ);
+        obj.pushKV("count", stats.nCount);
+        obj.pushKV("bytes", stats.nBytes);
+        obj.pushKV("dropped", stats.nDropped);
+        obj.pushKV("time", stats.nTimeTotal);
+        obj.pushKV("avgtime", stats.nTimeTotal / stats.nCount);
+        obj.pushKV("maxtime", stats.nTimeMax);
+        ret.pushKV(i.first, obj);
+    }
+    return ret;
+}
+
+static UniValue getnetmsgstats(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() > 1)
+        throw std::runtime_error(
+            RPCHelpMan{"getnetmsgstats",
+                "\nReturns processing statistics of received messages aggregated by message type,\n"
+                "in total since startup and optionally per connected peer.\n",
+                {
+                    {"peers", RPCArg::Type::BOOL, /* default */ "false", "Include the statistics of each connected peer"},
+                },
+                RPCResult{
+            "{\n"
+            "  \"total\": {                   (json object) all messages received since startup\n"
+            "    \"msg\": {                   (json object) a message type, only types received at least once are listed\n"
+            "      \"count\": n,              (numeric) messages processed\n"
+            "      \"bytes\": n,              (numeric) bytes received including message headers\n"
+            "      \"dropped\": n,            (numeric) messages with an invalid header or checksum, or rejected by the handler\n"
+            "      \"time\": n,               (numeric) total time spent in the handler in microseconds\n"
+            "      \"avgtime\": n,            (numeric) average time spent in the handler in microseconds\n"
+            "      \"maxtime\": n             (numeric) longest time spent in the handler in microseconds\n"
+            "    }\n"
+            "    ,...\n"
+            "  },\n"
+            "  \"peers\": [                   (json array) only with peers=true\n"
+            "    {\n"
+            "      \"id\": n,                 (numeric) peer index\n"
+            "      \"addr\": \"host:port\",     (string) the IP address and port of the peer\n"
+            "      \"msgs\": { ... }          (json object) the statistics of the peer, like total\n"
+            "    }\n"
+            "    ,...\n"
+            "  ]\n"
+            "}\n"
+                },
+                RPCExamples{
+                    HelpExampleCli("getnetmsgstats", "")
+            + HelpExampleCli("getnetmsgstats", "true")
+            + HelpExampleRpc("getnetmsgstats", "true")
+                },
+            }.ToString());
+    if(!g_connman)
+        throw JSONRPCError(RPC_CLIENT_P2P_DISABLED, "Error: Peer-to-peer functionality missing or disabled");
+
+    UniValue obj(UniValue::VOBJ);
+    obj.pushKV("total", MsgCmdStatsToJSON(g_connman->GetMessageStats()));
+
+    if (!request.params[0].isNull() && request.params[0].get_bool()) {
+        std::vector<CNodeStats> vstats;
+        g_connman->GetNodeStats(vstats);
+        UniValue peers(UniValue::VARR);
+        for (const CNodeStats& stats : vstats) {
+            UniValue peer(UniValue::VOBJ);
+            peer.pushKV("id", stats.nodeid);
+            peer.pushKV("addr", stats.addrName);
+            peer.pushKV("msgs", MsgCmdStatsToJSON(stats.mapProcessStatsPerMsgCmd));
+            peers.push_back(peer);
+        }
+        obj.pushKV("peers", peers);
+    }
+    return obj;
+}
+
 static UniValue GetNetworksInfo()
 {
     UniValue networks(UniValue::VARR);
@@ -463,6 +552,17 @@ static UniValue getnetworkinfo(const JSONRPCRequest& request)
             "  \"timeoffset\": xxxxx,                   (numeric) the time offset\n"
             "  \"connections\": xxxxx,                  (numeric) the number of connections\n"
             "  \"networkactive\": true|false,           (bool) whether p2p networking is enabled\n"
+            "  \"socketevents\": \"xxx\",                (string) the socket events mode, either epoll, poll or select\n"
+            "  \"msgclasses\": {                        (json object) received message processing per priority class\n"
+            "    \"class\": {                           (json object) block, default or overlay\n"
+            "      \"queued\": xxxxx,                   (numeric) messages waiting to be processed over all peers\n"
+            "      \"queuedbytes\": xxxxx,              (numeric) bytes waiting to be processed over all peers\n"
+            "      \"processed\": xxxxx,                (numeric) messages processed since startup\n"
+            "      \"avglatency\": xxxxx,               (numeric) average time in milliseconds between receipt and processing\n"
+            "      \"maxlatency\": xxxxx                (numeric) maximum time in milliseconds between receipt and processing\n"
+            "    }\n"
+            "    ,...\n"
+            "  },\n"
             "  \"networks\": [                          (array) information per network\n"
             "  {\n"
             "    \"name\": \"xxx\",                     (string) network (ipv4, ipv6 or onion)\n"
@@ -505,7 +605,21 @@ static UniValue getnetworkinfo(const JSONRPCRequest& request)
     obj.pushKV("timeoffset",    GetTimeOffset());
     if (g_connman) {
         obj.pushKV("networkactive", g_connman->GetNetworkActive());
+        obj.pushKV("socketevents",  SocketEventsModeToString(g_connman->GetSocketEventsMode()));
         obj.pushKV("connections",   (int)g_connman->GetNodeCount(CConnman::CONNECTIONS_ALL));
+        UniValue msgClasses(UniValue::VOBJ);
+        const auto classStats = g_connman->GetMessageClassStats();
+        for (int i = 0; i < MSG_CLASS_COUNT; ++i) {
+            const auto& stats = classStats[i];
+            UniValue entry(UniValue::VOBJ);
+            entry.pushKV("queued", (uint64_t)stats.nQueued);
+            entry.pushKV("queuedbytes", (uint64_t)stats.nQueuedBytes);
+            entry.pushKV("processed", stats.nProcessed);
+            entry.pushKV("avglatency", stats.nProcessed ? (double)stats.nLatencyTotal / stats.nProcessed / 1000 : 0.0);
+            entry.pushKV("maxlatency", (double)stats.nLatencyMax / 1000);
+            msgClasses.pushKV(MessageClassToString(static_cast<MessageClass>(i)), entry);
+        }
+        obj.pushKV("msgclasses", msgClasses);
     }
     obj.pushKV("networks",      GetNetworksInfo());
     obj.pushKV("relayfee",      ValueFromAmount(::minRelayTxFee.GetFeePerK()));
@@ -755,6 +869,7 @@ static const CRPCCommand commands[] =
     { "network",            "disconnectnode",         &disconnectnode,         {"address", "nodeid"} },
     { "network",            "getaddednodeinfo",       &getaddednodeinfo,       {"node"} },
     { "network",            "getnettotals",           &getnettotals,           {} },
+    { "network",            "getnetmsgstats",         &getnetmsgstats,         {"peers"} },
     { "network",            "getnetworkinfo",         &getnetworkinfo,         {} },
     { "network",            "setban",                 &setban,                 {"subnet", "command", "bantime", "absolute"} },
     { "network",            "listbanned",             &listbanned,             {} },
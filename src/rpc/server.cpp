@@ -39,10 +39,55 @@ struct RPCCommandExecutionInfo
     int64_t start;
 };
 
+//! Upper bounds of the getrpcinfo histogram buckets in microseconds, the last bucket is unbounded
+static const int64_t RPC_HISTOGRAM_BOUNDS[] = {100, 1000, 10000, 100000, 1000000, 10000000};
+
+struct RPCTimeHistogram
+{
+    uint64_t count{0};
+    uint64_t total{0};
+    uint64_t max{0};
+    uint64_t buckets[ARRAYLEN(RPC_HISTOGRAM_BOUNDS) + 1]{};
+
+    void Add(int64_t time)
+    {
+        const uint64_t t = std::max<int64_t>(time, 0);
+        ++count;
+        total += t;
+        max = std::max(max, t);
+        size_t i = 0;
+        while (i < ARRAYLEN(RPC_HISTOGRAM_BOUNDS) && time >= RPC_HISTOGRAM_BOUNDS[i])
+            ++i;
+        ++buckets[i];
+    }
+
+    UniValue ToJSON() const
+    {
+        UniValue ret(UniValue::VOBJ);
+        ret.pushKV("count", count);
+        ret.pushKV("avg", count ? total / count : 0);
+        ret.pushKV("max", max);
+        UniValue histogram(UniValue::VARR);
+        for (uint64_t n : buckets)
+            histogram.push_back(n);
+        ret.pushKV("histogram", histogram);
+        return ret;
+    }
+};
+
+struct RPCMethodStats
+{
+    //! Time from receipt by the transport to the start of the call
+    RPCTimeHistogram queue;
+    //! Time spent in the call
+    RPCTimeHistogram exec;
+};
+
 struct RPCServerInfo
 {
     Mutex mutex;
     std::list<RPCCommandExecutionInfo> active_commands GUARDED_BY(mutex);
+    std::map<std::string, RPCMethodStats> method_stats GUARDED_BY(mutex);
 };
 
 static RPCServerInfo g_rpc_server_info;
@@ -50,14 +95,20 @@ static RPCServerInfo g_rpc_server_info;
 struct RPCCommandExecution
 {
     std::list<RPCCommandExecutionInfo>::iterator it;
-    explicit RPCCommandExecution(const std::string& method)
+    int64_t received;
+    explicit RPCCommandExecution(const std::string& method, int64_t received) : received(received)
     {
         LOCK(g_rpc_server_info.mutex);
         it = g_rpc_server_info.active_commands.insert(g_rpc_server_info.active_commands.end(), {method, GetTimeMicros()});
     }
     ~RPCCommandExecution()
     {
+        const int64_t end = GetTimeMicros();
         LOCK(g_rpc_server_info.mutex);
+        RPCMethodStats& stats = g_rpc_server_info.method_stats[it->method];
+        if (received > 0)
+            stats.queue.Add(it->start - received);
+        stats.exec.Add(end - it->start);
         g_rpc_server_info.active_commands.erase(it);
     }
 };
@@ -312,7 +363,20 @@ static UniValue getrpcinfo(const JSONRPCRequest& request)
             "    \"method\"       (string)  The name of the RPC command \n"
             "    \"duration\"     (numeric)  The running time in microseconds\n"
             "   },...\n"
-            "  ]\n"
+            "  ],\n"
+            " \"histogram_bounds\" (array) Upper bounds of the histogram buckets in microseconds, the last bucket is unbounded\n"
+            " \"methods\" (object) Timing of the commands called since startup\n"
+            "  {\n"
+            "   \"method\": {     (object) The name of the RPC command\n"
+            "    \"queue\": {     (object) Time between receipt by the HTTP server and the start of the call\n"
+            "     \"count\"      (numeric) Number of calls\n"
+            "     \"avg\"        (numeric) Average time in microseconds\n"
+            "     \"max\"        (numeric) Maximum time in microseconds\n"
+            "     \"histogram\"  (array)   Number of calls per histogram bucket\n"
+            "    },\n"
+            "    \"exec\": { ... } (object) Time spent in the call, like queue\n"
+            "   },...\n"
+            "  }\n"
             "}\n"
                 },
                 RPCExamples{
@@ -331,8 +395,22 @@ static UniValue getrpcinfo(const JSONRPCRequest& request)
         active_commands.push_back(entry);
     }
 
+    UniValue bounds(UniValue::VARR);
+    for (int64_t bound : RPC_HISTOGRAM_BOUNDS)
+        bounds.push_back(bound);
+
+    UniValue methods(UniValue::VOBJ);
+    for (const auto& entry : g_rpc_server_info.method_stats) {
+        UniValue obj(UniValue::VOBJ);
+        obj.pushKV("queue", entry.second.queue.ToJSON());
+        obj.pushKV("exec", entry.second.exec.ToJSON());
+        methods.pushKV(entry.first, obj);
+    }
+
     UniValue result(UniValue::VOBJ);
     result.pushKV("active_commands", active_commands);
+    result.pushKV("histogram_bounds", bounds);
+    result.pushKV("methods", methods);
 
     return result;
 }
@@ -573,7 +651,7 @@ UniValue CRPCTable::execute(const JSONRPCRequest &request) const
 
     try
     {
-        RPCCommandExecution execution(request.strMethod);
+        RPCCommandExecution execution(request.strMethod, request.received);
         // Execute, convert arguments to array if necessary
         if (request.params.isObject()) {
             return pcmd->actor(transformNamedArguments(request, pcmd->argNames));
@@ -587,6 +665,36 @@ UniValue CRPCTable::execute(const JSONRPCRequest &request) const
     }
 }
 
+JSONRPCResultWriter::JSONRPCResultWriter(JSONRPCStream* stream, UniValue::VType type) : stream(stream), result(type)
+{
+    assert(type == UniValue::VARR || type == UniValue::VOBJ);
+}
+
+void JSONRPCResultWriter::push_back(const UniValue& val)
+{
+    assert(result.isArray());
+    if (!stream)
+        result.push_back(val);
+    else if (!stream->Push(UniValue::VARR, nullptr, val))
+        throw JSONRPCError(RPC_MISC_ERROR, "Client disconnected");
+}
+
+void JSONRPCResultWriter::pushKV(const std::string& key, const UniValue& val)
+{
+    assert(result.isObject());
+    if (!stream)
+        result.__pushKV(key, val);
+    else if (!stream->Push(UniValue::VOBJ, &key, val))
+        throw JSONRPCError(RPC_MISC_ERROR, "Client disconnected");
+}
+
+UniValue JSONRPCResultWriter::Finish()
+{
+    UniValue ret = std::move(result);
+    result = UniValue(ret.getType());
+    return ret;
+}
+
 std::vector<std::string> CRPCTable::listCommands() const
 {
     std::vector<std::string> commandList;
@@ -36,6 +36,21 @@ struct UniValueType {
     UniValue::VType type;
 };
 
+/**
+ * Receives the elements of an array or object result while it is being built, so
+ * that the transport can send them before the handler returns. See JSONRPCResultWriter.
+ */
+class JSONRPCStream
+{
+public:
+    virtual ~JSONRPCStream() {}
+    /**
+     * Write one element of the result. key is nullptr for array elements.
+     * Returns false if the client is gone and the handler should stop.
+     */
+    virtual bool Push(UniValue::VType type, const std::string* key, const UniValue& val) = 0;
+};
+
 class JSONRPCRequest
 {
 public:
@@ -46,11 +61,39 @@ public:
     std::string URI;
     std::string authUser;
     std::string peerAddr;
+    /** Set by transports that can stream the result, not owned */
+    JSONRPCStream* stream;
+    /** Time the transport received the request in microseconds, 0 if unknown */
+    int64_t received;
 
-    JSONRPCRequest() : id(NullUniValue), params(NullUniValue), fHelp(false) {}
+    JSONRPCRequest() : id(NullUniValue), params(NullUniValue), fHelp(false), stream(nullptr), received(0) {}
     void parse(const UniValue& valRequest);
 };
 
+/**
+ * Builds an array or object result element by element. When the request has a
+ * stream each element is handed to it as soon as it is pushed and the full result
+ * is never held in memory, otherwise the elements are collected as usual. Handlers
+ * must return Finish() and only one writer may be used per request.
+ */
+class JSONRPCResultWriter
+{
+public:
+    JSONRPCResultWriter(JSONRPCStream* stream, UniValue::VType type);
+    JSONRPCResultWriter(const JSONRPCRequest& request, UniValue::VType type) : JSONRPCResultWriter(request.stream, type) {}
+
+    /** Throws a JSONRPCError if the client disconnected. */
+    void push_back(const UniValue& val);
+    /** Keys are not checked for duplicates. Throws a JSONRPCError if the client disconnected. */
+    void pushKV(const std::string& key, const UniValue& val);
+    /** The collected result, or an empty one if the elements were streamed. */
+    UniValue Finish();
+
+private:
+    JSONRPCStream* stream;
+    UniValue result;
+};
+
 /** Query whether RPC is running */
 bool IsRPCRunning();
 
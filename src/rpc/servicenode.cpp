@@ -711,7 +711,7 @@ static UniValue servicenodelist(const JSONRPCRequest& request)
                 },
             }.ToString());
 
-    UniValue ret(UniValue::VARR);
+    JSONRPCResultWriter ret(request, UniValue::VARR);
 
     // List all the service node entries and their statuses
     const auto & snodes = sn::ServiceNodeMgr::instance().list();
@@ -734,7 +734,7 @@ static UniValue servicenodelist(const JSONRPCRequest& request)
         ret.push_back(obj);
     }
 
-    return ret;
+    return ret.Finish();
 }
 
 static UniValue servicenodesendping(const JSONRPCRequest& request)
@@ -835,6 +835,38 @@ static UniValue servicenodecount(const JSONRPCRequest& request)
     return obj;
 }
 
+static UniValue servicenodepacketstats(const JSONRPCRequest& request)
+{
+    if (request.fHelp || !request.params.empty())
+        throw std::runtime_error(
+            RPCHelpMan{"servicenodepacketstats",
+                "\nReturns the state of the filter used to drop service node and xbridge packets that were already relayed.\n",
+                {},
+                RPCResult{
+                "{\n"
+                "  \"capacity\": n,            (numeric) Number of packets remembered before the oldest start rolling off\n"
+                "  \"falsepositiverate\": n,   (numeric) Maximum rate at which unseen packets are reported as seen\n"
+                "  \"inserted\": n,            (numeric) Packets added to the filter since startup\n"
+                "  \"duplicates\": n,          (numeric) Packets dropped because they were already seen\n"
+                "  \"memoryusage\": n,         (numeric) Memory used by the filter in bytes\n"
+                "}\n"
+                },
+                RPCExamples{
+                    HelpExampleCli("servicenodepacketstats", "")
+                  + HelpExampleRpc("servicenodepacketstats", "")
+                },
+            }.ToString());
+
+    const auto stats = sn::ServiceNodeMgr::instance().seenPacketStats();
+    UniValue obj(UniValue::VOBJ);
+    obj.pushKV("capacity", static_cast<uint64_t>(stats.capacity));
+    obj.pushKV("falsepositiverate", stats.fpRate);
+    obj.pushKV("inserted", stats.inserted);
+    obj.pushKV("duplicates", stats.duplicates);
+    obj.pushKV("memoryusage", static_cast<uint64_t>(stats.memoryUsage));
+    return obj;
+}
+
 static UniValue servicenodelegacy(const JSONRPCRequest& request)
 {
     if (request.fHelp || request.params.size() != 1)
@@ -918,6 +950,7 @@ static const CRPCCommand commands[] =
     { "servicenode",        "servicenodesendping",     &servicenodesendping,     {} },
     { "servicenode",        "servicenoderemove",       &servicenoderemove,       {"alias"} },
     { "servicenode",        "servicenodecount",        &servicenodecount,        {} },
+    { "servicenode",        "servicenodepacketstats",  &servicenodepacketstats,  {} },
     { "servicenode",        "servicenode",             &servicenodelegacy,       {"command"} },
 };
 // clang-format on
@@ -6,10 +6,12 @@
 #define BLOCKNET_SERVICENODE_SERVICENODEMGR_H
 
 #include <amount.h>
+#include <bloom.h>
 #include <key_io.h>
 #include <net.h>
 #include <netmessagemaker.h>
 #include <servicenode/servicenode.h>
+#include <servicenode/validationqueue.h>
 #include <script/standard.h>
 #include <streams.h>
 #include <sync.h>
@@ -17,10 +19,12 @@
 #include <util/system.h>
 #include <validation.h>
 #include <validationinterface.h>
+#include <version.h>
 #ifdef ENABLE_WALLET
 #include <wallet/wallet.h>
 #endif // ENABLE_WALLET
 
+#include <functional>
 #include <iostream>
 #include <numeric>
 #include <set>
@@ -28,6 +32,7 @@
 
 #include <boost/algorithm/string.hpp>
 #include <boost/filesystem.hpp>
+#include <boost/signals2/signal.hpp>
 
 /**
  * Servicenode namepsace
@@ -70,6 +75,27 @@ struct ServiceNodeConfigEntry {
     }
 };
 
+/** Number of packet hashes the seen packet filter remembers before the oldest start rolling off */
+static const unsigned int SEEN_PACKETS_FILTER_SIZE = 350000;
+/** False positive rate of the seen packet filter, a false positive drops a packet that wasn't seen */
+static const double SEEN_PACKETS_FILTER_FPRATE = 0.000001;
+
+/** Default number of threads validating servicenode registrations and pings */
+static const int DEFAULT_SNODE_VALIDATION_THREADS = 2;
+/** Maximum number of servicenode packets waiting on validation, beyond this packets are validated inline */
+static const size_t MAX_SNODE_VALIDATION_QUEUE = 10000;
+
+/**
+ * Seen packet filter state.
+ */
+struct SeenPacketStats {
+    unsigned int capacity{SEEN_PACKETS_FILTER_SIZE};
+    double fpRate{SEEN_PACKETS_FILTER_FPRATE};
+    uint64_t inserted{0};
+    uint64_t duplicates{0};
+    size_t memoryUsage{0};
+};
+
 /**
  * Manages related servicenode functions including handling network messages and storing an active list
  * of valid servicenodes.
@@ -87,6 +113,14 @@ public:
         return smgr;
     }
 
+    /**
+     * Notifications for servicenodes received from the network. These are emitted from
+     * the thread that validated the packet, without the servicenode lock held.
+     */
+    boost::signals2::signal<void (const ServiceNode & snode)> NotifyServiceNodeRegistered;
+    boost::signals2::signal<void (const ServiceNodePing & ping)> NotifyServiceNodePing;
+    boost::signals2::signal<void (const CPubKey & snodePubKey)> NotifyServiceNodeRemoved;
+
     /**
      * Clears the internal state.
      */
@@ -94,7 +128,9 @@ public:
         LOCK(mu);
         snodes.clear();
         pings.clear();
-        seenPackets.clear();
+        seenPackets.reset();
+        seenPacketsInserted = 0;
+        seenPacketsDuplicates = 0;
         snodeEntries.clear();
         seenBlocks.clear();
     }
@@ -132,6 +168,8 @@ public:
         } catch (...) {
             return false;
         }
+        if (validationQueue.full())
+            return false; // dropped, snode packets are gossiped again
         if (seenPacket(sn.getHash()))
             return false;
 
@@ -140,9 +178,101 @@ public:
             return false;
 
         snode = *snptr;
+        NotifyServiceNodeRegistered(snode);
+        return true;
+    }
+
+    /**
+     * Queues a servicenode registration message from the network for validation. The
+     * callback is run with the added snode once the registration is validated, callbacks
+     * run in the order the registrations were queued. If no validation threads are running
+     * the registration is validated before this returns. Returns false if the packet is
+     * malformed or was already seen, or if the validation queue is full in which case the
+     * packet is dropped without marking it seen.
+     * @param ss
+     * @param callback
+     * @return
+     */
+    bool queueRegistration(CDataStream & ss, const std::function<void(const ServiceNode & snode)> & callback) {
+        ServiceNode sn;
+        try {
+            ss >> sn;
+        } catch (...) {
+            return false;
+        }
+        if (validationQueue.full())
+            return false; // dropped, snode packets are gossiped again
+        if (seenPacket(sn.getHash()))
+            return false;
+
+        auto validate = [sn]() -> bool {
+            return sn.isValid(GetTxFunc, IsServiceNodeBlockValidFunc);
+        };
+        auto apply = [this,sn,callback](const bool valid) {
+            if (!valid)
+                return;
+            auto snptr = addSn(sn, false); // already validated
+            callback(*snptr);
+            NotifyServiceNodeRegistered(*snptr);
+        };
+        if (validationQueue.push(validate, apply) == ValidationQueue::NO_WORKERS)
+            apply(validate());
+        return true;
+    }
+
+    /**
+     * Queues a servicenode ping message from the network for validation. The callback is
+     * run with the ping if it's valid and newer than the last known ping, callbacks run in
+     * the order the pings were queued. If no validation threads are running the ping is
+     * validated before this returns. Returns false if the packet is malformed or was
+     * already seen, or if the validation queue is full in which case the packet is dropped
+     * without marking it seen.
+     * @param ss
+     * @param callback
+     * @return
+     */
+    bool queuePing(CDataStream & ss, const std::function<void(const ServiceNodePing & ping)> & callback) {
+        ServiceNodePing ping;
+        try {
+            ss >> ping;
+        } catch (...) {
+            return false;
+        }
+        if (validationQueue.full())
+            return false; // dropped, snode packets are gossiped again
+        if (seenPacket(ping.getHash()))
+            return false;
+
+        auto validate = [ping]() -> bool {
+            return ping.isValid(GetTxFunc, IsServiceNodeBlockValidFunc);
+        };
+        auto apply = [this,ping,callback](const bool valid) {
+            if (!valid || !addPing(ping))
+                return;
+            addSn(ping.getSnode(), false); // skip validity check here because it's checked in the ping's
+            callback(ping);
+            NotifyServiceNodePing(ping);
+        };
+        if (validationQueue.push(validate, apply) == ValidationQueue::NO_WORKERS)
+            apply(validate());
         return true;
     }
 
+    /**
+     * Runs a servicenode validation worker, returns when the thread is interrupted.
+     */
+    void threadValidation() {
+        validationQueue.loop();
+    }
+
+    /**
+     * Number of queued servicenode packets that haven't been validated and applied.
+     * @return
+     */
+    size_t pendingValidations() {
+        return validationQueue.pending();
+    }
+
     /**
      * Process cached registration. This skips the stale snode check.
      * @param ss
@@ -180,6 +310,8 @@ public:
         } catch (...) {
             return false;
         }
+        if (validationQueue.full())
+            return false; // dropped, snode packets are gossiped again
         if (seenPacket(ping.getHash()))
             return false;
 
@@ -190,6 +322,7 @@ public:
             return false;
 
         addSn(ping.getSnode(), false); // skip validity check here because it's checked in the ping's
+        NotifyServiceNodePing(ping);
         return true;
     }
 
@@ -325,12 +458,8 @@ public:
         }
 
         // Relay
-        connman->ForEachNode([&](CNode* pnode) {
-            if (!pnode->fSuccessfullyConnected)
-                return;
-            const CNetMsgMaker msgMaker(pnode->GetSendVersion());
-            connman->PushMessage(pnode, msgMaker.Make(NetMsgType::SNREGISTER, *snodePtr));
-        });
+        const CNetMsgMaker msgMaker(PROTOCOL_VERSION);
+        connman->BroadcastMessage(msgMaker.Make(NetMsgType::SNREGISTER, *snodePtr));
 
         return true;
     }
@@ -376,12 +505,8 @@ public:
         addSn(ping.getSnode(), false); // skip validity check here because it's checked in the ping's
 
         // Relay
-        connman->ForEachNode([&](CNode* pnode) {
-            if (!pnode->fSuccessfullyConnected)
-                return;
-            const CNetMsgMaker msgMaker(pnode->GetSendVersion());
-            connman->PushMessage(pnode, msgMaker.Make(NetMsgType::SNPING, ping));
-        });
+        const CNetMsgMaker msgMaker(PROTOCOL_VERSION);
+        connman->BroadcastMessage(msgMaker.Make(NetMsgType::SNPING, ping));
 
         return true;
     }
@@ -795,6 +920,19 @@ public:
         return false;
     }
 
+    /**
+     * Returns the seen packet filter stats.
+     * @return
+     */
+    SeenPacketStats seenPacketStats() {
+        LOCK(mu);
+        SeenPacketStats stats;
+        stats.inserted = seenPacketsInserted;
+        stats.duplicates = seenPacketsDuplicates;
+        stats.memoryUsage = seenPackets.DynamicMemoryUsage();
+        return stats;
+    }
+
 protected:
     /**
      * Returns the height of the longest chain.
@@ -899,8 +1037,11 @@ protected:
     bool removeSn(const CPubKey & snodePubKey) {
         if (!hasSn(snodePubKey))
             return false;
-        LOCK(mu);
-        snodes.erase(snodePubKey);
+        {
+            LOCK(mu);
+            snodes.erase(snodePubKey);
+        }
+        NotifyServiceNodeRemoved(snodePubKey);
         return true;
     }
 
@@ -921,11 +1062,12 @@ protected:
      */
     bool seenPacket(const uint256 & hash) {
         LOCK(mu);
-        if (seenPackets.count(hash))
+        if (seenPackets.contains(hash)) {
+            ++seenPacketsDuplicates;
             return true; // already seen
-        if (seenPackets.size() > 350000)
-            seenPackets.clear(); // mem mgmt, ~12MB (32bytes * 350k)
-        seenPackets.insert(hash);
+        }
+        seenPackets.insert(hash); // oldest generation rolls off, memory is fixed
+        ++seenPacketsInserted;
         return false;
     }
 
@@ -1248,9 +1390,12 @@ protected:
     Mutex mu;
     std::map<CPubKey, ServiceNodePtr> snodes;
     std::unordered_map<CPubKey, ServiceNodePing, Hasher> pings;
-    std::set<uint256> seenPackets;
+    CRollingBloomFilter seenPackets{SEEN_PACKETS_FILTER_SIZE, SEEN_PACKETS_FILTER_FPRATE};
+    uint64_t seenPacketsInserted{0};
+    uint64_t seenPacketsDuplicates{0};
     std::set<ServiceNodeConfigEntry> snodeEntries;
     std::vector<int> seenBlocks;
+    ValidationQueue validationQueue{MAX_SNODE_VALIDATION_QUEUE};
 };
 
 }
@@ -0,0 +1,182 @@
+// Copyright (c) 2020 The Blocknet developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BLOCKNET_SERVICENODE_VALIDATIONQUEUE_H
+#define BLOCKNET_SERVICENODE_VALIDATIONQUEUE_H
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <utility>
+
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+
+namespace sn {
+
+/**
+ * Queue for servicenode packet validations. Packets are validated in parallel by
+ * any number of worker threads, the validation results are applied one at a time
+ * in the order the packets were pushed. This allows the expensive signature and
+ * collateral checks to run off the message handler thread without reordering
+ * updates to the servicenode list.
+ */
+class ValidationQueue {
+public:
+    /** Runs the validation, safe to call concurrently */
+    typedef std::function<bool()> ValidateFunc;
+    /** Applies the validation result, calls are serialized and in push order */
+    typedef std::function<void(bool)> ApplyFunc;
+
+    /** Result of queueing a validation */
+    enum PushResult {
+        QUEUED,     //!< validated and applied by the workers
+        NO_WORKERS, //!< the caller is expected to validate synchronously
+        FULL,       //!< too many pending validations, the caller is expected to drop the packet
+    };
+
+    explicit ValidationQueue(const size_t maxPending) : maxPending(maxPending) {}
+
+    /**
+     * Queues a validation. Nothing is queued if there are no workers or the queue is
+     * full. Validating synchronously while the queue is full would apply the result
+     * ahead of older queued packets.
+     * @param validate
+     * @param apply
+     * @return
+     */
+    PushResult push(ValidateFunc validate, ApplyFunc apply) {
+        {
+            boost::unique_lock<boost::mutex> lock(mutex);
+            if (nWorkers == 0)
+                return NO_WORKERS;
+            if (nPending >= maxPending)
+                return FULL;
+            ++nPending;
+            Job job;
+            job.seq = nextSeq++;
+            job.validate = std::move(validate);
+            job.apply = std::move(apply);
+            queue.push_back(std::move(job));
+        }
+        cond.notify_one();
+        return QUEUED;
+    }
+
+    /**
+     * Worker loop, returns when the thread is interrupted.
+     */
+    void loop() {
+        {
+            boost::unique_lock<boost::mutex> lock(mutex);
+            ++nWorkers;
+        }
+        try {
+            while (true) {
+                Job job;
+                {
+                    boost::unique_lock<boost::mutex> lock(mutex);
+                    while (queue.empty())
+                        cond.wait(lock); // interruption point
+                    job = std::move(queue.front());
+                    queue.pop_front();
+                }
+                bool valid{false};
+                try {
+                    valid = job.validate();
+                } catch (...) { }
+                complete(job.seq, valid, std::move(job.apply));
+            }
+        } catch (...) {
+            boost::unique_lock<boost::mutex> lock(mutex);
+            --nWorkers;
+            throw;
+        }
+    }
+
+    /**
+     * Number of validations that haven't been applied yet.
+     * @return
+     */
+    size_t pending() {
+        boost::unique_lock<boost::mutex> lock(mutex);
+        return nPending;
+    }
+
+    /**
+     * Returns true if no more validations can be queued until pending ones are applied.
+     * @return
+     */
+    bool full() {
+        boost::unique_lock<boost::mutex> lock(mutex);
+        return nPending >= maxPending;
+    }
+
+    /**
+     * Number of worker threads currently running.
+     * @return
+     */
+    int workers() {
+        boost::unique_lock<boost::mutex> lock(mutex);
+        return nWorkers;
+    }
+
+private:
+    struct Job {
+        uint64_t seq{0};
+        ValidateFunc validate;
+        ApplyFunc apply;
+    };
+
+    /**
+     * Stores the result and applies every result that is next in line. Workers take
+     * turns applying so that a result is never left waiting behind an applied one.
+     */
+    void complete(const uint64_t seq, const bool valid, ApplyFunc apply) {
+        {
+            boost::unique_lock<boost::mutex> lock(mutex);
+            done.emplace(seq, std::make_pair(valid, std::move(apply)));
+        }
+        boost::unique_lock<boost::mutex> applyLock(applyMutex);
+        while (true) {
+            std::pair<bool, ApplyFunc> result;
+            {
+                boost::unique_lock<boost::mutex> lock(mutex);
+                auto it = done.find(nextApply);
+                if (it == done.end())
+                    break;
+                result = std::move(it->second);
+                done.erase(it);
+                ++nextApply;
+            }
+            try {
+                result.second(result.first);
+            } catch (...) { }
+            boost::unique_lock<boost::mutex> lock(mutex);
+            --nPending;
+        }
+    }
+
+private:
+    //! Protects the queue state
+    boost::mutex mutex;
+    //! Serializes applying results
+    boost::mutex applyMutex;
+    //! Workers block on this when out of work
+    boost::condition_variable cond;
+    std::deque<Job> queue;
+    //! Validated packets waiting on earlier packets to be applied
+    std::map<uint64_t, std::pair<bool, ApplyFunc>> done;
+    uint64_t nextSeq{0};
+    uint64_t nextApply{0};
+    //! Pushed validations that haven't finished applying
+    size_t nPending{0};
+    int nWorkers{0};
+    const size_t maxPending;
+};
+
+}
+
+#endif //BLOCKNET_SERVICENODE_VALIDATIONQUEUE_H
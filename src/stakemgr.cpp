@@ -11,6 +11,7 @@
 #include <net.h>
 #include <shutdown.h>
 #include <timedata.h>
+#include <txmempool.h>
 #include <validation.h>
 
 std::unique_ptr<StakeMgr> g_staker;
@@ -46,6 +47,8 @@ void ThreadStakeMinter() {
                 LOCK(cs_main);
                 pindex = chainActive.Tip();
             }
+            if (hasPeers && pindex)
+                g_staker->UpdateStakeTemplate(pindex, chainparams); // keep the next block ready ahead of a kernel hit
             if (hasPeers && pindex && g_staker->Update(wallets, pindex, chainparams.GetConsensus(), stakingSkipPeers)) {
                 boost::this_thread::interruption_point();
                 g_staker->TryStake(pindex, chainparams);
@@ -196,22 +199,59 @@ bool StakeMgr::StakeBlock(const StakeCoin & stakeCoin, const CChainParams & chai
     }
     bool fNewBlock = false;
     try {
+        const int64_t nTimeStart = GetTimeMicros();
+        const auto preassembled = GetStakeTemplate();
         auto pblocktemplate = BlockAssembler(chainparams).CreateNewBlockPoS(*stakeCoin.coin, stakeCoin.hashBlock,
                                                                             stakeCoin.time, stakeCoin.blockTime,
-                                                                            stakeCoin.wallet.get());
+                                                                            stakeCoin.wallet.get(), false,
+                                                                            preassembled.get());
         if (!pblocktemplate)
             return false;
+        const int64_t nTimeAssembled = GetTimeMicros();
         auto pblock = std::make_shared<const CBlock>(pblocktemplate->block);
         if (!ProcessNewBlock(chainparams, pblock, /*fForceProcessing=*/true, &fNewBlock))
             return false;
+        const int64_t nTimeBroadcast = GetTimeMicros();
+        lastTimeToBroadcast = nTimeBroadcast - nTimeStart;
         LogPrintf("Stake found! %s %d %f\n", stakeCoin.coin->outpoint.hash.ToString(), stakeCoin.coin->outpoint.n,
                   (double)stakeCoin.coin->txout.nValue/(double)COIN);
+        LogPrint(BCLog::STAKE, "Staker: block %s assembled in %.2fms (%s), broadcast in %.2fms\n",
+                 pblock->GetHash().ToString(), 0.001 * (nTimeAssembled - nTimeStart),
+                 preassembled && preassembled->hashPrevBlock == pblock->hashPrevBlock ? "pre-assembled" : "no template",
+                 0.001 * (nTimeBroadcast - nTimeStart));
     } catch (std::exception & e) {
         LogPrintf("Error: Staking %s\n", e.what());
     }
     return fNewBlock;
 }
 
+bool StakeMgr::UpdateStakeTemplate(const CBlockIndex *tip, const CChainParams & chainparams) {
+    if (!tip)
+        return false;
+    auto current = GetStakeTemplate();
+    if (current && current->hashPrevBlock == tip->GetBlockHash()) {
+        if (current->nTransactionsUpdated == mempool.GetTransactionsUpdated())
+            return false; // nothing changed
+        if (GetTime() - current->nTimeCreated < STAKE_TEMPLATE_REFRESH)
+            return false; // avoid reselecting packages on every mempool change
+    }
+    std::shared_ptr<const CStakeTemplate> next = BlockAssembler(chainparams).CreateStakeTemplate();
+    if (!next)
+        return false;
+    LOCK(mu);
+    stakeTemplate = next;
+    return true;
+}
+
+std::shared_ptr<const CStakeTemplate> StakeMgr::GetStakeTemplate() {
+    LOCK(mu);
+    return stakeTemplate;
+}
+
+int64_t StakeMgr::LastTimeToBroadcast() const {
+    return lastTimeToBroadcast;
+}
+
 int64_t StakeMgr::LastUpdateTime() const {
     return lastUpdateTime;
 }
@@ -347,7 +387,9 @@ void StakeMgr::Reset() {
         LOCK(mu);
         stakeTimes.clear();
         stakeModifiers.clear();
+        stakeTemplate.reset();
     }
     lastUpdateTime = 0;
+    lastTimeToBroadcast = 0;
     lastBlockHeight = 0;
 }
\ No newline at end of file
@@ -9,12 +9,16 @@
 #include <chainparams.h>
 #include <consensus/params.h>
 #include <keystore.h>
+#include <miner.h>
 #include <wallet/coinselection.h>
 #include <wallet/wallet.h>
 
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include <boost/thread.hpp>
 
+/** Seconds a pre-assembled stake template is reused while the mempool keeps changing */
+static const int64_t STAKE_TEMPLATE_REFRESH = 5;
+
 class StakeMgr {
 public:
     struct StakeCoin {
@@ -81,8 +85,11 @@ public:
     bool TryStake(const CBlockIndex *tip, const CChainParams & chainparams);
     bool NextStake(std::vector<StakeCoin> & nextStakes, const CBlockIndex *tip, const CChainParams & chainparams);
     bool StakeBlock(const StakeCoin & stakeCoin, const CChainParams & chainparams);
+    bool UpdateStakeTemplate(const CBlockIndex *tip, const CChainParams & chainparams);
+    std::shared_ptr<const CStakeTemplate> GetStakeTemplate();
     int64_t LastUpdateTime() const;
     int LastBlockHeight() const;
+    int64_t LastTimeToBroadcast() const;
     const StakeCoin & GetStake();
     bool SuitableCoin(const COutput & coin, const int & tipHeight, const Consensus::Params & params) const;
     std::vector<COutput> StakeOutputs(CWallet *wallet, const CAmount & minStakeAmount) const;
@@ -109,8 +116,10 @@ private:
     Mutex mu;
     std::map<int64_t, std::vector<StakeCoin>> stakeTimes;
     std::map<uint256, uint64_t> stakeModifiers;
+    std::shared_ptr<const CStakeTemplate> stakeTemplate;
     std::atomic<int64_t> lastUpdateTime{0};
     std::atomic<int> lastBlockHeight{0};
+    std::atomic<int64_t> lastTimeToBroadcast{0}; // microseconds from kernel hit to block relay
 };
 
 extern void ThreadStakeMinter();
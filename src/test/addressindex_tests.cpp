@@ -0,0 +1,121 @@
+// Copyright (c) 2020 The Blocknet developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <chainparams.h>
+#include <consensus/validation.h>
+#include <index/addressindex.h>
+#include <script/standard.h>
+#include <test/test_bitcoin.h>
+#include <util/time.h>
+#include <validation.h>
+#include <validationinterface.h>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(addressindex_tests)
+
+static void WaitForIndex(AddressIndex& index)
+{
+    SyncWithValidationInterfaceQueue();
+    constexpr int64_t timeout_ms = 10 * 1000;
+    int64_t time_start = GetTimeMillis();
+    while (!index.BlockUntilSyncedToCurrentChain()) {
+        BOOST_REQUIRE(time_start + timeout_ms > GetTimeMillis());
+        MilliSleep(100);
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(addressindex_sync_spend_reorg, TestChain100Setup)
+{
+    AddressIndex address_index(1 << 20, true);
+    const CScript coinbase_script = CScript() << ToByteVector(coinbaseKey.GetPubKey()) << OP_CHECKSIG;
+
+    CKey key;
+    key.MakeNewKey(true);
+    const CScript dest_script = GetScriptForDestination(key.GetPubKey().GetID());
+
+    RegisterValidationInterface(&address_index);
+    address_index.Start();
+    WaitForIndex(address_index);
+
+    // Every coinbase created by the fixture pays to the coinbase key
+    std::vector<AddressUnspent> unspent;
+    BOOST_CHECK(address_index.FindUnspent(coinbase_script, unspent));
+    BOOST_CHECK_EQUAL(unspent.size(), m_coinbase_txns.size());
+    CAmount expected{0};
+    for (const auto& tx : m_coinbase_txns)
+        expected += tx->GetValueOut();
+    CAmount balance{0}, received{0};
+    BOOST_CHECK(address_index.GetBalance(coinbase_script, balance, received));
+    BOOST_CHECK_EQUAL(balance, expected);
+    BOOST_CHECK_EQUAL(received, expected);
+
+    std::vector<AddressDelta> deltas;
+    BOOST_CHECK(address_index.FindDeltas(coinbase_script, 1, 10, deltas));
+    BOOST_CHECK_EQUAL(deltas.size(), 10U);
+    BOOST_CHECK_EQUAL(deltas.front().height, 1);
+    BOOST_CHECK_EQUAL(deltas.back().height, 10);
+
+    // Spend the first coinbase to another address
+    const CTransactionRef& prev = m_coinbase_txns[0];
+    CMutableTransaction spend;
+    spend.vin.resize(1);
+    spend.vin[0].prevout = COutPoint(prev->GetHash(), 0);
+    spend.vout.resize(1);
+    spend.vout[0].nValue = prev->vout[0].nValue - CENT;
+    spend.vout[0].scriptPubKey = dest_script;
+    std::vector<unsigned char> vchSig;
+    const uint256 hash = SignatureHash(coinbase_script, spend, 0, SIGHASH_ALL, 0, SigVersion::BASE);
+    BOOST_CHECK(coinbaseKey.Sign(hash, vchSig));
+    vchSig.push_back((unsigned char)SIGHASH_ALL);
+    spend.vin[0].scriptSig << vchSig;
+
+    const CBlock block = CreateAndProcessBlock({spend}, GetScriptForDestination(CKeyID()));
+    WaitForIndex(address_index);
+
+    BOOST_CHECK(address_index.GetBalance(dest_script, balance, received));
+    BOOST_CHECK_EQUAL(balance, spend.vout[0].nValue);
+    BOOST_CHECK(address_index.GetBalance(coinbase_script, balance, received));
+    BOOST_CHECK_EQUAL(balance, expected - prev->vout[0].nValue);
+    BOOST_CHECK_EQUAL(received, expected);
+
+    deltas.clear();
+    BOOST_CHECK(address_index.FindDeltas(coinbase_script, 0, 0, deltas));
+    BOOST_CHECK(deltas.back().spending);
+    BOOST_CHECK_EQUAL(deltas.back().txid, spend.GetHash());
+    BOOST_CHECK_EQUAL(deltas.back().amount, -prev->vout[0].nValue);
+
+    // Disconnect the spend, the next block rewinds the index
+    {
+        CValidationState state;
+        CBlockIndex* pindex;
+        {
+            LOCK(cs_main);
+            pindex = LookupBlockIndex(block.GetHash());
+        }
+        BOOST_CHECK(InvalidateBlock(state, Params(), pindex));
+    }
+    CreateAndProcessBlock({}, GetScriptForDestination(CKeyID()));
+    WaitForIndex(address_index);
+
+    BOOST_CHECK(address_index.GetBalance(dest_script, balance, received));
+    BOOST_CHECK_EQUAL(balance, 0);
+    BOOST_CHECK_EQUAL(received, 0);
+    BOOST_CHECK(address_index.GetBalance(coinbase_script, balance, received));
+    BOOST_CHECK_EQUAL(balance, expected);
+    unspent.clear();
+    BOOST_CHECK(address_index.FindUnspent(coinbase_script, unspent));
+    BOOST_CHECK_EQUAL(unspent.size(), m_coinbase_txns.size());
+
+    // shutdown sequence (c.f. Shutdown() in init.cpp)
+    UnregisterValidationInterface(&address_index);
+    address_index.Stop();
+
+    threadGroup.interrupt_all();
+    threadGroup.join_all();
+
+    // Rest of shutdown sequence and destructors happen in ~TestingSetup()
+}
+
+BOOST_AUTO_TEST_SUITE_END()
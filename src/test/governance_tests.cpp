@@ -873,6 +873,130 @@ BOOST_FIXTURE_TEST_CASE(governance_tests_votes_undo, TestChainPoS)
     ReloadWallet();
 }
 
+BOOST_FIXTURE_TEST_CASE(governance_tests_generations, TestChainPoS)
+{
+    gArgs.ForceSetArg("-maxtxfee", "500000000");
+    RegisterValidationInterface(&gov::Governance::instance());
+
+    auto *params = (CChainParams*)&Params();
+    params->consensus.voteMinUtxoAmount = 20*COIN;
+    params->consensus.voteBalance = 200*COIN;
+    const auto & consensus = params->GetConsensus();
+    CTxDestination dest(coinbaseKey.GetPubKey().GetID());
+    std::vector<COutput> coins;
+    {
+        LOCK2(cs_main, wallet->cs_wallet);
+        wallet->AvailableCoins(*locked_chain, coins);
+    }
+    BOOST_CHECK_MESSAGE(!coins.empty(), "Vote tests require available coins");
+
+    // Check normal proposal
+    gov::Proposal proposal("Test proposal", nextSuperblock(chainActive.Height(), consensus.superblock), 3000*COIN,
+                     EncodeDestination(dest), "https://forum.blocknet.org", "Short description");
+    BOOST_CHECK_MESSAGE(proposal.isValid(consensus), "Basic proposal should be valid");
+
+    // Vote, spend and undo changes must bump the generations and notify listeners
+    {
+        const auto resetBlocks = chainActive.Height();
+        CKey key; key.MakeNewKey(true);
+        const auto & newDest = GetDestinationForKey(key.GetPubKey(), OutputType::LEGACY);
+        // Voting wallet
+        bool firstRun;
+        auto otherwallet = std::make_shared<CWallet>(*chain, WalletLocation(), WalletDatabase::CreateMock());
+        otherwallet->LoadWallet(firstRun);
+        AddKey(*otherwallet, key);
+        otherwallet->SetBroadcastTransactions(true);
+        rescanWallet(otherwallet.get());
+        RegisterValidationInterface(otherwallet.get());
+        // Vote inputs
+        {
+            CTransactionRef tx;
+            CTransactionRef txVoteInput;
+            bool sent = sendToAddress(wallet.get(), newDest, 200 * COIN, tx)
+                     && sendToAddress(wallet.get(), newDest, 3 * COIN, txVoteInput);
+            BOOST_CHECK_MESSAGE(sent, "Send to another address failed");
+        }
+        // Create proposal
+        {
+            CTransactionRef ptx; // proposal tx
+            std::string failReason;
+            gov::SubmitProposal(proposal, {wallet}, consensus, ptx, g_connman.get(), &failReason);
+            StakeBlocks(1), SyncWithValidationInterfaceQueue();
+        }
+        // Track change notifications
+        int votesAdded{0}, votesSpent{0}, votesUnspent{0}, superblockChanges{0};
+        auto c1 = gov::Governance::instance().NotifyVoteAdded.connect([&votesAdded](const gov::Vote &) { ++votesAdded; });
+        auto c2 = gov::Governance::instance().NotifyVoteSpent.connect([&votesSpent](const gov::Vote &) { ++votesSpent; });
+        auto c3 = gov::Governance::instance().NotifyVoteUnspent.connect([&votesUnspent](const gov::Vote &) { ++votesUnspent; });
+        auto c4 = gov::Governance::instance().NotifySuperblockChanged.connect([&superblockChanges,&proposal](int superblock, uint64_t) {
+            if (superblock == proposal.getSuperblock())
+                ++superblockChanges;
+        });
+        auto generation = gov::Governance::instance().getGeneration();
+        auto sbgeneration = gov::Governance::instance().getGeneration(proposal.getSuperblock());
+        BOOST_CHECK_MESSAGE(sbgeneration > 0, "Expecting the proposal to change the superblock generation");
+        // 1) Vote on a proposal
+        {
+            gov::ProposalVote proposalVote{proposal, gov::YES};
+            std::vector<CTransactionRef> txs;
+            std::string failReason;
+            bool success = gov::SubmitVotes(std::vector<gov::ProposalVote>{proposalVote}, {otherwallet}, consensus, txs, g_connman.get(), &failReason);
+            BOOST_REQUIRE_MESSAGE(success, strprintf("Submit votes failed: %s", failReason));
+            StakeBlocks(1), SyncWithValidationInterfaceQueue();
+            auto vs = gov::Governance::instance().getVotes(proposal.getHash());
+            BOOST_CHECK_MESSAGE(vs.size() == 1, strprintf("Expecting 1 vote, found %u", vs.size()));
+            BOOST_CHECK_EQUAL(votesAdded, 1);
+            BOOST_CHECK(superblockChanges >= 1);
+            BOOST_CHECK(gov::Governance::instance().getGeneration() > generation);
+            BOOST_CHECK(gov::Governance::instance().getGeneration(proposal.getSuperblock()) > sbgeneration);
+        }
+        // 2) Spend vote
+        {
+            CTransactionRef tx;
+            bool sent = sendToAddress(otherwallet.get(), newDest, otherwallet->GetBalance()-COIN, tx);
+            BOOST_CHECK_MESSAGE(sent, "Spending vote utxos failed");
+            StakeBlocks(1), SyncWithValidationInterfaceQueue();
+            auto vs = gov::Governance::instance().getVotes(proposal.getHash());
+            BOOST_CHECK_MESSAGE(vs.empty(), strprintf("Expecting 0 votes, found %u", vs.size()));
+            auto pvs = gov::Governance::instance().getVotes(proposal.getHash(), true);
+            BOOST_CHECK_MESSAGE(pvs.size() == 1 && pvs[0].spent(), "Expecting 1 spent vote");
+            BOOST_CHECK_EQUAL(votesSpent, 1);
+            BOOST_CHECK(superblockChanges >= 2);
+        }
+        // 3) Simulate block invalidation/disconnect and make sure votes are properly unspent
+        {
+            CValidationState state;
+            BOOST_CHECK_MESSAGE(InvalidateBlock(state, *params, chainActive.Tip(), false), "Failed to invalidate the block with spent vote");
+            ActivateBestChain(state, *params); SyncWithValidationInterfaceQueue();
+            auto vs = gov::Governance::instance().getVotes(proposal.getHash());
+            BOOST_CHECK_MESSAGE(vs.size() == 1, strprintf("Expecting 1 vote, found %u", vs.size()));
+            auto pvs = gov::Governance::instance().getVotes(proposal.getHash());
+            BOOST_CHECK_MESSAGE(pvs.size() == 1 && !pvs[0].spent(), "Expecting 1 unspent vote");
+            BOOST_CHECK_EQUAL(votesUnspent, 1);
+        }
+        // 4) Check vote is valid after new block
+        {
+            generation = gov::Governance::instance().getGeneration();
+            StakeBlocks(1), SyncWithValidationInterfaceQueue();
+            auto vs = gov::Governance::instance().getVotes(proposal.getHash());
+            BOOST_CHECK_MESSAGE(vs.size() == 1, strprintf("Expecting 1 vote, found %u", vs.size()));
+            auto pvs = gov::Governance::instance().getVotes(proposal.getHash());
+            BOOST_CHECK_MESSAGE(pvs.size() == 1 && !pvs[0].spent(), "Expecting 1 unspent vote");
+            BOOST_CHECK_MESSAGE(gov::Governance::instance().getGeneration() == generation, "Blocks without governance changes should not change the generation");
+        }
+        c1.disconnect(); c2.disconnect(); c3.disconnect(); c4.disconnect();
+        // Clean up
+        UnregisterValidationInterface(otherwallet.get());
+        otherwallet.reset();
+        cleanup(resetBlocks, wallet.get());
+        ReloadWallet();
+    }
+
+    UnregisterValidationInterface(&gov::Governance::instance());
+    cleanup(chainActive.Height(), wallet.get());
+    ReloadWallet();
+}
+
 BOOST_FIXTURE_TEST_CASE(governance_tests_votes_changescutoff, TestChainPoS)
 {
     gArgs.ForceSetArg("-maxtxfee", "500000000");
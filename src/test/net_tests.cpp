@@ -10,6 +10,7 @@
 #include <streams.h>
 #include <net.h>
 #include <netbase.h>
+#include <netmessagemaker.h>
 #include <chainparams.h>
 #include <util/system.h>
 
@@ -63,6 +64,51 @@ public:
     }
 };
 
+#ifdef USE_EPOLL
+struct CConnmanSocketTest : public CConnman {
+    using CConnman::CConnman;
+    bool StartEpoll()
+    {
+        return InitEpoll();
+    }
+    void AddNode(CNode* pnode)
+    {
+        AddConnectedNode(pnode);
+    }
+    void HandleSockets()
+    {
+        SocketHandler();
+    }
+    bool EventsPending() const
+    {
+        return fSocketEventsPending;
+    }
+    void ClearNodes()
+    {
+        LOCK(cs_vNodes);
+        for (CNode* node : vNodes) {
+            delete node;
+        }
+        vNodes.clear();
+    }
+};
+
+static size_t ProcessQueueCount(CNode* pnode)
+{
+    LOCK(pnode->cs_vProcessMsg);
+    size_t count = 0;
+    for (const auto& queue : pnode->vProcessMsg)
+        count += queue.size();
+    return count;
+}
+
+static bool HasSendData(CNode* pnode)
+{
+    LOCK(pnode->cs_vSend);
+    return !pnode->vSendMsg.empty();
+}
+#endif
+
 static CDataStream AddrmanToStream(CAddrManSerializationMock& _addrman)
 {
     CDataStream ssPeersIn(SER_DISK, CLIENT_VERSION);
@@ -303,4 +349,217 @@ BOOST_AUTO_TEST_CASE(LocalAddress_BasicLifecycle)
 }
 
 
+BOOST_AUTO_TEST_CASE(socket_events_mode)
+{
+    SocketEventsMode mode;
+    BOOST_CHECK(ParseSocketEventsMode("select", mode));
+    BOOST_CHECK_EQUAL(mode, SOCKETEVENTS_SELECT);
+    BOOST_CHECK(!ParseSocketEventsMode("kqueue", mode));
+    BOOST_CHECK(ParseSocketEventsMode(DEFAULT_SOCKETEVENTS, mode));
+    BOOST_CHECK_EQUAL(SocketEventsModeToString(mode), DEFAULT_SOCKETEVENTS);
+#ifdef USE_EPOLL
+    BOOST_CHECK(ParseSocketEventsMode("epoll", mode));
+    BOOST_CHECK_EQUAL(mode, SOCKETEVENTS_EPOLL);
+    BOOST_CHECK(GetSupportedSocketEventsModes().find("epoll") != std::string::npos);
+#endif
+}
+
+#ifdef USE_EPOLL
+BOOST_AUTO_TEST_CASE(socket_events_epoll_handler)
+{
+    // Drives SocketHandler over a socket pair in epoll mode. Readiness is
+    // edge-triggered, so the node has to remember what it hasn't consumed.
+    CConnmanSocketTest connman(0x1337, 0x1337);
+    CConnman::Options options;
+    options.nReceiveFloodSize = 1; // pause receiving after every message
+    options.socketEventsMode = SOCKETEVENTS_EPOLL;
+    connman.Init(options);
+    BOOST_REQUIRE(connman.StartEpoll());
+
+    int fds[2];
+    BOOST_REQUIRE_EQUAL(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+    SOCKET hPeer = fds[1];
+    CNode* pnode = new CNode(0, NODE_NETWORK, 0, fds[0], CAddress(), 0, 0, CAddress(), "", /*fInboundIn=*/ true);
+    connman.AddNode(pnode);
+
+    const CSharedNetMsg ping = connman.MakeSharedMessage(CNetMsgMaker(INIT_PROTO_VERSION).Make(NetMsgType::PING, (uint64_t)1));
+    const auto& pingData = *ping.data;
+
+    // Short read: the message is smaller than the receive buffer, so the socket is drained
+    BOOST_REQUIRE_EQUAL(send(hPeer, pingData.data(), pingData.size(), MSG_NOSIGNAL), (ssize_t)pingData.size());
+    connman.HandleSockets();
+    BOOST_CHECK_EQUAL(ProcessQueueCount(pnode), 1U);
+    BOOST_CHECK(!pnode->fRecvReady);
+    BOOST_CHECK(pnode->fPauseRecv);
+
+    // Receiving is paused: the edge of the next message is remembered without reading it
+    BOOST_REQUIRE_EQUAL(send(hPeer, pingData.data(), pingData.size(), MSG_NOSIGNAL), (ssize_t)pingData.size());
+    connman.HandleSockets();
+    BOOST_CHECK_EQUAL(ProcessQueueCount(pnode), 1U);
+    BOOST_CHECK(pnode->fRecvReady);
+    BOOST_CHECK(!connman.EventsPending()); // no busy loop while paused
+
+    // Resumed: epoll doesn't report the socket again, the remembered readiness is used
+    {
+        LOCK(pnode->cs_vProcessMsg);
+        for (auto& queue : pnode->vProcessMsg)
+            queue.clear();
+        pnode->nProcessQueueSize = 0;
+        pnode->fPauseRecv = false;
+    }
+    connman.HandleSockets();
+    BOOST_CHECK_EQUAL(ProcessQueueCount(pnode), 1U);
+    BOOST_CHECK(!pnode->fRecvReady);
+
+    // Partial send: the message doesn't fit the socket buffer and the rest waits for
+    // the peer to read, which triggers a new edge
+    CSerializedNetMsg msg = CNetMsgMaker(INIT_PROTO_VERSION).Make("test", std::vector<unsigned char>(1 << 22));
+    const size_t total = CMessageHeader::HEADER_SIZE + msg.data.size();
+    connman.PushMessage(pnode, std::move(msg));
+    BOOST_REQUIRE(HasSendData(pnode));
+    connman.HandleSockets();
+    BOOST_CHECK(HasSendData(pnode));
+    BOOST_CHECK(!pnode->fSendReady);
+    BOOST_CHECK(!connman.EventsPending());
+
+    std::vector<char> buf(0x10000);
+    size_t received = 0;
+    for (int i = 0; i < 1000 && received < total; ++i) {
+        ssize_t nBytes;
+        while ((nBytes = recv(hPeer, buf.data(), buf.size(), MSG_DONTWAIT)) > 0)
+            received += nBytes;
+        connman.HandleSockets();
+    }
+    BOOST_CHECK_EQUAL(received, total);
+    BOOST_CHECK(!HasSendData(pnode));
+
+    connman.ClearNodes();
+    CloseSocket(hPeer);
+}
+#endif
+
+static void QueueMessage(CNode& node, const char* command)
+{
+    CNetMessage msg(Params().MessageStart(), SER_NETWORK, INIT_PROTO_VERSION);
+    msg.hdr = CMessageHeader(Params().MessageStart(), command, 0);
+    msg.nTime = GetTimeMicros();
+    const MessageClass msgClass = GetMessageClass(command);
+    LOCK(node.cs_vProcessMsg);
+    node.vProcessMsg[msgClass].push_back(std::move(msg));
+    node.nProcessQueueSize += CMessageHeader::HEADER_SIZE;
+    node.nProcessQueueClassSize[msgClass] += CMessageHeader::HEADER_SIZE;
+}
+
+BOOST_AUTO_TEST_CASE(message_class_priority)
+{
+    BOOST_CHECK_EQUAL(GetMessageClass(NetMsgType::CMPCTBLOCK), MSG_CLASS_BLOCK);
+    BOOST_CHECK_EQUAL(GetMessageClass(NetMsgType::HEADERS), MSG_CLASS_BLOCK);
+    BOOST_CHECK_EQUAL(GetMessageClass(NetMsgType::TX), MSG_CLASS_DEFAULT);
+    BOOST_CHECK_EQUAL(GetMessageClass(NetMsgType::XBRIDGE), MSG_CLASS_OVERLAY);
+    BOOST_CHECK_EQUAL(GetMessageClass(NetMsgType::SNPING), MSG_CLASS_OVERLAY);
+
+    CConnman connman(0x1337, 0x1337);
+    in_addr ipv4Addr;
+    ipv4Addr.s_addr = 0xa0b0c001;
+    CAddress addr(CService(ipv4Addr, 7777), NODE_NETWORK);
+    CNode node(0, NODE_NETWORK, 0, INVALID_SOCKET, addr, 0, 0, CAddress(), "", false);
+
+    // A block queued behind a burst of overlay and default traffic is processed first,
+    // overlay messages still get a turn after every MSG_CLASS_DEFAULT_WEIGHT default ones
+    for (int i = 0; i < 10; ++i)
+        QueueMessage(node, NetMsgType::XBRIDGE);
+    for (int i = 0; i < 10; ++i)
+        QueueMessage(node, NetMsgType::TX);
+    QueueMessage(node, NetMsgType::CMPCTBLOCK);
+
+    std::vector<std::string> order;
+    std::list<CNetMessage> msgs;
+    bool fMoreWork = false;
+    while (connman.PollMessage(&node, msgs, fMoreWork)) {
+        order.push_back(msgs.front().hdr.GetCommand());
+        msgs.clear();
+    }
+    BOOST_CHECK(!fMoreWork);
+    BOOST_REQUIRE_EQUAL(order.size(), 21U);
+    BOOST_CHECK_EQUAL(order[0], NetMsgType::CMPCTBLOCK);
+    for (unsigned int i = 1; i <= MSG_CLASS_DEFAULT_WEIGHT; ++i)
+        BOOST_CHECK_EQUAL(order[i], NetMsgType::TX);
+    BOOST_CHECK_EQUAL(order[MSG_CLASS_DEFAULT_WEIGHT + 1], NetMsgType::XBRIDGE);
+    {
+        LOCK(node.cs_vProcessMsg);
+        BOOST_CHECK_EQUAL(node.nProcessQueueSize, 0U);
+    }
+
+    const auto stats = connman.GetMessageClassStats();
+    BOOST_CHECK_EQUAL(stats[MSG_CLASS_BLOCK].nProcessed, 1U);
+    BOOST_CHECK_EQUAL(stats[MSG_CLASS_DEFAULT].nProcessed, 10U);
+    BOOST_CHECK_EQUAL(stats[MSG_CLASS_OVERLAY].nProcessed, 10U);
+}
+
+BOOST_AUTO_TEST_CASE(message_processing_stats)
+{
+    CConnman connman(0x1337, 0x1337);
+    in_addr ipv4Addr;
+    ipv4Addr.s_addr = 0xa0b0c001;
+    CAddress addr(CService(ipv4Addr, 7777), NODE_NETWORK);
+    CNode node1(0, NODE_NETWORK, 0, INVALID_SOCKET, addr, 0, 0, CAddress(), "", false);
+    CNode node2(1, NODE_NETWORK, 0, INVALID_SOCKET, addr, 1, 1, CAddress(), "", false);
+
+    connman.RecordProcessedMessage(&node1, NetMsgType::XBRIDGE, 100, 30, false);
+    connman.RecordProcessedMessage(&node1, NetMsgType::XBRIDGE, 200, 10, true);
+    connman.RecordProcessedMessage(&node2, NetMsgType::XBRIDGE, 50, 20, false);
+    connman.RecordProcessedMessage(&node2, "unknowncmd", 40, 5, true);
+
+    const mapMsgCmdStats total = connman.GetMessageStats();
+    BOOST_REQUIRE_EQUAL(total.count(NetMsgType::XBRIDGE), 1U);
+    const CMsgCmdStats& xbridge = total.at(NetMsgType::XBRIDGE);
+    BOOST_CHECK_EQUAL(xbridge.nCount, 3U);
+    BOOST_CHECK_EQUAL(xbridge.nBytes, 350U);
+    BOOST_CHECK_EQUAL(xbridge.nTimeTotal, 60U);
+    BOOST_CHECK_EQUAL(xbridge.nTimeMax, 30U);
+    BOOST_CHECK_EQUAL(xbridge.nDropped, 1U);
+    // Unknown commands are accounted together
+    BOOST_CHECK_EQUAL(total.count("unknowncmd"), 0U);
+    BOOST_CHECK_EQUAL(total.at(NET_MESSAGE_COMMAND_OTHER).nDropped, 1U);
+
+    CNodeStats stats;
+    node1.copyStats(stats);
+    BOOST_CHECK_EQUAL(stats.mapProcessStatsPerMsgCmd.size(), 1U);
+    BOOST_CHECK_EQUAL(stats.mapProcessStatsPerMsgCmd[NetMsgType::XBRIDGE].nCount, 2U);
+    BOOST_CHECK_EQUAL(stats.mapProcessStatsPerMsgCmd[NetMsgType::XBRIDGE].nBytes, 300U);
+}
+
+BOOST_AUTO_TEST_CASE(shared_message_buffer)
+{
+    CConnman connman(0x1337, 0x1337);
+    in_addr ipv4Addr;
+    ipv4Addr.s_addr = 0xa0b0c001;
+    CAddress addr(CService(ipv4Addr, 7777), NODE_NETWORK);
+    CNode node1(0, NODE_NETWORK, 0, INVALID_SOCKET, addr, 0, 0, CAddress(), "", false);
+    CNode node2(1, NODE_NETWORK, 0, INVALID_SOCKET, addr, 1, 1, CAddress(), "", false);
+
+    const std::vector<unsigned char> payload(1000, 0x42);
+    const CNetMsgMaker msgMaker(PROTOCOL_VERSION);
+    const CSharedNetMsg shared = connman.MakeSharedMessage(msgMaker.Make(NetMsgType::XBRIDGE, payload));
+    connman.PushMessage(&node1, shared);
+    connman.PushMessage(&node2, shared);
+
+    // Both peers queue the same buffer, which matches what PushMessage sends for the message
+    CNode node3(2, NODE_NETWORK, 0, INVALID_SOCKET, addr, 2, 2, CAddress(), "", false);
+    connman.PushMessage(&node3, msgMaker.Make(NetMsgType::XBRIDGE, payload));
+    std::vector<unsigned char> expected;
+    {
+        LOCK(node3.cs_vSend);
+        for (const auto& buffer : node3.vSendMsg)
+            expected.insert(expected.end(), buffer.data(), buffer.data() + buffer.size());
+    }
+    LOCK2(node1.cs_vSend, node2.cs_vSend);
+    BOOST_REQUIRE_EQUAL(node1.vSendMsg.size(), 1U);
+    BOOST_REQUIRE_EQUAL(node2.vSendMsg.size(), 1U);
+    BOOST_CHECK(node1.vSendMsg.front().data() == node2.vSendMsg.front().data());
+    BOOST_CHECK_EQUAL(node1.nSendSize, expected.size());
+    const CNetSendBuffer& buffer = node1.vSendMsg.front();
+    BOOST_CHECK(std::vector<unsigned char>(buffer.data(), buffer.data() + buffer.size()) == expected);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
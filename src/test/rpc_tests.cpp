@@ -420,4 +420,77 @@ BOOST_AUTO_TEST_CASE(rpc_getblockstats_calculate_percentiles_by_weight)
     }
 }
 
+/** Collects the streamed elements, refuses more than limit */
+class TestRPCStream : public JSONRPCStream
+{
+public:
+    explicit TestRPCStream(size_t limit) : limit(limit) {}
+    bool Push(UniValue::VType type, const std::string* key, const UniValue& val) override
+    {
+        if (elements.size() >= limit)
+            return false;
+        elements.push_back((key ? *key + "=" : "") + val.write());
+        return true;
+    }
+    size_t limit;
+    std::vector<std::string> elements;
+};
+
+BOOST_AUTO_TEST_CASE(rpc_result_writer)
+{
+    // Without a stream the result is collected
+    JSONRPCResultWriter arr(nullptr, UniValue::VARR);
+    arr.push_back(1);
+    arr.push_back("a");
+    BOOST_CHECK_EQUAL(arr.Finish().write(), "[1,\"a\"]");
+
+    JSONRPCResultWriter obj(nullptr, UniValue::VOBJ);
+    obj.pushKV("x", 1);
+    BOOST_CHECK_EQUAL(obj.Finish().write(), "{\"x\":1}");
+
+    // With a stream the elements are handed over and nothing is kept
+    TestRPCStream stream(2);
+    JSONRPCRequest request;
+    request.stream = &stream;
+    JSONRPCResultWriter streamed(request, UniValue::VOBJ);
+    streamed.pushKV("x", 1);
+    streamed.pushKV("y", "b");
+    BOOST_CHECK_THROW(streamed.pushKV("z", 2), UniValue);
+    BOOST_CHECK(streamed.Finish().empty());
+    BOOST_CHECK_EQUAL(stream.elements.size(), 2U);
+    BOOST_CHECK_EQUAL(stream.elements[0], "x=1");
+    BOOST_CHECK_EQUAL(stream.elements[1], "y=\"b\"");
+}
+
+/** Calls are only timed when they go through the dispatcher, which needs RPC warmup to be
+ *  finished. Warmup is global and stays finished, the other tests call the actors directly. */
+struct RPCDispatchSetup : public TestingSetup {
+    RPCDispatchSetup()
+    {
+        if (RPCIsInWarmup(nullptr))
+            SetRPCWarmupFinished();
+    }
+};
+
+BOOST_FIXTURE_TEST_CASE(rpc_getrpcinfo_histograms, RPCDispatchSetup)
+{
+    JSONRPCRequest request;
+    request.strMethod = "uptime";
+    request.params = UniValue(UniValue::VARR);
+    request.received = GetTimeMicros() - 2000;
+    BOOST_CHECK_NO_THROW(tableRPC.execute(request));
+
+    const UniValue info = CallRPC("getrpcinfo");
+    const UniValue& bounds = find_value(info, "histogram_bounds");
+    const UniValue& uptime = find_value(find_value(info, "methods"), "uptime");
+    BOOST_REQUIRE(uptime.isObject());
+    for (const std::string key : {"queue", "exec"}) {
+        const UniValue& stats = find_value(uptime, key);
+        BOOST_CHECK(find_value(stats, "count").get_int64() >= 1);
+        BOOST_CHECK_EQUAL(find_value(stats, "histogram").size(), bounds.size() + 1);
+    }
+    // The call waited at least 2ms after it was received
+    BOOST_CHECK(find_value(find_value(uptime, "queue"), "max").get_int64() >= 2000);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
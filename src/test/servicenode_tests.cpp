@@ -1728,4 +1728,91 @@ BOOST_AUTO_TEST_CASE(servicenode_tests_rpc)
     pos_ptr.reset();
 }
 
+/// Seen packets are remembered in a fixed size rolling filter
+BOOST_AUTO_TEST_CASE(servicenode_tests_seenpackets)
+{
+    auto & smgr = sn::ServiceNodeMgr::instance();
+    smgr.reset();
+    const auto memoryUsage = smgr.seenPacketStats().memoryUsage;
+    BOOST_CHECK(memoryUsage > 0);
+
+    const std::vector<unsigned char> packet{0x01, 0x02, 0x03};
+    BOOST_CHECK(!smgr.seenPacket(packet));
+    BOOST_CHECK(smgr.seenPacket(packet));
+
+    // Insert well past the filter capacity, memory stays fixed and recent packets are still seen
+    const int count = sn::SEEN_PACKETS_FILTER_SIZE * 2;
+    for (int i = 0; i < count; ++i)
+        smgr.seenPacket(ArithToUint256(arith_uint256(i + 1)));
+    BOOST_CHECK(smgr.seenPacket(ArithToUint256(arith_uint256(count))));
+    const auto stats = smgr.seenPacketStats();
+    BOOST_CHECK_EQUAL(stats.memoryUsage, memoryUsage);
+    BOOST_CHECK_EQUAL(stats.inserted + stats.duplicates, static_cast<uint64_t>(count + 3));
+    BOOST_CHECK(stats.duplicates >= 2);
+
+    cleanupSn();
+}
+
+/// Snode packets are validated in parallel and applied in the order they were queued
+BOOST_AUTO_TEST_CASE(servicenode_tests_validationqueue)
+{
+    sn::ValidationQueue queue(1000);
+    // Without workers the caller validates synchronously
+    BOOST_CHECK_EQUAL(queue.push([]() { return true; }, [](bool) {}), sn::ValidationQueue::NO_WORKERS);
+
+    boost::thread_group workers;
+    for (int i = 0; i < 4; ++i)
+        workers.create_thread([&queue]() { queue.loop(); });
+    while (queue.workers() < 4)
+        MilliSleep(1);
+
+    const int count{200};
+    std::vector<std::pair<int, bool>> applied; // only touched by the applying worker
+    std::atomic<int> validated{0};
+    for (int i = 0; i < count; ++i) {
+        BOOST_CHECK_EQUAL(queue.push([i,&validated]() {
+            MilliSleep(GetRand(3)); // finish out of order
+            ++validated;
+            return i % 2 == 0;
+        }, [i,&applied](const bool valid) {
+            applied.emplace_back(i, valid);
+        }), sn::ValidationQueue::QUEUED);
+    }
+    while (queue.pending() > 0)
+        MilliSleep(1);
+
+    BOOST_CHECK_EQUAL(validated, count);
+    BOOST_CHECK_EQUAL(applied.size(), count);
+    for (int i = 0; i < static_cast<int>(applied.size()); ++i) {
+        BOOST_CHECK_EQUAL(applied[i].first, i);
+        BOOST_CHECK_EQUAL(applied[i].second, i % 2 == 0);
+    }
+
+    // A full queue turns packets away instead of applying them ahead of queued ones
+    sn::ValidationQueue small(2);
+    std::atomic<bool> release{false};
+    std::vector<int> order; // only touched by the applying worker
+    workers.create_thread([&small]() { small.loop(); });
+    while (small.workers() < 1)
+        MilliSleep(1);
+    BOOST_CHECK_EQUAL(small.push([&release]() {
+        while (!release)
+            MilliSleep(1);
+        return true;
+    }, [&order](bool) { order.push_back(0); }), sn::ValidationQueue::QUEUED);
+    BOOST_CHECK_EQUAL(small.push([]() { return true; }, [&order](bool) { order.push_back(1); }), sn::ValidationQueue::QUEUED);
+    BOOST_CHECK(small.full());
+    BOOST_CHECK_EQUAL(small.push([]() { return true; }, [&order](bool) { order.push_back(2); }), sn::ValidationQueue::FULL);
+    release = true;
+    while (small.pending() > 0)
+        MilliSleep(1);
+    BOOST_CHECK(!small.full());
+    BOOST_CHECK(order == std::vector<int>({0, 1}));
+
+    workers.interrupt_all();
+    workers.join_all();
+    BOOST_CHECK_EQUAL(queue.workers(), 0);
+    BOOST_CHECK_EQUAL(small.workers(), 0);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
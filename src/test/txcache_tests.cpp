@@ -0,0 +1,97 @@
+// Copyright (c) 2020 The Blocknet developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <txcache.h>
+
+#include <test/test_bitcoin.h>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(txcache_tests, BasicTestingSetup)
+
+static CTransactionRef MakeTx(const uint32_t n)
+{
+    CMutableTransaction mtx;
+    mtx.vin.resize(1);
+    mtx.vin[0].prevout = COutPoint(InsecureRand256(), n);
+    mtx.vout.resize(1);
+    mtx.vout[0].nValue = n;
+    mtx.vout[0].scriptPubKey = CScript() << OP_TRUE;
+    return MakeTransactionRef(mtx);
+}
+
+BOOST_AUTO_TEST_CASE(txcache_lru)
+{
+    const uint256 hashBlock = InsecureRand256();
+    std::vector<CTransactionRef> txs;
+    for (uint32_t i = 0; i < 10; ++i)
+        txs.push_back(MakeTx(i));
+
+    TransactionCache cache(1 << 20);
+    for (const auto & tx : txs)
+        cache.Put(tx, hashBlock);
+    BOOST_CHECK_EQUAL(cache.GetStats().entries, txs.size());
+
+    CTransactionRef tx;
+    uint256 block;
+    BOOST_CHECK(cache.Get(txs[3]->GetHash(), tx, block));
+    BOOST_CHECK(tx == txs[3]);
+    BOOST_CHECK(block == hashBlock);
+    BOOST_CHECK(!cache.Get(InsecureRand256(), tx, block));
+    auto stats = cache.GetStats();
+    BOOST_CHECK_EQUAL(stats.hits, 1U);
+    BOOST_CHECK_EQUAL(stats.misses, 1U);
+
+    // Unconfirmed transactions are not cached
+    cache.Put(MakeTx(100), uint256());
+    BOOST_CHECK_EQUAL(cache.GetStats().entries, txs.size());
+
+    // Shrinking the cache evicts the least recently used entries, txs[3] was used last
+    const size_t perEntry = cache.GetStats().usage / txs.size();
+    cache.SetMaxUsage(perEntry * 2);
+    stats = cache.GetStats();
+    BOOST_CHECK_EQUAL(stats.entries, 2U);
+    BOOST_CHECK(stats.usage <= stats.maxUsage);
+    BOOST_CHECK(cache.Get(txs[3]->GetHash(), tx, block));
+    BOOST_CHECK(cache.Get(txs[9]->GetHash(), tx, block));
+    BOOST_CHECK(!cache.Get(txs[0]->GetHash(), tx, block));
+
+    // A disabled cache stores nothing
+    cache.SetMaxUsage(0);
+    BOOST_CHECK_EQUAL(cache.GetStats().entries, 0U);
+    cache.Put(txs[0], hashBlock);
+    BOOST_CHECK(!cache.Get(txs[0]->GetHash(), tx, block));
+}
+
+BOOST_AUTO_TEST_CASE(txcache_erase_block)
+{
+    CBlock block;
+    block.vtx.push_back(MakeTx(1));
+    block.vtx.push_back(MakeTx(2));
+    const auto other = MakeTx(3);
+    const uint256 hashBlock = InsecureRand256();
+
+    TransactionCache cache(1 << 20);
+    for (const auto & tx : block.vtx)
+        cache.Put(tx, hashBlock);
+    cache.Put(other, InsecureRand256());
+    const size_t usage = cache.GetStats().usage;
+
+    // Disconnecting the block evicts only its transactions
+    cache.EraseBlock(block);
+    const auto stats = cache.GetStats();
+    BOOST_CHECK_EQUAL(stats.entries, 1U);
+    BOOST_CHECK(stats.usage < usage);
+    CTransactionRef tx;
+    uint256 hash;
+    BOOST_CHECK(!cache.Get(block.vtx[0]->GetHash(), tx, hash));
+    BOOST_CHECK(!cache.Get(block.vtx[1]->GetHash(), tx, hash));
+    BOOST_CHECK(cache.Get(other->GetHash(), tx, hash));
+
+    cache.Clear();
+    BOOST_CHECK_EQUAL(cache.GetStats().entries, 0U);
+    BOOST_CHECK_EQUAL(cache.GetStats().usage, 0U);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -3,7 +3,13 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 #include <test/test_bitcoin.h>
+#include <clientversion.h>
+#include <streams.h>
 #include <xbridge/util/xutil.h>
+#include <xbridge/xbridgetransactiondescr.h>
+#include <xbridge/xbridgewalletconnector.h>
+#include <hash.h>
+#include <key.h>
 #include <boost/test/unit_test.hpp>
 
 BOOST_FIXTURE_TEST_SUITE(xbridge_tests, BasicTestingSetup)
@@ -130,4 +136,112 @@ BOOST_AUTO_TEST_CASE(xbridge_pricecheck) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(xbridge_watchcursors) {
+    const uint32_t maxCursors = xbridge::TransactionDescr::MAX_WATCH_CURSORS;
+    const int currentVersion = xbridge::TransactionDescr::CURRENT_VERSION;
+    xbridge::TransactionDescr order;
+    for (uint32_t block = 100; block < 100 + maxCursors + 5; ++block)
+        order.setWatchCursor(block, strprintf("hash%u", block));
+    { // only the most recent cursors are retained
+        const auto cursors = order.getWatchCursors();
+        BOOST_REQUIRE_EQUAL(cursors.size(), maxCursors);
+        BOOST_CHECK_EQUAL(cursors.front().first, 105U);
+        BOOST_CHECK_EQUAL(cursors.front().second, "hash105");
+        BOOST_CHECK_EQUAL(cursors.back().first, 100 + maxCursors + 4);
+        BOOST_CHECK_EQUAL(order.getWatchStartBlock(), 100U);
+        BOOST_CHECK_EQUAL(order.getWatchCurrentBlock(), 100 + maxCursors + 5);
+    }
+    { // version 2 records round trip the cursors
+        CDataStream ss(SER_DISK, CLIENT_VERSION);
+        ss << order;
+        xbridge::TransactionDescr read;
+        ss >> read;
+        BOOST_CHECK(ss.empty());
+        BOOST_CHECK_EQUAL(read.nVersion, currentVersion);
+        BOOST_CHECK(read.getWatchCursors() == order.getWatchCursors());
+        BOOST_CHECK_EQUAL(read.getWatchCurrentBlock(), order.getWatchCurrentBlock());
+    }
+    { // version 1 records have no cursors and are upgraded when read
+        order.nVersion = 1;
+        CDataStream ss(SER_DISK, CLIENT_VERSION);
+        ss << order;
+        xbridge::TransactionDescr read;
+        ss >> read;
+        BOOST_CHECK(ss.empty());
+        BOOST_CHECK_EQUAL(read.nVersion, currentVersion);
+        BOOST_CHECK(read.getWatchCursors().empty());
+        BOOST_CHECK_EQUAL(read.getWatchCurrentBlock(), order.getWatchCurrentBlock());
+        order.nVersion = currentVersion;
+    }
+    { // orders saved in the middle of a spend check are checked again after a reload
+        order.setWatching(true);
+        CDataStream ss(SER_DISK, CLIENT_VERSION);
+        ss << order;
+        order.setWatching(false);
+        xbridge::TransactionDescr read;
+        ss >> read;
+        BOOST_CHECK(!read.isWatching());
+        BOOST_CHECK(read.getWatchCursors() == order.getWatchCursors());
+        BOOST_CHECK_EQUAL(read.getWatchCurrentBlock(), order.getWatchCurrentBlock());
+    }
+    { // rewinding drops the cursors at or above the rewound height
+        order.rewindWatchBlock(110);
+        const auto cursors = order.getWatchCursors();
+        BOOST_REQUIRE_EQUAL(cursors.size(), 5U);
+        BOOST_CHECK_EQUAL(cursors.back().first, 109U);
+        BOOST_CHECK_EQUAL(order.getWatchCurrentBlock(), 110U);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(xbridge_utxosignature) {
+    const std::string magic = "Blocknet Signed Message:\n";
+    CKey key, otherKey;
+    key.MakeNewKey(true);
+    otherKey.MakeNewKey(true);
+    const CKeyID keyId = key.GetPubKey().GetID();
+    const CKeyID otherKeyId = otherKey.GetPubKey().GetID();
+
+    xbridge::wallet::UtxoEntry entry;
+    entry.txId = "c5b5bfdc3e0ddd4e2fb9bba7fdc7d7fb0c6a8a7b3e1c2d4f5a6b7c8d9e0f1a2b";
+    entry.vout = 1;
+    entry.rawAddress = std::vector<unsigned char>(keyId.begin(), keyId.end());
+    {
+        CHashWriter ss(SER_GETHASH, 0);
+        ss << magic;
+        ss << entry.toString();
+        BOOST_REQUIRE(key.SignCompact(ss.GetHash(), entry.signature));
+    }
+
+    BOOST_CHECK(xbridge::WalletConnector::checkUtxoSignature(entry, magic));
+
+    { // signed by another address
+        auto e = entry;
+        e.rawAddress = std::vector<unsigned char>(otherKeyId.begin(), otherKeyId.end());
+        BOOST_CHECK(!xbridge::WalletConnector::checkUtxoSignature(e, magic));
+    }
+    { // another chain's message magic, e.g. the default
+        BOOST_CHECK(!xbridge::WalletConnector::checkUtxoSignature(entry, "Bitcoin Signed Message:\n"));
+    }
+    { // tampered message
+        auto e = entry;
+        e.vout = 2;
+        BOOST_CHECK(!xbridge::WalletConnector::checkUtxoSignature(e, magic));
+        e = entry;
+        e.txId[0] = 'd';
+        BOOST_CHECK(!xbridge::WalletConnector::checkUtxoSignature(e, magic));
+    }
+    { // tampered or missing signature
+        auto e = entry;
+        e.signature[10] ^= 0x01;
+        BOOST_CHECK(!xbridge::WalletConnector::checkUtxoSignature(e, magic));
+        e.signature.clear();
+        BOOST_CHECK(!xbridge::WalletConnector::checkUtxoSignature(e, magic));
+    }
+    { // raw address of the wrong size
+        auto e = entry;
+        e.rawAddress.pop_back();
+        BOOST_CHECK(!xbridge::WalletConnector::checkUtxoSignature(e, magic));
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
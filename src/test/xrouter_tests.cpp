@@ -3,6 +3,7 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <test/xrouter_tests.h>
+#include <xrouter/xrouterquerymgr.h>
 #include <boost/test/unit_test.hpp>
 
 XRouterTestClient::XRouterTestClient() {
@@ -27,6 +28,105 @@ BOOST_AUTO_TEST_SUITE(xrouter_tests)
 BOOST_AUTO_TEST_CASE(xrouter_tests_default) {
 }
 
+BOOST_AUTO_TEST_CASE(xrouter_tests_querymgr_consensus) {
+    xrouter::QueryMgr queryMgr;
+    const std::string id{"f8a3c3d2-5b7e-4a54-b6a3-3e6d1c0f6a11"};
+    queryMgr.addQuery(id, "node1:41412");
+    queryMgr.addQuery(id, "node2:41412");
+    queryMgr.addQuery(id, "node3:41412");
+    BOOST_CHECK_EQUAL(queryMgr.mostCommonCount(id), 0);
+
+    // Formatting differences in json replies must count as the same vote
+    queryMgr.addReply(id, "node1:41412", R"({"a":1,"b":[1,2]})");
+    BOOST_CHECK_EQUAL(queryMgr.mostCommonCount(id), 1);
+    queryMgr.addReply(id, "node2:41412", R"({ "a": 1, "b": [1, 2] })");
+    BOOST_CHECK_EQUAL(queryMgr.mostCommonCount(id), 2);
+    queryMgr.addReply(id, "node3:41412", R"({"a":2})");
+    BOOST_CHECK_EQUAL(queryMgr.mostCommonCount(id), 2);
+
+    std::string reply;
+    std::map<xrouter::NodeAddr, std::string> replies;
+    std::set<xrouter::NodeAddr> agree, diff;
+    BOOST_CHECK_EQUAL(queryMgr.mostCommonReply(id, reply, replies, agree, diff), 2);
+    BOOST_CHECK_EQUAL(reply, R"({"a":1,"b":[1,2]})");
+    BOOST_CHECK_EQUAL(replies.size(), 3);
+    BOOST_CHECK(agree == std::set<xrouter::NodeAddr>({"node1:41412", "node2:41412"}));
+    BOOST_CHECK(diff == std::set<xrouter::NodeAddr>({"node3:41412"}));
+
+    // Errors do not win ties
+    const std::string id2{"0c9e5f0e-2f4c-4f6e-9d1e-8b2b9b7f4a22"};
+    queryMgr.addQuery(id2, "node1:41412");
+    queryMgr.addQuery(id2, "node2:41412");
+    queryMgr.addReply(id2, "node1:41412", R"({"error":"Internal Server Error","code":1002})");
+    queryMgr.addReply(id2, "node2:41412", "100");
+    BOOST_CHECK_EQUAL(queryMgr.mostCommonReply(id2, reply), 1);
+    BOOST_CHECK_EQUAL(reply, "100");
+}
+
+BOOST_AUTO_TEST_CASE(xrouter_tests_querymgr_latency) {
+    xrouter::QueryMgr queryMgr;
+    const std::string service{"xr::BLOCK::xrGetBlockCount"};
+    BOOST_CHECK_EQUAL(queryMgr.expectedLatency("node1:41412", service, 30000), -1);
+
+    // Replies are timed from when the query was added
+    const std::string id{"5d1c8a7e-3b2f-4c6d-8e9f-0a1b2c3d4e5f"};
+    queryMgr.addQuery(id, "node1:41412", service);
+    queryMgr.addQuery(id, "node2:41412", service);
+    queryMgr.addQuery(id, "node3:41412", service);
+    queryMgr.addReply(id, "node1:41412", "100");
+    queryMgr.addReply(id, "node2:41412", R"({"error":"Internal Server Error","code":1002})");
+    queryMgr.closeQuery(id, 0); // node3 didn't reply within the timeout
+    queryMgr.purge(id);
+
+    auto node1 = queryMgr.getLatencies("node1:41412");
+    BOOST_CHECK_EQUAL(node1.size(), 1);
+    BOOST_CHECK_EQUAL(node1[service].replies, 1);
+    BOOST_CHECK_EQUAL(node1[service].samples.size(), 1);
+    BOOST_CHECK(queryMgr.expectedLatency("node1:41412", service, 30000) >= 0);
+    auto node2 = queryMgr.getLatencies("node2:41412");
+    BOOST_CHECK_EQUAL(node2[service].errors, 1);
+    BOOST_CHECK_EQUAL(node2[service].replies, 0);
+    auto node3 = queryMgr.getLatencies("node3:41412");
+    BOOST_CHECK_EQUAL(node3[service].timeouts, 1);
+    BOOST_CHECK_EQUAL(node3[service].timeoutRate(), 1.0);
+    BOOST_CHECK_EQUAL(queryMgr.expectedLatency("node3:41412", service, 30000), 30000);
+    BOOST_CHECK(queryMgr.expectedLatency("node1:41412", service, 30000) < queryMgr.expectedLatency("node3:41412", service, 30000));
+
+    // Nodes that haven't replied when a query completes early are still timed
+    const std::string id2{"6e2d9b8f-4c3a-4d7e-9fa0-1b2c3d4e5f60"};
+    queryMgr.addQuery(id2, "node1:41412", service);
+    queryMgr.addQuery(id2, "node4:41412", service);
+    queryMgr.addReply(id2, "node1:41412", "100");
+    BOOST_CHECK_EQUAL(queryMgr.expectedLatency("node4:41412", service, 30000), 30000);
+    queryMgr.closeQuery(id2, 30000);
+    queryMgr.purge(id2);
+    BOOST_CHECK(!queryMgr.hasLateQuery(id2, "node1:41412"));
+    BOOST_REQUIRE(queryMgr.hasLateQuery(id2, "node4:41412"));
+    // Queried nodes that never replied rank behind measured nodes
+    BOOST_CHECK(queryMgr.expectedLatency("node1:41412", service, 30000) < queryMgr.expectedLatency("node4:41412", service, 30000));
+    queryMgr.addLateReply(id2, "node4:41412", "100");
+    BOOST_CHECK(!queryMgr.hasLateQuery(id2, "node4:41412"));
+    auto node4 = queryMgr.getLatencies("node4:41412");
+    BOOST_CHECK_EQUAL(node4[service].sent, 1);
+    BOOST_CHECK_EQUAL(node4[service].replies, 1);
+    BOOST_CHECK_EQUAL(node4[service].timeouts, 0);
+    BOOST_CHECK(!queryMgr.hasReply(id2, "node4:41412")); // late replies don't count towards consensus
+
+    const auto totals = queryMgr.getServiceLatencies();
+    BOOST_CHECK_EQUAL(totals.at(service).replies, 3);
+    BOOST_CHECK_EQUAL(totals.at(service).errors, 1);
+    BOOST_CHECK_EQUAL(totals.at(service).timeouts, 1);
+
+    // Percentiles and the moving average over a fixed window of samples
+    xrouter::QueryMgr::LatencyStats stats;
+    for (int i = 1; i <= XROUTER_LATENCY_SAMPLES * 2; ++i)
+        stats.addSample(i);
+    BOOST_CHECK_EQUAL(stats.samples.size(), XROUTER_LATENCY_SAMPLES);
+    BOOST_CHECK_EQUAL(stats.percentile(50), XROUTER_LATENCY_SAMPLES * 3 / 2);
+    BOOST_CHECK_EQUAL(stats.percentile(100), XROUTER_LATENCY_SAMPLES * 2);
+    BOOST_CHECK(stats.ewma > XROUTER_LATENCY_SAMPLES * 2 - 10 && stats.ewma <= XROUTER_LATENCY_SAMPLES * 2);
+}
+
 #ifdef USE_XROUTERCLIENT
 
 BOOST_FIXTURE_TEST_CASE(xrouter_tests_waitforservice, XRouterTestClientTestnet) {
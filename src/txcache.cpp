@@ -0,0 +1,108 @@
+// Copyright (c) 2020 The Blocknet developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <txcache.h>
+
+#include <core_memusage.h>
+#include <memusage.h>
+
+std::unique_ptr<TransactionCache> g_txcache;
+
+/** Memory used by a cached transaction, including the list and map nodes that reference it. */
+static size_t EntryUsage(const CTransactionRef& tx)
+{
+    return RecursiveDynamicUsage(tx)
+         + memusage::MallocUsage(sizeof(CTransactionRef) + sizeof(uint256) + sizeof(size_t) + 2 * sizeof(void*))
+         + memusage::MallocUsage(sizeof(std::pair<const uint256, void*>) + sizeof(void*));
+}
+
+TransactionCache::TransactionCache(const size_t maxUsage) : maxUsage(maxUsage) {}
+
+bool TransactionCache::Get(const uint256& txid, CTransactionRef& tx, uint256& hashBlock)
+{
+    LOCK(mu);
+    auto it = index.find(txid);
+    if (it == index.end()) {
+        ++misses;
+        return false;
+    }
+    entries.splice(entries.begin(), entries, it->second);
+    tx = it->second->tx;
+    hashBlock = it->second->hashBlock;
+    ++hits;
+    return true;
+}
+
+void TransactionCache::Put(const CTransactionRef& tx, const uint256& hashBlock)
+{
+    if (!tx || hashBlock.IsNull())
+        return;
+    LOCK(mu);
+    if (maxUsage == 0)
+        return;
+    auto it = index.find(tx->GetHash());
+    if (it != index.end()) {
+        it->second->hashBlock = hashBlock;
+        entries.splice(entries.begin(), entries, it->second);
+        return;
+    }
+    Entry entry;
+    entry.tx = tx;
+    entry.hashBlock = hashBlock;
+    entry.usage = EntryUsage(tx);
+    entries.push_front(std::move(entry));
+    index.emplace(tx->GetHash(), entries.begin());
+    usage += entries.front().usage;
+    Trim();
+}
+
+void TransactionCache::EraseBlock(const CBlock& block)
+{
+    LOCK(mu);
+    for (const auto& tx : block.vtx) {
+        auto it = index.find(tx->GetHash());
+        if (it != index.end())
+            Erase(it->second);
+    }
+}
+
+void TransactionCache::SetMaxUsage(const size_t max)
+{
+    LOCK(mu);
+    maxUsage = max;
+    Trim();
+}
+
+void TransactionCache::Clear()
+{
+    LOCK(mu);
+    index.clear();
+    entries.clear();
+    usage = 0;
+}
+
+TransactionCache::Stats TransactionCache::GetStats()
+{
+    Stats stats;
+    LOCK(mu);
+    stats.entries = entries.size();
+    stats.usage = usage;
+    stats.maxUsage = maxUsage;
+    stats.hits = hits;
+    stats.misses = misses;
+    return stats;
+}
+
+void TransactionCache::Erase(EntryList::iterator it)
+{
+    usage -= it->usage;
+    index.erase(it->tx->GetHash());
+    entries.erase(it);
+}
+
+void TransactionCache::Trim()
+{
+    while (usage > maxUsage && !entries.empty())
+        Erase(std::prev(entries.end()));
+}
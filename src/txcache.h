@@ -0,0 +1,100 @@
+// Copyright (c) 2020 The Blocknet developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BLOCKNET_TXCACHE_H
+#define BLOCKNET_TXCACHE_H
+
+#include <primitives/block.h>
+#include <primitives/transaction.h>
+#include <sync.h>
+#include <txmempool.h>
+#include <uint256.h>
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <unordered_map>
+
+//! Default for -txcache, maximum memory used by decoded confirmed transactions (MiB)
+static const int64_t DEFAULT_TX_CACHE_SIZE = 32;
+
+/**
+ * Thread-safe LRU of confirmed transactions keyed by txid, bounded by the dynamic memory
+ * usage of the cached transactions. GetTransaction consults the cache before reading from
+ * the block files, which keeps repeated lookups of the same snode collateral, stake input
+ * and governance vote transactions off the disk. Entries are evicted when the block that
+ * contains them is disconnected.
+ */
+class TransactionCache {
+public:
+    struct Stats {
+        size_t entries{0};
+        size_t usage{0};
+        size_t maxUsage{0};
+        uint64_t hits{0};
+        uint64_t misses{0};
+    };
+
+    explicit TransactionCache(size_t maxUsage);
+
+    /**
+     * Looks up a confirmed transaction. On a hit the transaction becomes the most
+     * recently used entry.
+     * @param txid
+     * @param tx
+     * @param hashBlock Hash of the block containing the transaction
+     * @return
+     */
+    bool Get(const uint256& txid, CTransactionRef& tx, uint256& hashBlock);
+
+    /**
+     * Adds a confirmed transaction, evicting the least recently used entries when
+     * the cache is over its memory limit.
+     * @param tx
+     * @param hashBlock Hash of the block containing the transaction
+     */
+    void Put(const CTransactionRef& tx, const uint256& hashBlock);
+
+    /**
+     * Evicts the transactions of a disconnected block.
+     * @param block
+     */
+    void EraseBlock(const CBlock& block);
+
+    /**
+     * Changes the memory limit, 0 disables the cache.
+     * @param maxUsage Bytes
+     */
+    void SetMaxUsage(size_t maxUsage);
+
+    void Clear();
+
+    Stats GetStats();
+
+private:
+    struct Entry {
+        CTransactionRef tx;
+        uint256 hashBlock;
+        size_t usage;
+    };
+    typedef std::list<Entry> EntryList;
+
+    void Erase(EntryList::iterator it) EXCLUSIVE_LOCKS_REQUIRED(mu);
+    void Trim() EXCLUSIVE_LOCKS_REQUIRED(mu);
+
+private:
+    Mutex mu;
+    //! Most recently used entries first
+    EntryList entries GUARDED_BY(mu);
+    std::unordered_map<uint256, EntryList::iterator, SaltedTxidHasher> index GUARDED_BY(mu);
+    size_t usage GUARDED_BY(mu){0};
+    size_t maxUsage GUARDED_BY(mu);
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> misses{0};
+};
+
+/** The global cache used by GetTransaction. May be null. */
+extern std::unique_ptr<TransactionCache> g_txcache;
+
+#endif // BLOCKNET_TXCACHE_H
@@ -41,6 +41,10 @@ static const int64_t nMaxTxIndexCache = 3096;
 static const int64_t nMaxCoinsDBCache = 32;
 //! Max memory allocated to governance cache (MiB)
 static const int64_t nMaxGovDBCache = 16;
+//! Max memory allocated to all block filter index caches combined in MiB.
+static const int64_t max_filter_index_cache = 1024;
+//! Max memory allocated to the address index cache in MiB.
+static const int64_t nMaxAddressIndexCache = 1024;
 
 /** CCoinsView backed by the coin database (chainstate/) */
 class CCoinsViewDB final : public CCoinsView
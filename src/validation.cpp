@@ -38,6 +38,7 @@
 #include <timedata.h>
 #include <tinyformat.h>
 #include <txdb.h>
+#include <txcache.h>
 #include <txmempool.h>
 #include <ui_interface.h>
 #include <undo.h>
@@ -243,6 +244,8 @@ bool fIsBareMultisigStd = DEFAULT_PERMIT_BAREMULTISIG;
 bool fRequireStandard = true;
 bool fCheckBlockIndex = false;
 bool fCheckpointsEnabled = DEFAULT_CHECKPOINTS_ENABLED;
+bool fCheckPoSOnRead = DEFAULT_CHECKPOSONREAD;
+bool fParallelStakeCheck = DEFAULT_PARALLELSTAKECHECK;
 size_t nCoinCacheUsage = 5000 * 300;
 uint64_t nPruneTarget = 0;
 int64_t nMaxTipAge = DEFAULT_MAX_TIP_AGE;
@@ -1023,6 +1026,19 @@ bool AcceptToMemoryPool(CTxMemPool& pool, CValidationState &state, const CTransa
  */
 bool GetTransaction(const uint256& hash, CTransactionRef& txOut, const Consensus::Params& consensusParams, uint256& hashBlock, const CBlockIndex* const block_index)
 {
+    // Confirmed transactions are served from the cache without taking cs_main. A cached
+    // transaction can't also be in the mempool, its block would have been disconnected
+    // first and that evicts it.
+    if (g_txcache) {
+        CTransactionRef ptx;
+        uint256 cachedBlock;
+        if (g_txcache->Get(hash, ptx, cachedBlock) && (!block_index || block_index->GetBlockHash() == cachedBlock)) {
+            txOut = ptx;
+            hashBlock = cachedBlock;
+            return true;
+        }
+    }
+
     LOCK(cs_main);
 
     if (!block_index) {
@@ -1032,8 +1048,14 @@ bool GetTransaction(const uint256& hash, CTransactionRef& txOut, const Consensus
             return true;
         }
 
-        if (g_txindex) {
-            return g_txindex->FindTx(hash, hashBlock, txOut);
+        if (g_txindex && g_txindex->FindTx(hash, hashBlock, txOut)) {
+            // The txindex keeps entries of disconnected blocks, only cache active chain transactions
+            if (g_txcache) {
+                const CBlockIndex* pindex = LookupBlockIndex(hashBlock);
+                if (pindex && chainActive.Contains(pindex))
+                    g_txcache->Put(txOut, hashBlock);
+            }
+            return true;
         }
     } else {
         CBlock block;
@@ -1042,6 +1064,7 @@ bool GetTransaction(const uint256& hash, CTransactionRef& txOut, const Consensus
                 if (tx->GetHash() == hash) {
                     txOut = tx;
                     hashBlock = block_index->GetBlockHash();
+                    if (g_txcache && chainActive.Contains(block_index)) g_txcache->Put(txOut, hashBlock);
                     return true;
                 }
             }
@@ -1111,19 +1134,28 @@ bool ReadBlockFromDisk(CBlock& block, const CDiskBlockPos& pos, const Consensus:
 bool ReadBlockFromDisk(CBlock& block, const CBlockIndex* pindex, const Consensus::Params& consensusParams)
 {
     CDiskBlockPos blockPos;
+    bool fPoSVerified;
     {
         LOCK(cs_main);
         blockPos = pindex->GetBlockPos();
+        fPoSVerified = pindex->nStatus & BLOCK_VALID_POS;
     }
 
     if (!ReadBlockFromDisk(block, blockPos, consensusParams))
         return false;
 
-    // Check PoS
-    if (block.IsProofOfStake()) {
+    // Check PoS, skipped if the stake was already verified
+    if (block.IsProofOfStake() && (fCheckPoSOnRead || !fPoSVerified)) {
         uint256 hashProofOfStake;
         if (!CheckProofOfStake(block, pindex->pprev, hashProofOfStake, consensusParams))
             return error("ReadBlockFromDisk(CBlock&, CBlockIndex*): proof of stake check failed on block %u", pindex->nHeight);
+        if (!fPoSVerified && block.GetHash() == pindex->GetBlockHash()) {
+            LOCK(cs_main);
+            // Record the result, the index entry is owned by mapBlockIndex
+            auto pindexVerified = const_cast<CBlockIndex*>(pindex);
+            pindexVerified->nStatus |= BLOCK_VALID_POS;
+            setDirtyBlockIndex.insert(pindexVerified);
+        }
     }
 
     if (block.GetHash() != pindex->GetBlockHash())
@@ -1502,7 +1534,9 @@ bool UndoWriteToDisk(const CBlockUndo& blockundo, CDiskBlockPos& pos, const uint
     return true;
 }
 
-static bool UndoReadFromDisk(CBlockUndo& blockundo, const CBlockIndex *pindex)
+} // namespace
+
+bool UndoReadFromDisk(CBlockUndo& blockundo, const CBlockIndex *pindex)
 {
     CDiskBlockPos pos = pindex->GetUndoPos();
     if (pos.IsNull()) {
@@ -1533,6 +1567,8 @@ static bool UndoReadFromDisk(CBlockUndo& blockundo, const CBlockIndex *pindex)
     return true;
 }
 
+namespace {
+
 /** Abort with a message */
 static bool AbortNode(const std::string& strMessage, const std::string& userMessage="")
 {
@@ -1704,6 +1740,100 @@ void ThreadScriptCheck() {
     scriptcheckqueue.Thread();
 }
 
+/**
+ * Closure representing a proof of stake kernel check of a block index. The stake
+ * block index is resolved by the caller so that the check doesn't need cs_main.
+ */
+class CStakeCheck
+{
+private:
+    const CBlockIndex *pindex{nullptr};
+    const CBlockIndex *pindexStake{nullptr};
+    const Consensus::Params *consensus{nullptr};
+    char *pvalid{nullptr};
+
+public:
+    CStakeCheck() = default;
+    CStakeCheck(const CBlockIndex *pindexIn, const CBlockIndex *pindexStakeIn, const Consensus::Params *consensusIn, char *pvalidIn) :
+        pindex(pindexIn), pindexStake(pindexStakeIn), consensus(consensusIn), pvalid(pvalidIn) { }
+
+    // Always succeeds: the check queue stops running the remaining checks after a
+    // failure, which would leave the valid blocks of the run unmarked. The outcome
+    // is only reported through pvalid.
+    bool operator()() {
+        // Same checks as CheckPoS() on a header rebuilt from the index
+        const CBlockIndex *pindexPrev = pindex->pprev;
+        if (pindex->nBits != GetNextWorkRequired(pindexPrev, nullptr, *consensus))
+            return true;
+        const CBlockHeader header = pindex->GetBlockHeader();
+        uint256 hashProofOfStake;
+        if (!CheckStakeKernelHash(pindexPrev, pindexStake, header.nBits, header.nStakeAmount, { header.hashStake, header.nStakeIndex },
+                                  header.nTime, header.nNonce, hashProofOfStake, *consensus))
+            return true;
+        *pvalid = 1;
+        return true;
+    }
+
+    void swap(CStakeCheck &check) {
+        std::swap(pindex, check.pindex);
+        std::swap(pindexStake, check.pindexStake);
+        std::swap(consensus, check.consensus);
+        std::swap(pvalid, check.pvalid);
+    }
+};
+
+static CCheckQueue<CStakeCheck> stakecheckqueue(32);
+
+void ThreadStakeCheck() {
+    RenameThread("blocknet-stakech");
+    stakecheckqueue.Thread();
+}
+
+/**
+ * Verify the stake kernels of a run of blocks about to be connected on the stake check
+ * queue. Blocks that pass are marked BLOCK_VALID_POS so that reading and connecting them
+ * skips the kernel check. Failures are left for the regular checks in ConnectTip to report.
+ */
+void CheckStakeKernels(const std::vector<CBlockIndex*>& vpindex, const Consensus::Params& consensus)
+{
+    AssertLockHeld(cs_main);
+    if (!fParallelStakeCheck || nScriptCheckThreads == 0)
+        return;
+
+    int64_t nTimeStart = GetTimeMicros();
+    std::vector<char> vValid(vpindex.size(), 0);
+    std::vector<CStakeCheck> vChecks;
+    vChecks.reserve(vpindex.size());
+    for (unsigned int i = 0; i < vpindex.size(); i++) {
+        CBlockIndex *pindex = vpindex[i];
+        if (!pindex->pprev || !pindex->IsProofOfStake() || (pindex->nStatus & BLOCK_VALID_POS))
+            continue;
+        if (!IsProtocolV05(pindex->GetBlockTime())) // legacy stake modifiers are looked up on the active chain
+            continue;
+        const CBlockIndex *pindexStake = LookupBlockIndex(pindex->hashStakeBlock);
+        if (!pindexStake)
+            continue;
+        vChecks.emplace_back(pindex, pindexStake, &consensus, &vValid[i]);
+    }
+    const size_t nChecks = vChecks.size();
+    if (nChecks < 2)
+        return; // nothing to gain over the inline check
+
+    CCheckQueueControl<CStakeCheck> control(&stakecheckqueue);
+    control.Add(vChecks);
+    control.Wait();
+
+    unsigned int nVerified = 0;
+    for (unsigned int i = 0; i < vpindex.size(); i++) {
+        if (!vValid[i])
+            continue;
+        vpindex[i]->nStatus |= BLOCK_VALID_POS;
+        setDirtyBlockIndex.insert(vpindex[i]);
+        nVerified++;
+    }
+    LogPrint(BCLog::BENCH, "    - Verify %u/%u stake kernels: %.2fms\n", nVerified, nChecks, 0.001 * (GetTimeMicros() - nTimeStart));
+}
+
 VersionBitsCache versionbitscache GUARDED_BY(cs_main);
 
 int32_t ComputeBlockVersion(const CBlockIndex* pindexPrev, const Consensus::Params& params)
@@ -1836,7 +1966,9 @@ bool CChainState::ConnectBlock(const CBlock& block, CValidationState& state, CBl
     // is enforced in ContextualCheckBlockHeader(); we wouldn't want to
     // re-enforce that rule here (at least until we make it impossible for
     // GetAdjustedTime() to go backward).
-    if (!CheckBlock(block, state, chainparams.GetConsensus(), !fJustCheck, !fJustCheck)) {
+    // Stake kernels already verified for this block index (see CheckStakeKernels) are not checked again
+    const bool fPoSVerified = !block.hashStake.IsNull() && (pindex->nStatus & BLOCK_VALID_POS) && !fCheckPoSOnRead;
+    if (!CheckBlock(block, state, chainparams.GetConsensus(), !fJustCheck && !fPoSVerified, !fJustCheck)) {
         if (state.CorruptionPossible()) {
             // We don't write down blocks to disk if they may have been
             // corrupted, so this should be impossible unless we're having hardware
@@ -1849,16 +1981,17 @@ bool CChainState::ConnectBlock(const CBlock& block, CValidationState& state, CBl
     // PoS verification checks
     if (IsProofOfStake(pindex->nHeight) || block.IsProofOfStake()) {
         const auto & txin = block.vtx[1]->vin[0];
-        uint256 hashStakeInputBlock;
-        CTransactionRef txStake;
-        if (!GetTransaction(txin.prevout.hash, txStake, chainparams.GetConsensus(), hashStakeInputBlock))
-            return error("Failed to validate block %s, couldn't find stake transaction %s", block.GetHash().ToString(), txin.prevout.hash.ToString().c_str());
-        if (txStake->vout.size() <= txin.prevout.n) // check bounds
-            return state.DoS(100, false, REJECT_INVALID, "bad-stake-pos", false, "out-of-bounds coinstake");
-        if (txStake->vout[txin.prevout.n].nValue != block.nStakeAmount || txStake->vout[txin.prevout.n].nValue <= 0) // check stake amount
+        // The stake input is unspent until this block connects, read it from the
+        // coins view instead of loading the stake transaction from disk
+        const Coin & coinStake = view.AccessCoin(txin.prevout);
+        if (coinStake.IsSpent()) // connecting the coinstake would fail on the missing input as well
+            return state.DoS(100, error("%s: couldn't find stake input %s for block %s", __func__, txin.prevout.ToString(), block.GetHash().ToString()),
+                             REJECT_INVALID, "bad-txns-inputs-missingorspent", false, "stake input missing or spent");
+        const auto & txStakeOut = coinStake.out;
+        if (txStakeOut.nValue != block.nStakeAmount || txStakeOut.nValue <= 0) // check stake amount
             return state.DoS(100, false, REJECT_INVALID, "bad-stake-amount", false, "bad stake amount");
         // TODO Blocknet PoS verify that the stake input sig matches the signer of the block, i.e. staker must be the block signer
-        if (!VerifySig(block, txStake->vout[txin.prevout.n].scriptPubKey) && !VerifySig(block, block.vtx[1]->vout[1].scriptPubKey))
+        if (!VerifySig(block, txStakeOut.scriptPubKey) && !VerifySig(block, block.vtx[1]->vout[1].scriptPubKey))
             return state.DoS(100, false, REJECT_INVALID, "bad-stake-signer", false, "bad block sig staker must be signer");
         if (IsProtocolV06(block.GetBlockTime(), chainparams.GetConsensus())) {
             const auto lastBlockTime = pindex->pprev->GetBlockTime();
@@ -2065,6 +2198,12 @@ bool CChainState::ConnectBlock(const CBlock& block, CValidationState& state, CBl
         setDirtyBlockIndex.insert(pindex);
     }
 
+    // CheckBlock above verified the proof of stake
+    if (block.IsProofOfStake() && !(pindex->nStatus & BLOCK_VALID_POS)) {
+        pindex->nStatus |= BLOCK_VALID_POS;
+        setDirtyBlockIndex.insert(pindex);
+    }
+
     assert(pindex->phashBlock);
     // add this block to the view's block chain
     view.SetBestBlock(pindex->GetBlockHash());
@@ -2307,6 +2446,7 @@ bool CChainState::DisconnectTip(CValidationState& state, const CChainParams& cha
         bool flushed = view.Flush();
         assert(flushed);
     }
+    if (g_txcache) g_txcache->EraseBlock(block);
     LogPrint(BCLog::BENCH, "- Disconnect block: %.2fms\n", (GetTimeMicros() - nStart) * MILLI);
     // Write the chain state to disk, if necessary.
     if (!FlushStateToDisk(chainparams, state, FlushStateMode::IF_NEEDED))
@@ -2576,6 +2716,9 @@ bool CChainState::ActivateBestChainStep(CValidationState& state, const CChainPar
         }
         nHeight = nTargetHeight;
 
+        // Verify the stake kernels of the whole run up front so they don't hold up each ConnectTip
+        CheckStakeKernels(vpindexToConnect, chainparams.GetConsensus());
+
         // Connect new blocks.
         for (CBlockIndex *pindexConnect : reverse_iterate(vpindexToConnect)) {
             if (!ConnectTip(state, chainparams, pindexConnect, pindexConnect == pindexMostWork ? pblock : std::shared_ptr<const CBlock>(), connectTrace, disconnectpool)) {
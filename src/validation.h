@@ -37,6 +37,7 @@
 #include <atomic>
 
 class CBlockIndex;
+class CBlockUndo;
 class CBlockTreeDB;
 class CChainParams;
 class CCoinsViewDB;
@@ -121,7 +122,13 @@ static const int64_t MAX_FEE_ESTIMATION_TIP_AGE = 20 * 60; // 20 minutes
 /** Default for -permitbaremultisig */
 static const bool DEFAULT_PERMIT_BAREMULTISIG = true;
 static const bool DEFAULT_CHECKPOINTS_ENABLED = true;
+/** Verify the proof of stake of blocks read from disk even if it was verified before */
+static const bool DEFAULT_CHECKPOSONREAD = false;
+/** Verify the proof of stake kernels of blocks about to be connected in parallel */
+static const bool DEFAULT_PARALLELSTAKECHECK = true;
 static const bool DEFAULT_TXINDEX = true;
+static const char* const DEFAULT_BLOCKFILTERINDEX = "0";
+static const bool DEFAULT_ADDRESSINDEX = false;
 static const unsigned int DEFAULT_BANSCORE_THRESHOLD = 100;
 /** Default for -persistmempool */
 static const bool DEFAULT_PERSIST_MEMPOOL = true;
@@ -168,6 +175,8 @@ extern bool fIsBareMultisigStd;
 extern bool fRequireStandard;
 extern bool fCheckBlockIndex;
 extern bool fCheckpointsEnabled;
+extern bool fCheckPoSOnRead;
+extern bool fParallelStakeCheck;
 extern size_t nCoinCacheUsage;
 /** A fee rate smaller than this is considered zero fee (for relaying, mining and transaction creation) */
 extern CFeeRate minRelayTxFee;
@@ -270,6 +279,10 @@ bool LoadChainTip(const CChainParams& chainparams) EXCLUSIVE_LOCKS_REQUIRED(cs_m
 void UnloadBlockIndex();
 /** Run an instance of the script checking thread */
 void ThreadScriptCheck();
+/** Run an instance of the proof of stake kernel checking thread */
+void ThreadStakeCheck();
+/** Verify the stake kernels of blocks about to be connected on the stake check threads, marking them BLOCK_VALID_POS */
+void CheckStakeKernels(const std::vector<CBlockIndex*>& vpindex, const Consensus::Params& consensus) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 /** Check whether we are doing an initial block download (synchronizing from disk or network) */
 bool IsInitialBlockDownload();
 /** Retrieve a transaction (from memory pool, or from disk, if possible) */
@@ -406,6 +419,8 @@ bool ReadBlockFromDisk(CBlock& block, const CBlockIndex* pindex, const Consensus
 bool ReadRawBlockFromDisk(std::vector<uint8_t>& block, const CDiskBlockPos& pos, const CMessageHeader::MessageStartChars& message_start);
 bool ReadRawBlockFromDisk(std::vector<uint8_t>& block, const CBlockIndex* pindex, const CMessageHeader::MessageStartChars& message_start);
 
+bool UndoReadFromDisk(CBlockUndo& blockundo, const CBlockIndex* pindex);
+
 /** Functions for validating blocks and updating the block tree */
 
 /** Context-independent validity checks */
@@ -245,6 +245,77 @@ BOOST_FIXTURE_TEST_CASE(staking_tests_nocoinstake, TestChainPoS)
     BOOST_CHECK_EQUAL(nDoS, 100);
 }
 
+/// Connected PoS blocks are marked as verified so that block reads skip the kernel check.
+BOOST_FIXTURE_TEST_CASE(staking_tests_posverified, TestChainPoS)
+{
+    const auto tip = chainActive.Tip();
+    CBlock block;
+    BOOST_CHECK(ReadBlockFromDisk(block, tip, Params().GetConsensus()));
+    BOOST_CHECK(block.IsProofOfStake());
+    {
+        LOCK(cs_main);
+        BOOST_CHECK(tip->nStatus & BLOCK_VALID_POS);
+        // Clear the status, a successful read must restore it
+        tip->nStatus &= ~BLOCK_VALID_POS;
+    }
+    BOOST_CHECK(ReadBlockFromDisk(block, tip, Params().GetConsensus()));
+    {
+        LOCK(cs_main);
+        BOOST_CHECK(tip->nStatus & BLOCK_VALID_POS);
+    }
+
+    // Forced checks must still pass on verified blocks
+    fCheckPoSOnRead = true;
+    BOOST_CHECK(ReadBlockFromDisk(block, tip, Params().GetConsensus()));
+    fCheckPoSOnRead = DEFAULT_CHECKPOSONREAD;
+}
+
+/// Blocks finalized from a pre-assembled stake template must match blocks assembled from scratch.
+BOOST_FIXTURE_TEST_CASE(staking_tests_staketemplate, TestChainPoS)
+{
+    const auto & params = Params();
+    auto stakeTemplate = BlockAssembler(params).CreateStakeTemplate();
+    BOOST_CHECK(stakeTemplate != nullptr);
+    BOOST_CHECK_EQUAL(stakeTemplate->hashPrevBlock, chainActive.Tip()->GetBlockHash());
+    BOOST_CHECK_EQUAL(stakeTemplate->nHeight, chainActive.Height() + 1);
+
+    const auto ns = FindStake();
+    auto fromScratch = BlockAssembler(params).CreateNewBlockPoS(*ns.coin, ns.hashBlock, ns.time, ns.blockTime, ns.wallet.get(), true);
+    auto fromTemplate = BlockAssembler(params).CreateNewBlockPoS(*ns.coin, ns.hashBlock, ns.time, ns.blockTime, ns.wallet.get(), true, stakeTemplate.get());
+    BOOST_CHECK(fromScratch != nullptr && fromTemplate != nullptr);
+    BOOST_CHECK_EQUAL(fromTemplate->block.vtx.size(), fromScratch->block.vtx.size());
+    BOOST_CHECK_EQUAL(fromTemplate->block.GetHash(), fromScratch->block.GetHash());
+
+    // Templates built on a different tip are ignored
+    stakeTemplate->hashPrevBlock = chainActive.Tip()->pprev->GetBlockHash();
+    auto fromStale = BlockAssembler(params).CreateNewBlockPoS(*ns.coin, ns.hashBlock, ns.time, ns.blockTime, ns.wallet.get(), true, stakeTemplate.get());
+    BOOST_CHECK_EQUAL(fromStale->block.GetHash(), fromScratch->block.GetHash());
+}
+
+/// Stake kernels of a run of blocks are verified on the check queue and marked on the index.
+BOOST_FIXTURE_TEST_CASE(staking_tests_checkstakekernels, TestChainPoS)
+{
+    LOCK(cs_main);
+    std::vector<CBlockIndex*> blocks;
+    for (auto pindex = chainActive.Tip(); pindex->IsProofOfStake(); pindex = pindex->pprev) {
+        // Only v05 kernels with a known stake block are checked on the queue
+        BOOST_REQUIRE(IsProtocolV05(pindex->GetBlockTime()));
+        BOOST_REQUIRE(LookupBlockIndex(pindex->hashStakeBlock) != nullptr);
+        pindex->nStatus &= ~BLOCK_VALID_POS;
+        blocks.push_back(pindex);
+    }
+    BOOST_REQUIRE(blocks.size() >= 3);
+
+    // A block whose kernel doesn't meet the target is left for the regular checks
+    const auto nStakeAmount = blocks[1]->nStakeAmount;
+    blocks[1]->nStakeAmount = 1;
+    CheckStakeKernels(blocks, Params().GetConsensus());
+    blocks[1]->nStakeAmount = nStakeAmount;
+
+    for (int i = 0; i < static_cast<int>(blocks.size()); ++i)
+        BOOST_CHECK_EQUAL((blocks[i]->nStatus & BLOCK_VALID_POS) != 0, i != 1);
+}
+
 /// Check that v03 staking modifier doesn't change for each new selection interval
 BOOST_AUTO_TEST_CASE(staking_tests_v03modifier)
 {
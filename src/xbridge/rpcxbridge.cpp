@@ -675,8 +675,8 @@ UniValue dxGetOrderHistory(const JSONRPCRequest& request)
         auto& xseries = xbridge::App::instance().getXSeriesCache();
         std::vector<xAggregate> result = xseries.getXAggregateSeries(query);
 
-        //--Serialize result
-        Array arr{};
+        //--Serialize result, one interval at a time
+        JSONRPCResultWriter arr(request, UniValue::VARR);
         const boost::posix_time::time_duration offset = query.interval_timestamp.at_start()
             ? query.granularity
             : boost::posix_time::seconds{0};
@@ -691,9 +691,9 @@ UniValue dxGetOrderHistory(const JSONRPCRequest& request)
                     orderIds.emplace_back(id);
                 ohlc.emplace_back(orderIds);
             }
-            arr.emplace_back(ohlc);
+            arr.push_back(uret(ohlc));
         }
-        return uret(arr);
+        return arr.Finish();
     } catch(const std::exception& e) {
         return uret(xbridge::makeError(xbridge::UNKNOWN_ERROR, __FUNCTION__, e.what() ));
     } catch( ... ) {
@@ -2853,14 +2853,21 @@ UniValue dxGetTradingData(const JSONRPCRequest& request)
         countOfBlocks = params[0].get_int();
     }
 
-    LOCK(cs_main);
+    // Only hold cs_main while selecting the blocks, the records are streamed
+    // to the client while the blocks are read from disk
+    std::vector<const CBlockIndex*> blocks;
+    {
+        LOCK(cs_main);
+        const CBlockIndex * pindex = chainActive.Tip();
+        int64_t timeBegin = chainActive.Tip()->GetBlockTime();
+        for (; pindex->pprev && pindex->GetBlockTime() > (timeBegin-30*24*60*60) && countOfBlocks > 0;
+                 pindex = pindex->pprev, --countOfBlocks)
+            blocks.push_back(pindex);
+    }
 
-    Array records;
+    JSONRPCResultWriter records(request, UniValue::VARR);
 
-    CBlockIndex * pindex = chainActive.Tip();
-    int64_t timeBegin = chainActive.Tip()->GetBlockTime();
-    for (; pindex->pprev && pindex->GetBlockTime() > (timeBegin-30*24*60*60) && countOfBlocks > 0;
-             pindex = pindex->pprev, --countOfBlocks)
+    for (const CBlockIndex * pindex : blocks)
     {
         CBlock block;
         if (!ReadBlockFromDisk(block, pindex, Params().GetConsensus()))
@@ -2879,14 +2886,14 @@ UniValue dxGetTradingData(const JSONRPCRequest& request)
             case CurrencyPair::Tag::Error:
                 // Show errors
                 if (showErrors)
-                    records.emplace_back(Object{
+                    records.push_back(uret(Object{
                         Pair{"timestamp",  timestamp},
                         Pair{"fee_txid",   txid},
                         Pair{"id",         p.error()}
-                    });
+                    }));
                 break;
             case CurrencyPair::Tag::Valid:
-                records.emplace_back(Object{
+                records.push_back(uret(Object{
                             Pair{"timestamp",  timestamp},
                             Pair{"fee_txid",   txid},
                             Pair{"nodepubkey", snode_pubkey},
@@ -2895,7 +2902,7 @@ UniValue dxGetTradingData(const JSONRPCRequest& request)
                             Pair{"taker_size", p.from.amount<double>()},
                             Pair{"maker",      p.to.currency().to_string()},
                             Pair{"maker_size", p.to.amount<double>()},
-                            });
+                            }));
                 break;
             case CurrencyPair::Tag::Empty:
             default:
@@ -2904,7 +2911,7 @@ UniValue dxGetTradingData(const JSONRPCRequest& request)
         }
     }
 
-    return uret(records);
+    return records.Finish();
 }
 
 UniValue dxMakePartialOrder(const JSONRPCRequest& request)
@@ -353,7 +353,13 @@ bool App::createConf()
                 "# TxWithTimeField=false"                                                      + eol +
                 "# LockCoinsSupported=false"                                                   + eol +
                 "# JSONVersion="                                                               + eol +
-                "# ContentType="                                                               + eol
+                "# ContentType="                                                               + eol +
+                "# MessageMagic is the chain's signed message header without the trailing"     + eol +
+                "# newline. Utxo signatures are checked in process with it, the ones that"     + eol +
+                "# don't match are sent to the wallet's verifymessage. The default"            + eol +
+                "# \"Bitcoin Signed Message:\" only matches chains that kept Bitcoin's"        + eol +
+                "# header, set it for other chains."                                           + eol +
+                "# MessageMagic=Blocknet Signed Message:"                                      + eol
             );
         }
 
@@ -582,11 +588,8 @@ void App::Impl::onSend(const std::vector<unsigned char> & id, const std::vector<
 
     // Relay
     const CNetMsgMaker msgMaker(PROTOCOL_VERSION);
-    g_connman->ForEachNode([&](CNode* pnode) {
-        if (!pnode->fSuccessfullyConnected)
-            return;
-        if (pnode->fSuccessfullyConnected && !pnode->fDisconnect && !pnode->fXRouter) // do not relay to xrouter nodes
-            g_connman->PushMessage(pnode, msgMaker.Make(NetMsgType::XBRIDGE, msg));
+    g_connman->BroadcastMessage(msgMaker.Make(NetMsgType::XBRIDGE, msg), [](CNode* pnode) {
+        return !pnode->fXRouter; // do not relay to xrouter nodes
     });
 }
 
@@ -995,6 +998,7 @@ void App::updateActiveWallets()
         wp.jsonver                     = s.get<std::string>(*i + ".JSONVersion", "");
         wp.contenttype                 = s.get<std::string>(*i + ".ContentType", "");
         wp.cashAddrPrefix              = s.get<std::string>(*i + ".CashAddrPrefix", "");
+        wp.messageMagic                = s.get<std::string>(*i + ".MessageMagic", "Bitcoin Signed Message:") + "\n";
 
         if (wp.m_user.empty() || wp.m_passwd.empty())
             WARN() << wp.currency << " \"" << wp.title << "\"" << " has empty credentials";
@@ -3392,11 +3396,36 @@ void App::Impl::checkWatchesOnDepositSpends()
                     continue;
                 }
             } else { // check in next block to search
-                uint32_t blocks = xtx->getWatchCurrentBlock();
                 bool failure = false;
 
+                // If the counterparty chain reorganized past blocks we've already
+                // searched, rewind the watch to the fork point. Cursors are checked
+                // newest first, the first matching block hash is the fork point.
+                const auto cursors = xtx->getWatchCursors();
+                bool forkFound = cursors.empty();
+                for (auto it = cursors.rbegin(); it != cursors.rend(); ++it) {
+                    std::string blockHash;
+                    if (it->first <= blockCount) {
+                        if (!connFrom->getBlockHash(it->first, blockHash)) {
+                            failure = true;
+                            break;
+                        }
+                        if (blockHash == it->second) {
+                            forkFound = true;
+                            break;
+                        }
+                    }
+                    xtx->rewindWatchBlock(it->first);
+                }
+                // Reorg is deeper than the retained cursors, search from the start
+                if (!failure && !forkFound)
+                    xtx->rewindWatchBlock(xtx->getWatchStartBlock());
+
+                uint32_t blocks = xtx->getWatchCurrentBlock();
+                const uint32_t firstBlock = blocks;
+
                 // Search all tx in blocks up to current block
-                while (blocks <= blockCount) {
+                while (!failure && blocks <= blockCount) {
                     std::string blockHash;
                     std::vector<std::string> txs;
                     if (!connFrom->getBlockHash(blocks, blockHash)) {
@@ -3408,9 +3437,13 @@ void App::Impl::checkWatchesOnDepositSpends()
                         break;
                     }
                     txids.insert(txids.end(), txs.begin(), txs.end());
-                    xtx->setWatchBlock(++blocks); // mark that we've processed current block
+                    xtx->setWatchCursor(blocks++, blockHash); // mark that we've processed current block
                 }
 
+                // Persist the scan cursors so that a restart resumes from here
+                if (blocks != firstBlock)
+                    app.saveOrders();
+
                 // If any failure, skip
                 if (failure) {
                     xtx->setWatching(false);
@@ -68,6 +68,61 @@ struct PrintErrorCode
     }
 };
 
+//*****************************************************************************
+//*****************************************************************************
+/**
+ * Drops utxo entries that do not exist or are not signed by their address. The
+ * utxos are looked up in one batch and the signatures are verified in process.
+ * Returns the total amount of the remaining entries.
+ */
+static double checkUtxoItems(const std::string & orderId, WalletConnectorPtr conn,
+                             std::vector<wallet::UtxoEntry> & items, const char * func)
+{
+    std::vector<bool> found;
+    if (!conn->getTxOuts(items, found))
+        found.assign(items.size(), false);
+
+    std::vector<wallet::UtxoEntry> existing;
+    for (size_t i = 0; i < items.size(); ++i)
+    {
+        if (found[i])
+        {
+            existing.push_back(items[i]);
+            continue;
+        }
+        UniValue log_obj(UniValue::VOBJ);
+        log_obj.pushKV("orderid", orderId);
+        log_obj.pushKV("utxo_txid", items[i].txId);
+        log_obj.pushKV("utxo_vout", static_cast<int>(items[i].vout));
+        xbridge::LogOrderMsg(log_obj, "bad utxo entry", func);
+    }
+
+    std::vector<bool> valid;
+    conn->verifyUtxoSignatures(existing, valid);
+
+    double commonAmount = 0;
+    items.clear();
+    for (size_t i = 0; i < existing.size(); ++i)
+    {
+        const auto & entry = existing[i];
+        if (!valid[i])
+        {
+            UniValue log_obj(UniValue::VOBJ);
+            log_obj.pushKV("orderid", orderId);
+            log_obj.pushKV("utxo_txid", entry.txId);
+            log_obj.pushKV("utxo_vout", static_cast<int>(entry.vout));
+            xbridge::LogOrderMsg(log_obj, "bad utxo signature", func);
+            continue;
+        }
+
+        commonAmount += entry.amount;
+
+        items.push_back(entry);
+    }
+
+    return commonAmount;
+}
+
 //*****************************************************************************
 //*****************************************************************************
 class Session::Impl
@@ -535,32 +590,11 @@ bool Session::Impl::processTransaction(XBridgePacketPtr packet) const
             entry.signature = std::vector<unsigned char>(packet->data()+offset, packet->data()+offset+XBridgePacket::signatureSize);
             offset += XBridgePacket::signatureSize;
 
-            if (!sconn->getTxOut(entry))
-            {
-                UniValue log_obj(UniValue::VOBJ);
-                log_obj.pushKV("orderid", id.GetHex());
-                log_obj.pushKV("utxo_txid", entry.txId);
-                log_obj.pushKV("utxo_vout", static_cast<int>(entry.vout));
-                xbridge::LogOrderMsg(log_obj, "bad utxo entry", __FUNCTION__);
-                continue;
-            }
-
-            // check signature
-            std::string signature = EncodeBase64(&entry.signature[0], entry.signature.size());
-            if (!sconn->verifyMessage(entry.address, entry.toString(), signature))
-            {
-                UniValue log_obj(UniValue::VOBJ);
-                log_obj.pushKV("orderid", id.GetHex());
-                log_obj.pushKV("utxo_txid", entry.txId);
-                log_obj.pushKV("utxo_vout", static_cast<int>(entry.vout));
-                xbridge::LogOrderMsg(log_obj, "bad utxo signature", __FUNCTION__);
-                continue;
-            }
-
-            commonAmount += entry.amount;
-
             utxoItems.push_back(entry);
         }
+
+        // check utxos and signatures for the whole order at once
+        commonAmount = checkUtxoItems(id.GetHex(), sconn, utxoItems, __FUNCTION__);
     }
 
     if (utxoItems.empty())
@@ -1108,32 +1142,11 @@ bool Session::Impl::processTransactionAccepting(XBridgePacketPtr packet) const
                                                          packet->data()+offset+XBridgePacket::signatureSize);
             offset += XBridgePacket::signatureSize;
 
-            if (!conn->getTxOut(entry))
-            {
-                UniValue log_obj(UniValue::VOBJ);
-                log_obj.pushKV("orderid", id.GetHex());
-                log_obj.pushKV("utxo_txid", entry.txId);
-                log_obj.pushKV("utxo_vout", static_cast<int>(entry.vout));
-                xbridge::LogOrderMsg(log_obj, "bad utxo entry", __FUNCTION__);
-                continue;
-            }
-
-            // check signature
-            std::string signature = EncodeBase64(&entry.signature[0], entry.signature.size());
-            if (!conn->verifyMessage(entry.address, entry.toString(), signature))
-            {
-                UniValue log_obj(UniValue::VOBJ);
-                log_obj.pushKV("orderid", id.GetHex());
-                log_obj.pushKV("utxo_txid", entry.txId);
-                log_obj.pushKV("utxo_vout", static_cast<int>(entry.vout));
-                xbridge::LogOrderMsg(log_obj, "bad utxo signature", __FUNCTION__);
-                continue;
-            }
-
-            commonAmount += entry.amount;
-
             utxoItems.push_back(entry);
         }
+
+        // check utxos and signatures for the whole order at once
+        commonAmount = checkUtxoItems(id.GetHex(), conn, utxoItems, __FUNCTION__);
     }
 
     // Total amount included in taker utxos
@@ -15,6 +15,8 @@
 #include <primitives/transaction.h>
 
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <boost/cstdint.hpp>
 #include <boost/date_time/posix_time/ptime.hpp>
@@ -60,9 +62,14 @@ struct TransactionDescr
         trInvalid
     };
 
-    static const int CURRENT_VERSION=1;
+    static const int CURRENT_VERSION=2;
     int nVersion{CURRENT_VERSION};
 
+    // Maximum number of scanned (height, block hash) pairs retained per order,
+    // this bounds how deep a counterparty chain reorg can be resolved without
+    // rescanning from the watch start block.
+    static const uint32_t MAX_WATCH_CURSORS=20;
+
     ADD_SERIALIZE_METHODS;
 
     template <typename Stream, typename Operation>
@@ -154,6 +161,14 @@ struct TransactionDescr
         READWRITE(logPayTx1);
         READWRITE(logPayTx2);
         READWRITE(parentOrder);
+        if (nVersion >= 2)
+            READWRITE(watchCursors);
+        if (ser_action.ForRead()) {
+            nVersion = CURRENT_VERSION; // upgrade older records on next write
+            // watching only marks a spend check in progress, orders saved while
+            // checking must be picked up by the next check after a restart
+            watching = false;
+        }
     }
 
     void SetNull() {
@@ -210,6 +225,7 @@ struct TransactionDescr
         rawFeeTx.clear();
         watchStartBlock = 0;
         watchCurrentBlock = 0;
+        watchCursors.clear();
         watching = false;
         watchingForSpentDeposit = false;
         watchingDone = false;
@@ -307,6 +323,8 @@ struct TransactionDescr
     // pay tx verification watches
     uint32_t watchStartBlock{0};
     uint32_t watchCurrentBlock{0};
+    // scan cursors (height, block hash) of the most recently searched blocks
+    std::vector<std::pair<uint32_t, std::string>> watchCursors;
     bool     watching{false};
     bool     watchingForSpentDeposit{false};
     bool     watchingDone{false};
@@ -458,6 +476,39 @@ struct TransactionDescr
         return watchCurrentBlock;
     }
 
+    /**
+     * Records that the block at the specified height and hash has been searched
+     * and advances the watch to the next block.
+     * @param block Height of the searched block
+     * @param blockHash Hash of the searched block
+     */
+    void setWatchCursor(const uint32_t block, const std::string & blockHash) {
+        LOCK(_lock);
+        if (watchStartBlock == 0)
+            watchStartBlock = block;
+        watchCurrentBlock = block + 1;
+        watchCursors.emplace_back(block, blockHash);
+        if (watchCursors.size() > MAX_WATCH_CURSORS)
+            watchCursors.erase(watchCursors.begin(), watchCursors.end() - MAX_WATCH_CURSORS);
+    }
+
+    std::vector<std::pair<uint32_t, std::string>> getWatchCursors() {
+        LOCK(_lock);
+        return watchCursors;
+    }
+
+    /**
+     * Rewinds the watch to the specified height, forgetting all cursors at or
+     * above it. Used when the counterparty chain reorganized past searched blocks.
+     * @param block Height of the next block to search
+     */
+    void rewindWatchBlock(const uint32_t block) {
+        LOCK(_lock);
+        watchCurrentBlock = std::max(block, watchStartBlock);
+        while (!watchCursors.empty() && watchCursors.back().first >= watchCurrentBlock)
+            watchCursors.pop_back();
+    }
+
     void setWatching(const bool flag) {
         LOCK(_lock);
         watching = flag;
@@ -743,6 +794,7 @@ private:
         rawFeeTx                     = d.rawFeeTx;
         watchStartBlock              = d.watchStartBlock;
         watchCurrentBlock            = d.watchCurrentBlock;
+        watchCursors                 = d.watchCursors;
         watching                     = d.watching;
         watchingForSpentDeposit      = d.watchingForSpentDeposit;
         watchingDone                 = d.watchingDone;
@@ -154,6 +154,7 @@ public:
         jsonver                     = other.jsonver;
         contenttype                 = other.contenttype;
         cashAddrPrefix              = other.cashAddrPrefix;
+        messageMagic                = other.messageMagic;
 
         mediantime                  = other.mediantime; // useful for fork management
 
@@ -211,6 +212,8 @@ public:
     int64_t                      mediantime{0};
     // cash address prefix
     std::string                  cashAddrPrefix;
+    // signed message header, used to verify utxo signatures locally
+    std::string                  messageMagic;
 };
 
 } // namespace xbridge
@@ -9,6 +9,9 @@
 #include <xbridge/util/logger.h>
 
 #include <base58.h>
+#include <hash.h>
+#include <pubkey.h>
+#include <util/strencodings.h>
 
 //*****************************************************************************
 //*****************************************************************************
@@ -87,4 +90,56 @@ std::string WalletConnector::getNewTokenAddress()
     return newaddress;
 }
 
+/**
+ * \brief Look up several utxos, the default implementation calls getTxOut for each entry.
+ */
+bool WalletConnector::getTxOuts(std::vector<wallet::UtxoEntry> & entries, std::vector<bool> & found)
+{
+    found.assign(entries.size(), false);
+    for (size_t i = 0; i < entries.size(); ++i)
+        found[i] = getTxOut(entries[i]);
+    return true;
+}
+
+/**
+ * \brief Check a utxo signature in process, without the wallet.
+ */
+bool WalletConnector::checkUtxoSignature(const wallet::UtxoEntry & entry, const std::string & messageMagic)
+{
+    if (entry.rawAddress.size() != CKeyID().size() || entry.signature.empty())
+        return false;
+
+    CHashWriter ss(SER_GETHASH, 0);
+    ss << messageMagic;
+    ss << entry.toString();
+
+    CPubKey pubkey;
+    return pubkey.RecoverCompact(ss.GetHash(), entry.signature) &&
+           std::equal(entry.rawAddress.begin(), entry.rawAddress.end(), pubkey.GetID().begin());
+}
+
+/**
+ * \brief Verify the utxo signatures of an order without a wallet round trip per entry.
+ */
+void WalletConnector::verifyUtxoSignatures(const std::vector<wallet::UtxoEntry> & entries, std::vector<bool> & valid)
+{
+    valid.assign(entries.size(), false);
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        const auto & entry = entries[i];
+        if (entry.rawAddress.size() != CKeyID().size() || entry.signature.empty())
+            continue;
+
+        if (checkUtxoSignature(entry, messageMagic))
+        {
+            valid[i] = true;
+            continue;
+        }
+
+        // The configured message magic may not match the wallet's, let the wallet decide
+        const std::string signature = EncodeBase64(&entry.signature[0], entry.signature.size());
+        valid[i] = verifyMessage(entry.address, entry.toString(), signature);
+    }
+}
+
 } // namespace xbridge
@@ -102,6 +102,14 @@ public:
 
     virtual bool getTxOut(wallet::UtxoEntry & entry) = 0;
 
+    /**
+     * @brief Looks up the amounts and confirmations of several utxos.
+     * @param entries utxos to look up, found entries are updated in place
+     * @param found set to true at the index of each utxo that exists
+     * @return false if the lookup could not be made
+     */
+    virtual bool getTxOuts(std::vector<wallet::UtxoEntry> & entries, std::vector<bool> & found);
+
     virtual bool sendRawTransaction(const std::string & rawtx,
                                     std::string & txid,
                                     int32_t & errorCode,
@@ -110,6 +118,23 @@ public:
     virtual bool signMessage(const std::string & address, const std::string & message, std::string & signature) = 0;
     virtual bool verifyMessage(const std::string & address, const std::string & message, const std::string & signature) = 0;
 
+    /**
+     * @brief Verifies the utxo ownership signatures of several entries. Compact signatures are
+     * checked in process against the entry's raw address using this currency's message magic,
+     * entries that fail are checked again with the wallet's verifymessage.
+     * @param entries utxos with rawAddress and signature set
+     * @param valid set to true at the index of each entry with a valid signature
+     */
+    void verifyUtxoSignatures(const std::vector<wallet::UtxoEntry> & entries, std::vector<bool> & valid);
+
+    /**
+     * @brief Checks a compact utxo signature against the entry's raw address.
+     * @param entry utxo with rawAddress and signature set
+     * @param messageMagic signed message header including the trailing newline
+     * @return true if the signature was made by the address for this utxo and message magic
+     */
+    static bool checkUtxoSignature(const wallet::UtxoEntry & entry, const std::string & messageMagic);
+
     virtual bool getRawMempool(std::vector<std::string> & txids) = 0;
 
     virtual bool getBlockCount(uint32_t & blockCount) = 0;
@@ -654,6 +654,42 @@ bool lockUnspent(const std::string & rpcuser,
     return true;
 }
 
+//*****************************************************************************
+//*****************************************************************************
+static bool parseTxOut(const Object & reply, wallet::UtxoEntry & txout)
+{
+    // Parse reply
+    const Value & result = find_value(reply, "result");
+    const Value & error  = find_value(reply, "error");
+
+    if (error.type() != null_type)
+    {
+        // Error
+        LOG() << "error: " << write_string(error, false);
+        // int code = find_value(error.get_obj(), "code").get_int();
+        return false;
+    }
+    else if (result.type() != obj_type)
+    {
+        // Result
+        LOG() << "result not an object " <<
+                 (result.type() == null_type ? "" :
+                  result.type() == str_type  ? result.get_str() :
+                                               write_string(result, true));
+        return false;
+    }
+
+    Object o = result.get_obj();
+    txout.amount = find_value(o, "value").get_real();
+
+    // Assign confirmations
+    const auto & rconfs = find_value(o, "confirmations");
+    if (rconfs.type() == int_type)
+        txout.setConfirmations(rconfs.get_int());
+
+    return true;
+}
+
 //*****************************************************************************
 //*****************************************************************************
 bool gettxout(const std::string & rpcuser,
@@ -673,38 +709,51 @@ bool gettxout(const std::string & rpcuser,
         params.push_back(static_cast<int>(txout.vout));
         Object reply = CallRPC(rpcuser, rpcpasswd, rpcip, rpcport, "gettxout", params);
 
-        // Parse reply
-        const Value & result = find_value(reply, "result");
-        const Value & error  = find_value(reply, "error");
+        return parseTxOut(reply, txout);
+    }
+    catch (std::exception & e)
+    {
+        LOG() << "gettxout exception " << e.what();
+        return false;
+    }
 
-        if (error.type() != null_type)
-        {
-            // Error
-            LOG() << "error: " << write_string(error, false);
-            // int code = find_value(error.get_obj(), "code").get_int();
-            return false;
-        }
-        else if (result.type() != obj_type)
+    return true;
+}
+
+//*****************************************************************************
+//*****************************************************************************
+bool gettxouts(const std::string & rpcuser,
+               const std::string & rpcpasswd,
+               const std::string & rpcip,
+               const std::string & rpcport,
+               std::vector<wallet::UtxoEntry> & txouts,
+               std::vector<bool> & found)
+{
+    found.assign(txouts.size(), false);
+    if (txouts.empty())
+        return true;
+
+    try
+    {
+        LOG() << "rpc call <gettxout> batch of " << txouts.size();
+
+        std::vector<Array> params;
+        for (auto & txout : txouts)
         {
-            // Result
-            LOG() << "result not an object " <<
-                     (result.type() == null_type ? "" :
-                      result.type() == str_type  ? result.get_str() :
-                                                   write_string(result, true));
-            return false;
+            txout.amount = 0;
+            Array p;
+            p.push_back(txout.txId);
+            p.push_back(static_cast<int>(txout.vout));
+            params.push_back(p);
         }
+        const auto replies = CallRPCBatch(rpcuser, rpcpasswd, rpcip, rpcport, "gettxout", params);
 
-        Object o = result.get_obj();
-        txout.amount = find_value(o, "value").get_real();
-
-        // Assign confirmations
-        const auto & rconfs = find_value(o, "confirmations");
-        if (rconfs.type() == int_type)
-            txout.setConfirmations(rconfs.get_int());
+        for (size_t i = 0; i < txouts.size(); ++i)
+            found[i] = parseTxOut(replies[i], txouts[i]);
     }
     catch (std::exception & e)
     {
-        LOG() << "gettxout exception " << e.what();
+        LOG() << "gettxout batch exception " << e.what();
         return false;
     }
 
@@ -1671,6 +1720,20 @@ bool BtcWalletConnector<CryptoProvider>::getTxOut(wallet::UtxoEntry & entry)
     return true;
 }
 
+//******************************************************************************
+//******************************************************************************
+template <class CryptoProvider>
+bool BtcWalletConnector<CryptoProvider>::getTxOuts(std::vector<wallet::UtxoEntry> & entries, std::vector<bool> & found)
+{
+    if (!rpc::gettxouts(m_user, m_passwd, m_ip, m_port, entries, found))
+    {
+        LOG() << "batch gettxout failed, trying single calls " << __FUNCTION__;
+        return WalletConnector::getTxOuts(entries, found);
+    }
+
+    return true;
+}
+
 //******************************************************************************
 //******************************************************************************
 template <class CryptoProvider>
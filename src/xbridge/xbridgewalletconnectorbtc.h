@@ -108,10 +108,9 @@ static UniValue XBridgeJSONRPCRequestObj(const std::string& strMethod, const Uni
     return request;
 }
 
-static json_spirit::Object CallRPC(const std::string & rpcuser, const std::string & rpcpasswd,
+static json_spirit::Value CallRPCRequest(const std::string & rpcuser, const std::string & rpcpasswd,
                       const std::string & rpcip, const std::string & rpcport,
-                      const std::string & strMethod, const json_spirit::Array & params,
-                      const std::string & jsonver="", const std::string & contenttype="")
+                      const std::string & strRequest, const std::string & contenttype="")
 {
     const std::string & host = rpcip;
     const int port = boost::lexical_cast<int>(rpcport);
@@ -145,12 +144,6 @@ static json_spirit::Object CallRPC(const std::string & rpcuser, const std::strin
     }
 
     // Attach request data
-    const auto tostring = json_spirit::write_string(json_spirit::Value(params), json_spirit::none, 8);
-    UniValue toval;
-    if (!toval.read(tostring))
-        throw std::runtime_error(strprintf("failed to decode json_spirit data: %s", tostring));
-    const auto reqobj = XBridgeJSONRPCRequestObj(strMethod, toval.get_array(), 1, jsonver);
-    std::string strRequest = reqobj.write() + "\n";
     struct evbuffer* output_buffer = evhttp_request_get_output_buffer(req.get());
     assert(output_buffer);
     evbuffer_add(output_buffer, strRequest.data(), strRequest.size());
@@ -182,6 +175,29 @@ static json_spirit::Object CallRPC(const std::string & rpcuser, const std::strin
     json_spirit::Value valReply;
     if (!json_spirit::read_string(response.body, valReply))
         throw std::runtime_error("couldn't parse reply from server");
+    return valReply;
+}
+
+static UniValue XBridgeJSONRPCParams(const json_spirit::Array & params)
+{
+    const auto tostring = json_spirit::write_string(json_spirit::Value(params), json_spirit::none, 8);
+    UniValue toval;
+    if (!toval.read(tostring))
+        throw std::runtime_error(strprintf("failed to decode json_spirit data: %s", tostring));
+    return toval.get_array();
+}
+
+static json_spirit::Object CallRPC(const std::string & rpcuser, const std::string & rpcpasswd,
+                      const std::string & rpcip, const std::string & rpcport,
+                      const std::string & strMethod, const json_spirit::Array & params,
+                      const std::string & jsonver="", const std::string & contenttype="")
+{
+    const auto reqobj = XBridgeJSONRPCRequestObj(strMethod, XBridgeJSONRPCParams(params), 1, jsonver);
+    std::string strRequest = reqobj.write() + "\n";
+
+    const json_spirit::Value valReply = CallRPCRequest(rpcuser, rpcpasswd, rpcip, rpcport, strRequest, contenttype);
+    if (valReply.type() != json_spirit::obj_type)
+        throw std::runtime_error("expected reply to have result, error and id properties");
     const json_spirit::Object& reply = valReply.get_obj();
     if (reply.empty())
         throw std::runtime_error("expected reply to have result, error and id properties");
@@ -189,6 +205,37 @@ static json_spirit::Object CallRPC(const std::string & rpcuser, const std::strin
     return reply;
 }
 
+/**
+ * Sends several calls of the same method in one JSON-RPC batch request. Replies are
+ * returned in request order, matched on the request id.
+ */
+static std::vector<json_spirit::Object> CallRPCBatch(const std::string & rpcuser, const std::string & rpcpasswd,
+                      const std::string & rpcip, const std::string & rpcport,
+                      const std::string & strMethod, const std::vector<json_spirit::Array> & params,
+                      const std::string & jsonver="", const std::string & contenttype="")
+{
+    UniValue batch(UniValue::VARR);
+    for (size_t i = 0; i < params.size(); ++i)
+        batch.push_back(XBridgeJSONRPCRequestObj(strMethod, XBridgeJSONRPCParams(params[i]), static_cast<int>(i), jsonver));
+    std::string strRequest = batch.write() + "\n";
+
+    const json_spirit::Value valReply = CallRPCRequest(rpcuser, rpcpasswd, rpcip, rpcport, strRequest, contenttype);
+    if (valReply.type() != json_spirit::array_type)
+        throw std::runtime_error("batch request not supported by server");
+
+    std::vector<json_spirit::Object> replies(params.size());
+    for (const auto & item : valReply.get_array()) {
+        if (item.type() != json_spirit::obj_type)
+            throw std::runtime_error("expected batch reply to contain objects");
+        const auto & id = json_spirit::find_value(item.get_obj(), "id");
+        if (id.type() != json_spirit::int_type || id.get_int() < 0 || id.get_int() >= static_cast<int>(params.size()))
+            throw std::runtime_error("unexpected id in batch reply");
+        replies[id.get_int()] = item.get_obj();
+    }
+
+    return replies;
+}
+
 //*****************************************************************************
 //*****************************************************************************
 template <class CryptoProvider>
@@ -216,6 +263,7 @@ public:
     bool getNewAddress(std::string & addr);
 
     bool getTxOut(wallet::UtxoEntry & entry);
+    bool getTxOuts(std::vector<wallet::UtxoEntry> & entries, std::vector<bool> & found) override;
 
     bool sendRawTransaction(const std::string & rawtx,
                             std::string & txid,
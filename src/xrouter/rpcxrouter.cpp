@@ -1257,6 +1257,156 @@ static UniValue xrGetReply(const JSONRPCRequest& request)
     return reply;
 }
 
+static UniValue xrSubmitQuery(const JSONRPCRequest& request)
+{
+    if (request.fHelp)
+        throw std::runtime_error(
+            RPCHelpMan{"xrSubmitQuery",
+                "\nSubmit an XRouter call without waiting for the responses. The call returns "
+                "immediately with a uuid, use xrGetQueryResult to check whether the result has "
+                "arrived. Any number of queries can be in flight at the same time.\n",
+                {
+                    {"command", RPCArg::Type::STR, RPCArg::Optional::NO, "The XRouter call, e.g. xrGetBlockCount, xrGetBlockHash, xrGetBlock, "
+                                                                         "xrGetBlocks, xrGetTransaction, xrGetTransactions, xrDecodeRawTransaction, "
+                                                                         "xrSendTransaction, xrGetBalance (BLOCK on nodes running -addressindex) or xrService."},
+                    {"service", RPCArg::Type::STR, RPCArg::Optional::NO, "The blockchain ticker (BTC, LTC, SYS, etc.) or, for xrService, the service name."},
+                    {"node_count", RPCArg::Type::NUM, RPCArg::Optional::NO, "Number of XRouter nodes to query. Use 0 for the consensus= setting in xrouter.conf."},
+                    {"parameters", RPCArg::Type::STR, RPCArg::Optional::OMITTED, "Parameters passed to the call."},
+                },
+                RPCResult{
+                R"(
+    {
+      "status": "pending",
+      "uuid": "54b6ec00-8b06-4c2c-9e56-acdff4da69fe"
+    }
+
+    Key          | Type | Description
+    -------------|------|--------------------------------------------------------
+    status       | str  | "pending" if the query was sent, "complete" if it
+                 |      | failed before being sent.
+    uuid         | str  | The query ID, use with xrGetQueryResult.
+                )"
+                },
+                RPCExamples{
+                    HelpExampleCli("xrSubmitQuery", "xrGetBlockCount BLOCK 2")
+                  + HelpExampleRpc("xrSubmitQuery", "\"xrGetBlockCount\", \"BLOCK\", 2")
+                  + HelpExampleCli("xrSubmitQuery", "xrService xrs::BTCgetbestblockhash 1")
+                  + HelpExampleRpc("xrSubmitQuery", "\"xrService\", \"xrs::BTCgetbestblockhash\", 1")
+                },
+            }.ToString());
+
+    if (request.params.size() < 3) {
+        UniValue error(UniValue::VOBJ);
+        error.pushKV("error", "command, service and node_count must be specified");
+        error.pushKV("code", xrouter::INVALID_PARAMETERS);
+        return error;
+    }
+
+    const auto & commandStr = request.params[0].get_str();
+    const auto command = commandStr == "xrService" ? xrouter::xrService
+                                                   : xrouter::XRouterCommand_FromString(commandStr);
+    switch (command) {
+        case xrouter::xrGetBlockCount:
+        case xrouter::xrGetBlockHash:
+        case xrouter::xrGetBlock:
+        case xrouter::xrGetBlocks:
+        case xrouter::xrGetTransaction:
+        case xrouter::xrGetTransactions:
+        case xrouter::xrDecodeRawTransaction:
+        case xrouter::xrSendTransaction:
+        case xrouter::xrGetBalance:
+        case xrouter::xrService:
+            break;
+        default: {
+            UniValue error(UniValue::VOBJ);
+            error.pushKV("error", "Unsupported command " + commandStr);
+            error.pushKV("code", xrouter::INVALID_PARAMETERS);
+            return error;
+        }
+    }
+
+    const auto & service = request.params[1].get_str();
+    const auto & consensus = request.params[2].get_int();
+    if (consensus < 0 || consensus > XROUTER_MAX_CONNECTION_COUNT) {
+        UniValue error(UniValue::VOBJ);
+        error.pushKV("error", "node_count must be an integer between 0 and " + std::to_string(XROUTER_MAX_CONNECTION_COUNT));
+        error.pushKV("code", xrouter::INVALID_PARAMETERS);
+        return error;
+    }
+
+    auto uv = UniValue(UniValue::VARR);
+    for (unsigned int i = 3; i < request.params.size(); i++)
+        uv.push_back(request.params[i].get_str());
+
+    std::string uuid;
+    auto result = xrouter::App::instance().xrouterCallAsync(command, uuid, service, consensus, uv);
+    const bool complete = result.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+
+    UniValue o(UniValue::VOBJ);
+    o.pushKV("status", complete ? "complete" : "pending");
+    o.pushKV("uuid", uuid);
+    return o;
+}
+
+static UniValue xrGetQueryResult(const JSONRPCRequest& request)
+{
+    if (request.fHelp)
+        throw std::runtime_error(
+            RPCHelpMan{"xrGetQueryResult",
+                "\nReturns the result of a call submitted with xrSubmitQuery without blocking. "
+                "Results are kept for 10 minutes after the query completes. Use xrGetReply "
+                "to view each node's individual response.\n",
+                {
+                    {"uuid", RPCArg::Type::STR, RPCArg::Optional::NO, "Query ID returned by xrSubmitQuery."},
+                },
+                RPCResult{
+                R"(
+    {
+      "status": "complete",
+      "reply": 1217428,
+      "uuid": "54b6ec00-8b06-4c2c-9e56-acdff4da69fe"
+    }
+
+    Key          | Type | Description
+    -------------|------|--------------------------------------------------------
+    status       | str  | "pending" while waiting on service nodes, otherwise
+                 |      | "complete".
+    reply        | any  | The most common reply, only present when complete.
+    uuid         | str  | The query ID.
+                )"
+                },
+                RPCExamples{
+                    HelpExampleCli("xrGetQueryResult", "54b6ec00-8b06-4c2c-9e56-acdff4da69fe")
+                  + HelpExampleRpc("xrGetQueryResult", "\"54b6ec00-8b06-4c2c-9e56-acdff4da69fe\"")
+                },
+            }.ToString());
+
+    if (request.params.empty()) {
+        UniValue error(UniValue::VOBJ);
+        error.pushKV("error", "Please specify the uuid");
+        error.pushKV("code", xrouter::INVALID_PARAMETERS);
+        return error;
+    }
+
+    const std::string & uuid = request.params[0].get_str();
+    bool complete{false};
+    std::string reply;
+    if (!xrouter::App::instance().queryResult(uuid, complete, reply)) {
+        UniValue error(UniValue::VOBJ);
+        error.pushKV("error", "No query found with uuid " + uuid);
+        error.pushKV("code", xrouter::NO_REPLIES);
+        error.pushKV("uuid", uuid);
+        return error;
+    }
+
+    UniValue o(UniValue::VOBJ);
+    o.pushKV("status", complete ? "complete" : "pending");
+    if (complete)
+        o.pushKV("reply", uret_xr(reply));
+    o.pushKV("uuid", uuid);
+    return o;
+}
+
 static UniValue xrShowConfigs(const JSONRPCRequest& request)
 {
     if (request.fHelp)
@@ -1353,6 +1503,8 @@ static UniValue xrStatus(const JSONRPCRequest& request)
                  |      | true: Client is a Service Node.
                  |      | false: Client is not a Service Node.
     config       | str  | The raw text contents of your xrouter.conf.
+    latency      | obj  | Response times of the service nodes you queried, by
+                 |      | service, see xrConnectedNodes.
                 )"
                 },
                 RPCExamples{
@@ -1384,6 +1536,12 @@ static UniValue xrConnectedNodes(const JSONRPCRequest& request)
                    |       | score of -200 will ban the node for a 24hr period.
                    |       | You can change the ban threshold with the
                    |       | xrouterbanscore setting in blocknet.conf.
+    latency        | obj   | Response times of the node for each service you
+                   |       | queried it for, in milliseconds. Contains "ewma"
+                   |       | (moving average), "p50", "p90" and "p99" of recent
+                   |       | replies, the "replies", "errors" and "timeouts"
+                   |       | counts, and the "timeoutrate". Nodes with lower
+                   |       | response times are preferred at equal fees.
     banned         | bool  | Signifies if the node is currently banned.
                    |       | true: Node is banned
                    |       | false: Node is not banned
@@ -1842,6 +2000,7 @@ static const CRPCCommand commands[] =
     { "xrouter",      "xrConnectedNodes",                &xrConnectedNodes,               {} },
     // { "xrouter",      "xrGenerateBloomFilter",           &xrGenerateBloomFilter,          {} },
     { "xrouter",      "xrGetNetworkServices",            &xrGetNetworkServices,           {} },
+    { "xrouter",      "xrGetQueryResult",                &xrGetQueryResult,               {} },
     { "xrouter",      "xrGetReply",                      &xrGetReply,                     {} },
     // { "xrouter",      "xrGetTxBloomFilter",              &xrGetTxBloomFilter,             {} },
     { "xrouter",      "xrReloadConfigs",                 &xrReloadConfigs,                {} },
@@ -1849,6 +2008,7 @@ static const CRPCCommand commands[] =
     { "xrouter",      "xrServiceConsensus",              &xrServiceConsensus,             {} },
     { "xrouter",      "xrShowConfigs",                   &xrShowConfigs,                  {} },
     { "xrouter",      "xrStatus",                        &xrStatus,                       {} },
+    { "xrouter",      "xrSubmitQuery",                   &xrSubmitQuery,                  {} },
     { "xrouter",      "xrUpdateNetworkServices",         &xrUpdateNetworkServices,        {} },
     // { "xrouter",      "xrTest",                          &xrTest,                         {} },
 };
@@ -163,6 +163,17 @@ bool App::start()
     } else if (!initKeyPair()) // init on regular xrouter clients (non-snodes)
         return false;
 
+    // Replies to async queries are collected on a dedicated completion thread
+    if (ioservices.empty()) {
+        auto ios = std::make_shared<boost::asio::io_service>();
+        ioworkers.push_back(std::make_shared<boost::asio::io_service::work>(*ios));
+        ioservices.push_back(ios);
+        requestHandlers.create_thread([ios]() {
+            RenameThread("blocknet-xrquery");
+            ios->run();
+        });
+    }
+
     {
         LOCK(mu);
         xrouterIsReady = true;
@@ -429,6 +440,7 @@ bool App::openConnections(enum XRouterCommand command, const std::string & servi
     exrSnodes.clear();
     std::map<NodeAddr, sn::ServiceNode> needConnectionsHaveConfigs;
     auto configs = getConfigs();
+    const auto candidates = getCandidates(command, service);
     for (const auto & item : configs) {
         const auto & snodeAddr = item.first;
         auto config = item.second;
@@ -440,7 +452,9 @@ bool App::openConnections(enum XRouterCommand command, const std::string & servi
         auto & s = snodec[snodeAddr];
 
         // only connect if snode is in the list, it has the specified plugin or it is an SPV node with the specified wallet
-        if (s.isEXRCompatible() && snodeMatchesCriteria(s, config.first, command, service, parameterCount))
+        auto candidate = candidates.find(snodeAddr);
+        if (s.isEXRCompatible() && candidate != candidates.end()
+            && snodeMatchesCriteria(s, candidate->second, command, service, parameterCount))
             exrSnodes.push_back(s);
         else if (config.first->hasPlugin(service) || (config.second == sn::ServiceNode::SPV && config.first->hasWallet(service))) {
             if (!nodec.count(snodeAddr) && !connectedSnodes.count(snodeAddr)) // if not connected then proceed
@@ -592,9 +606,24 @@ bool App::stop(const bool safeCleanup)
     if (safeCleanup && (!isEnabled() || !isReady()))
         return false;
 
+    // complete any queries still waiting on replies
+    std::vector<PendingQueryPtr> queries;
+    {
+        LOCK(mqueries);
+        for (auto & item : pendingQueries)
+            queries.push_back(item.second);
+    }
+    for (auto & query : queries)
+        completeQuery(query);
+
     // shutdown threads
+    ioworkers.clear();
+    for (auto & ios : ioservices)
+        ios->stop();
     requestHandlers.interrupt_all();
     requestHandlers.join_all();
+    // stopped io services can't be run again, start() creates new ones
+    ioservices.clear();
 
     if (server && !server->stop())
         return false;
@@ -602,7 +631,7 @@ bool App::stop(const bool safeCleanup)
     return true;
 }
 
-bool App::snodeMatchesCriteria(const sn::ServiceNode & snode, xrouter::XRouterSettingsPtr settings,
+bool App::snodeMatchesCriteria(const sn::ServiceNode & snode, const ServiceCandidate & candidate,
         enum XRouterCommand command, const std::string & service, const int & parameterCount)
 {
     // fully qualified command e.g. xr::ServiceName
@@ -610,10 +639,6 @@ bool App::snodeMatchesCriteria(const sn::ServiceNode & snode, xrouter::XRouterSe
     const auto & fqCmd = (command == xrService) ? pluginCommandKey(service) // plugin
                                                 : walletCommandKey(service, commandStr); // spv wallet
 
-    if (command != xrService && !settings->hasWallet(service))
-        return false;
-    if (!settings->isAvailableCommand(command, service))
-        return false;
     if (!snode.running()) // skip if not running
         return false;
     if (!snode.hasService(command == xrService ? fqCmd : walletCommandKey(service))) // use top-level wallet key (e.g. xr::BLOCK)
@@ -621,29 +646,23 @@ bool App::snodeMatchesCriteria(const sn::ServiceNode & snode, xrouter::XRouterSe
 
     // Only select nodes with a fee smaller than the max fee we're willing to pay
     auto maxfee = xrsettings->maxFee(command, service);
-    auto fee = settings->commandFee(command, service);
+    auto fee = candidate.fee;
     if (fee > 0) {
-        if (fee > maxfee) {
-            const auto & snodeAddr = EncodeDestination(CTxDestination(snode.getPaymentAddress()));
+        if (fee > maxfee)
             return false;
-        }
-        if (!xbridge::CanAffordFeePayment(fee * COIN)) {
-            const auto & snodeAddr = EncodeDestination(CTxDestination(snode.getPaymentAddress()));
+        if (!xbridge::CanAffordFeePayment(fee * COIN))
             return false;
-        }
     }
 
     // Only select nodes who's fetch limit is acceptable
-    const auto & fetchLimit = settings->commandFetchLimit(command, service);
-    if (parameterCount > fetchLimit) {
+    if (parameterCount > candidate.fetchLimit) {
         const auto & snodeAddr = EncodeDestination(CTxDestination(snode.getPaymentAddress()));
-        LOG() << "Skipping node " << snodeAddr << " because its fetch limit " << fetchLimit << " is lower than "
+        LOG() << "Skipping node " << snodeAddr << " because its fetch limit " << candidate.fetchLimit << " is lower than "
               << parameterCount;
         return false;
     }
 
-    auto rateLimit = settings->clientRequestLimit(command, service);
-    if (queryMgr.rateLimitExceeded(snode.getHostPort(), fqCmd, queryMgr.getLastRequest(snode.getHostPort(), fqCmd), rateLimit)) {
+    if (queryMgr.rateLimitExceeded(snode.getHostPort(), fqCmd, queryMgr.getLastRequest(snode.getHostPort(), fqCmd), candidate.rateLimit)) {
         const auto & snodeAddr = EncodeDestination(CTxDestination(snode.getPaymentAddress()));
         LOG() << "Skipping node " << snodeAddr << " because not enough time passed since the last call";
         return false;
@@ -659,8 +678,9 @@ std::vector<CNode*> App::availableNodesRetained(enum XRouterCommand command, con
 {
     std::vector<CNode*> selectedNodes;
 
-    auto sconfigs = getConfigs();
-    if (sconfigs.empty())
+    // Only snodes whose configs support the command/service are considered
+    const auto candidates = getCandidates(command, service);
+    if (candidates.empty())
         return selectedNodes; // don't have any configs, return
 
     std::vector<sn::ServiceNode> snodes;
@@ -672,77 +692,71 @@ std::vector<CNode*> App::availableNodesRetained(enum XRouterCommand command, con
     // Max fee we're willing to pay to snodes
     auto maxfee = xrsettings->maxFee(command, service);
 
-    // Look through known xrouter node configs and select those that support command/service/fees
-    for (const auto & item : sconfigs) {
-        const auto & nodeAddr = item.first;
-        auto settings = item.second.first;
+    // fully qualified command e.g. xr::ServiceName
+    const auto & commandStr = XRouterCommand_ToString(command);
+    const auto & fqCmd = (command == xrService) ? pluginCommandKey(service) // plugin
+                                                : walletCommandKey(service, commandStr); // spv wallet
+    const auto & snodeService = command == xrService ? fqCmd : walletCommandKey(service); // use top-level wallet key (e.g. xr::BLOCK)
 
-        // fully qualified command e.g. xr::ServiceName
-        const auto & commandStr = XRouterCommand_ToString(command);
-        const auto & fqCmd = (command == xrService) ? pluginCommandKey(service) // plugin
-                                                    : walletCommandKey(service, commandStr); // spv wallet
+    // Look through the candidate snodes and select those that are connected and meet our fee limits
+    std::map<CNode*, double> fees;
+    for (const auto & item : candidates) {
+        const auto & nodeAddr = item.first;
+        const auto & candidate = item.second;
 
-        if (command != xrService && !settings->hasWallet(service))
-            continue;
-        if (!settings->isAvailableCommand(command, service))
+        auto sit = snodec.find(nodeAddr);
+        if (sit == snodec.end()) // Ignore if not a snode
             continue;
-        if (!snodec.count(nodeAddr)) // Ignore if not a snode
-            continue;
-        if (snodec[nodeAddr].isEXRCompatible())
+        const auto & snode = sit->second;
+        if (snode.isEXRCompatible())
             continue; // skip exr compatible snodes, they're handled elsewhere
-        if (!snodec[nodeAddr].running()) // skip if not running
+        if (!snode.running()) // skip if not running
             continue;
-        if (!snodec[nodeAddr].hasService(command == xrService ? fqCmd : walletCommandKey(service))) // use top-level wallet key (e.g. xr::BLOCK)
+        if (!snode.hasService(snodeService))
             continue; // Ignore snodes that don't have the service
 
-        // This is the node whose config we are looking at now
-        CNode *node = nullptr;
-        if (nodec.count(nodeAddr))
-            node = nodec[nodeAddr];
-
         // If the service node is not among peers
-        if (!node)
+        auto nit = nodec.find(nodeAddr);
+        if (nit == nodec.end() || !nit->second)
             continue; // skip
+        CNode *node = nit->second;
 
         // Only select nodes with a fee smaller than the max fee we're willing to pay
-        auto fee = settings->commandFee(command, service);
+        const auto fee = candidate.fee;
         if (fee > 0) {
             if (fee > maxfee) {
-                const auto & snodeAddr = EncodeDestination(CTxDestination(snodec[nodeAddr].getPaymentAddress()));
+                const auto & snodeAddr = EncodeDestination(CTxDestination(snode.getPaymentAddress()));
                 LOG() << "Skipping node " << snodeAddr << " because its fee " << fee << " is higher than maxfee " << maxfee;
                 continue;
             }
             if (!xbridge::CanAffordFeePayment(fee * COIN)) {
-                const auto & snodeAddr = EncodeDestination(CTxDestination(snodec[nodeAddr].getPaymentAddress()));
+                const auto & snodeAddr = EncodeDestination(CTxDestination(snode.getPaymentAddress()));
                 LOG() << "Skipping node " << snodeAddr << " because there's not enough utxos to cover payment " << fee;
                 continue;
             }
         }
 
         // Only select nodes who's fetch limit is acceptable
-        const auto & fetchLimit = settings->commandFetchLimit(command, service);
-        if (parameterCount > fetchLimit) {
-            const auto & snodeAddr = EncodeDestination(CTxDestination(snodec[nodeAddr].getPaymentAddress()));
-            LOG() << "Skipping node " << snodeAddr << " because its fetch limit " << fetchLimit << " is lower than "
+        if (parameterCount > candidate.fetchLimit) {
+            const auto & snodeAddr = EncodeDestination(CTxDestination(snode.getPaymentAddress()));
+            LOG() << "Skipping node " << snodeAddr << " because its fetch limit " << candidate.fetchLimit << " is lower than "
                   << parameterCount;
             continue;
         }
 
-        auto rateLimit = settings->clientRequestLimit(command, service);
-        if (queryMgr.rateLimitExceeded(nodeAddr, fqCmd, queryMgr.getLastRequest(nodeAddr, fqCmd), rateLimit)) {
-            const auto & snodeAddr = EncodeDestination(CTxDestination(snodec[nodeAddr].getPaymentAddress()));
+        if (queryMgr.rateLimitExceeded(nodeAddr, fqCmd, queryMgr.getLastRequest(nodeAddr, fqCmd), candidate.rateLimit)) {
+            const auto & snodeAddr = EncodeDestination(CTxDestination(snode.getPaymentAddress()));
             LOG() << "Skipping node " << snodeAddr << " because not enough time passed since the last call";
             continue;
         }
         
         selectedNodes.push_back(node);
+        fees[node] = fee;
     }
 
     // Sort selected nodes descending by score and lowest price first
-    std::sort(selectedNodes.begin(), selectedNodes.end(), [this,command,service](const CNode *a, const CNode *b) {
-        const auto & a_addr = a->GetAddrName();
-        const auto & b_addr = b->GetAddrName();
-        return bestNode(a_addr, b_addr, command, service);
+    std::sort(selectedNodes.begin(), selectedNodes.end(), [this,&fees,command,service](CNode *a, CNode *b) {
+        return bestNode(a->GetAddrName(), b->GetAddrName(), fees[a], fees[b], command, service);
     });
 
     // Retain selected nodes
@@ -801,7 +815,9 @@ bool App::processReply(CNode *node, XRouterPacketPtr packet, CValidationState &
     const auto & nodeAddr = node->GetAddrName();
 
     // Do not process if we aren't expecting a result. Also prevent reply malleability (only first reply is accepted)
-    if (!queryMgr.hasQuery(uuid, nodeAddr) || queryMgr.hasReply(uuid, nodeAddr))
+    // Replies to queries that completed without them are only timed.
+    const bool late = queryMgr.hasLateQuery(uuid, nodeAddr);
+    if (!late && (!queryMgr.hasQuery(uuid, nodeAddr) || queryMgr.hasReply(uuid, nodeAddr)))
         return false; // done, nothing found
 
     // Verify servicenode response
@@ -815,9 +831,16 @@ bool App::processReply(CNode *node, XRouterPacketPtr packet, CValidationState &
     std::string reply((const char *)packet->data()+offset);
     offset += reply.size() + 1;
 
+    if (late) {
+        queryMgr.addLateReply(uuid, nodeAddr, reply);
+        LOG() << "Received late reply to query " << uuid << " from node " << nodeAddr;
+        return true;
+    }
+
     // Store the reply
     queryMgr.addReply(uuid, nodeAddr, reply);
     queryMgr.purge(uuid, nodeAddr);
+    onQueryReply(uuid);
 
     LOG() << "Received reply to query " << uuid << "\n" << reply;
 
@@ -902,6 +925,13 @@ bool App::processConfigMessage(const sn::ServiceNode & snode) {
         return false; // do not process own config
 
     const auto & rawconfig = snode.getConfig("xrouter");
+    // Most pings carry the same config as the last one, skip parsing it again
+    CHashWriter hw(SER_GETHASH, 0);
+    hw << rawconfig << static_cast<uint8_t>(snode.getTier());
+    const auto configHash = hw.GetHash();
+    if (hasConfigHash(snode, configHash))
+        return true;
+
     UniValue uv;
     if (!uv.read(rawconfig))
         return false;
@@ -934,7 +964,7 @@ bool App::processConfigMessage(const sn::ServiceNode & snode) {
     }
 
     // Update settings for node
-    updateConfig(snode, settings);
+    updateConfig(snode, settings, configHash);
     return true;
 }
 
@@ -1041,15 +1071,85 @@ void App::onMessageReceived(CNode* node, const std::vector<unsigned char> & mess
 std::string App::xrouterCall(enum XRouterCommand command, std::string & uuidRet, const std::string & fqServiceName,
                              const int & confirmations, const UniValue & params)
 {
-    const std::string & uuid = generateUUID();
-    uuidRet = uuid; // set uuid
-    std::map<std::string, std::string> feePaymentTxs;
-    std::vector<CNode*> selectedNodes;
+    auto query = submitQuery(command, fqServiceName, confirmations, params, nullptr);
+    uuidRet = query->uuid; // set uuid
+
+    // Wait on the completion thread, shutdown completes the query early
+    while (query->result.wait_for(std::chrono::milliseconds(100)) != std::future_status::ready) {
+        if (ShutdownRequested())
+            completeQuery(query);
+    }
+
+    {
+        LOCK(mqueries);
+        pendingQueries.erase(query->uuid);
+    }
+    return query->result.get();
+}
+
+//*****************************************************************************
+//*****************************************************************************
+std::shared_future<std::string> App::xrouterCallAsync(enum XRouterCommand command, std::string & uuidRet,
+                                                      const std::string & fqServiceName, const int & confirmations,
+                                                      const UniValue & params, XRouterQueryCallback callback)
+{
+    auto query = submitQuery(command, fqServiceName, confirmations, params, callback);
+    uuidRet = query->uuid; // set uuid
+    return query->result;
+}
+
+//*****************************************************************************
+//*****************************************************************************
+bool App::queryResult(const std::string & uuid, bool & complete, std::string & result)
+{
+    PendingQueryPtr query;
+    {
+        LOCK(mqueries);
+        auto it = pendingQueries.find(uuid);
+        if (it == pendingQueries.end())
+            return false;
+        query = it->second;
+    }
+
+    complete = query->result.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    if (complete)
+        result = query->result.get();
+    return true;
+}
+
+//*****************************************************************************
+//*****************************************************************************
+App::PendingQueryPtr App::submitQuery(enum XRouterCommand command, const std::string & fqServiceName,
+                                      const int & confirmations, const UniValue & params, XRouterQueryCallback callback)
+{
+    auto query = std::make_shared<PendingQuery>();
+    query->uuid = generateUUID();
+    query->result = query->promise.get_future().share();
+    query->callback = callback;
+    const auto & uuid = query->uuid;
+    auto & feePaymentTxs = query->feePaymentTxs;
+    auto & selectedNodes = query->selectedNodes;
     std::vector<std::pair<std::string, int> > nodeErrors;
 
+    {
+        LOCK(mqueries);
+        // Forget completed queries whose results have not been looked up in a while
+        const auto now = GetTime();
+        for (auto it = pendingQueries.begin(); it != pendingQueries.end(); ) {
+            const auto completed = it->second->completedTime.load();
+            if (completed > 0 && now - completed > XROUTER_QUERY_RESULT_EXPIRY)
+                pendingQueries.erase(it++);
+            else
+                ++it;
+        }
+        pendingQueries[uuid] = query;
+    }
+
     try {
         if (!isEnabled() || !isReady())
             throw XRouterError("XRouter is turned off. Please set 'xrouter=1' in blocknet.conf", xrouter::UNAUTHORIZED);
+        if (ioservices.empty())
+            throw XRouterError("XRouter is not started", xrouter::UNAUTHORIZED);
 
         std::string cleaned;
         if (!removeNamespace(fqServiceName, cleaned))
@@ -1145,20 +1245,27 @@ std::string App::xrouterCall(enum XRouterCommand command, std::string & uuidRet,
         std::vector<sn::ServiceNode> listSelectedSnodes;
         for (auto & item : mapSelectedSnodes)
             listSelectedSnodes.push_back(item.second);
-        std::sort(listSelectedSnodes.begin(), listSelectedSnodes.end(), [this](const sn::ServiceNode & a, const sn::ServiceNode & b) {
+        std::sort(listSelectedSnodes.begin(), listSelectedSnodes.end(), [this,command,service](const sn::ServiceNode & a, const sn::ServiceNode & b) {
             if (a.isEXRCompatible() && !b.isEXRCompatible())
                 return true;
             else if (!a.isEXRCompatible() && b.isEXRCompatible())
                 return false;
-            return queryMgr.getScore(a.getHostPort()) > queryMgr.getScore(b.getHostPort());
+            return bestNode(a.getHostPort(), b.getHostPort(), command, service);
         });
         // Compose a final list of snodes to request. selectedNodes here should be sorted
         // ascending best to worst
+        const int hedgeDelay = xrsettings->hedgeDelay(command, service);
         for (auto & snode : listSelectedSnodes) {
             const auto & addr = snode.getHostPort();
             if (!hasConfig(addr))
                 continue; // skip nodes that do not have configs
 
+            if (snodeCount == confs) { // remaining nodes are only queried if the selected ones are slow
+                if (hedgeDelay > 0 && static_cast<int>(query->hedgeNodes.size()) < confs)
+                    query->hedgeNodes.push_back(snode);
+                continue;
+            }
+
             auto config = getConfig(addr);
 
             // Create the fee payment
@@ -1180,7 +1287,7 @@ std::string App::xrouterCall(enum XRouterCommand command, std::string & uuidRet,
 
             queryNodes.push_back(snode);
             ++snodeCount;
-            if (snodeCount == confs)
+            if (snodeCount == confs && hedgeDelay <= 0)
                 break;
         }
 
@@ -1191,9 +1298,12 @@ std::string App::xrouterCall(enum XRouterCommand command, std::string & uuidRet,
             throw XRouterError(msg, xrouter::NOT_ENOUGH_NODES);
         }
 
-        const int timeout = xrsettings->commandTimeout(command, service);
-        CKey clientKey; clientKey.Set(cprivkey.begin(), cprivkey.end(), true);
-        boost::thread_group tg;
+        query->command = command;
+        query->service = service;
+        query->fqService = fqService;
+        query->params = params;
+        query->timeout = xrsettings->commandTimeout(command, service);
+        query->nodes = mapSelectedNodes;
 
         // Send xrouter request to each selected node
         for (auto & snode : queryNodes) {
@@ -1201,113 +1311,312 @@ std::string App::xrouterCall(enum XRouterCommand command, std::string & uuidRet,
             std::string feetx;
             if (feePaymentTxs.count(addr))
                 feetx = feePaymentTxs[addr];
+            sendQuery(query, snode, feetx);
+        }
+
+        // Replies are counted against the nodes the query was sent to
+        query->confs = confs;
+        for (auto & snode : queryNodes)
+            query->review.push_back(snode.getHostPort());
+
+        // Complete the query on timeout if not enough replies arrive
+        query->timer = std::make_shared<boost::asio::deadline_timer>(*ioservices.front(), boost::posix_time::seconds(query->timeout));
+        query->timer->async_wait([this,query](const boost::system::error_code & ec) {
+            if (ec != boost::asio::error::operation_aborted)
+                completeQuery(query);
+        });
+
+        // Query extra nodes if the selected nodes are slow to reply
+        if (!query->hedgeNodes.empty()) {
+            query->hedgeTimer = std::make_shared<boost::asio::deadline_timer>(*ioservices.front(), boost::posix_time::milliseconds(hedgeDelay));
+            query->hedgeTimer->async_wait([this,query](const boost::system::error_code & ec) {
+                if (ec != boost::asio::error::operation_aborted)
+                    hedgeQuery(query);
+            });
+        }
+
+        query->submitted = true;
+        onQueryReply(uuid); // replies may have arrived before the query was submitted
+        return query;
+
+    } catch (XRouterError & e) {
+        LOG() << e.msg;
+
+        std::string errmsg = e.msg;
+        if (!nodeErrors.empty()) {
+            for (int i = 0; i < nodeErrors.size(); ++i) {
+                const auto & em = nodeErrors[i];
+                errmsg += strprintf(" | %s code %u", em.first, em.second);
+            }
+        }
+
+        UniValue error(UniValue::VOBJ);
+        error.pushKV("error", errmsg);
+        error.pushKV("code", e.code);
+        error.pushKV("uuid", uuid);
+
+        failQuery(query, error.write());
+        return query;
+
+    } catch (std::exception & e) {
+        LOG() << e.what();
+
+        UniValue error(UniValue::VOBJ);
+        error.pushKV("error", "Internal Server Error");
+        error.pushKV("code", INTERNAL_SERVER_ERROR);
+        error.pushKV("uuid", uuid);
+
+        failQuery(query, error.write());
+        return query;
+    }
+}
+
+//*****************************************************************************
+//*****************************************************************************
+void App::sendQuery(const PendingQueryPtr & query, const sn::ServiceNode & snode, const std::string & feetx)
+{
+    const auto & uuid = query->uuid;
+    const auto & command = query->command;
+    const auto & service = query->service;
+    const auto & fqService = query->fqService;
+    const auto & params = query->params;
+    const auto & timeout = query->timeout;
+    const std::string & addr = snode.getHostPort();
+
+    // Record the node sending request to
+    addQuery(uuid, addr);
+    queryMgr.addQuery(uuid, addr, fqService);
+
+    auto it = query->nodes.find(addr);
+    if (it != query->nodes.end()) { // query via the blocknet network
+        auto pnode = it->second;
+        // Send packet to xrouter node
+        XRouterPacket packet(command, uuid);
+        packet.append(service);
+        packet.append(feetx); // feetx
+        packet.append(static_cast<uint32_t>(params.size()));
+        for (const auto & p : params.getValues())
+            packet.append(p.get_str());
+        packet.sign(cpubkey, cprivkey);
+        PushXRouterMessage(pnode, packet.body());
+        queryMgr.updateSentRequest(addr, fqService);
+    } else { // query EXR snode
+        CKey clientKey; clientKey.Set(cprivkey.begin(), cprivkey.end(), true);
+        const bool tls = getConfig(addr)->tls(command, service);
+        // Set the fully qualified service url to the form /xr/BLOCK/xrGetBlockCount
+        const auto & fqUrl = fqServiceToUrl((command == xrService) ? pluginCommandKey(service) // plugin
+                                               : walletCommandKey(service, XRouterCommand_ToString(command), true)); // spv wallet
+        try {
+            requestHandlers.create_thread([uuid,addr,snode,tls,fqUrl,params,feetx,timeout,clientKey,this]() {
+                RenameThread("blocknet-xrclientrequest");
+                if (ShutdownRequested())
+                    return;
 
-            // Record the node sending request to
-            addQuery(uuid, addr);
-            queryMgr.addQuery(uuid, addr);
-
-            if (mapSelectedNodes.count(addr)) { // query via the blocknet network
-                auto pnode = mapSelectedNodes[addr];
-                // Send packet to xrouter node
-                XRouterPacket packet(command, uuid);
-                packet.append(service);
-                packet.append(feetx); // feetx
-                packet.append(static_cast<uint32_t>(params.size()));
-                for (const auto & p : params.getValues())
-                    packet.append(p.get_str());
-                packet.sign(cpubkey, cprivkey);
-                PushXRouterMessage(pnode, packet.body());
-                queryMgr.updateSentRequest(addr, fqService);
-            } else { // query EXR snode
-                const bool tls = getConfig(addr)->tls(command, service);
-                // Set the fully qualified service url to the form /xr/BLOCK/xrGetBlockCount
-                const auto & fqUrl = fqServiceToUrl((command == xrService) ? pluginCommandKey(service) // plugin
-                                                       : walletCommandKey(service, commandStr, true)); // spv wallet
+                XRouterReply xrresponse;
                 try {
-                    tg.create_thread([uuid,addr,snode,tls,fqUrl,params,feetx,timeout,&clientKey,this]() {
-                        RenameThread("blocknet-xrclientrequest");
-                        if (ShutdownRequested())
-                            return;
-
-                        XRouterReply xrresponse;
-                        try {
-                            std::string data;
-                            if (!params.empty())
-                                data = params.write();
-                            if (tls)
-                                xrresponse = xrouter::CallXRouterUrlSSL(snode.getHost(), snode.getHostAddr().GetPort(), fqUrl,
-                                        data, timeout, clientKey, snode.getSnodePubKey(), feetx);
-                            else
-                                xrresponse = xrouter::CallXRouterUrl(snode.getHost(), snode.getHostAddr().GetPort(), fqUrl,
-                                        data, timeout, clientKey, snode.getSnodePubKey(), feetx);
-                        } catch (std::exception & e) {
-                            UniValue error(UniValue::VOBJ);
-                            error.pushKV("error", e.what());
-                            error.pushKV("code", xrouter::Error::BAD_REQUEST);
-                            error.pushKV("reply", UniValue::VNULL);
-                            queryMgr.addReply(uuid, addr, error.write());
-                            queryMgr.purge(uuid, addr);
-                            return; // failed to connect
-                        }
+                    std::string data;
+                    if (!params.empty())
+                        data = params.write();
+                    if (tls)
+                        xrresponse = xrouter::CallXRouterUrlSSL(snode.getHost(), snode.getHostAddr().GetPort(), fqUrl,
+                                data, timeout, clientKey, snode.getSnodePubKey(), feetx);
+                    else
+                        xrresponse = xrouter::CallXRouterUrl(snode.getHost(), snode.getHostAddr().GetPort(), fqUrl,
+                                data, timeout, clientKey, snode.getSnodePubKey(), feetx);
+                } catch (std::exception & e) {
+                    UniValue error(UniValue::VOBJ);
+                    error.pushKV("error", e.what());
+                    error.pushKV("code", xrouter::Error::BAD_REQUEST);
+                    error.pushKV("reply", UniValue::VNULL);
+                    if (queryMgr.hasLateQuery(uuid, addr)) {
+                        queryMgr.addLateReply(uuid, addr, error.write());
+                        return;
+                    }
+                    queryMgr.addReply(uuid, addr, error.write());
+                    queryMgr.purge(uuid, addr);
+                    onQueryReply(uuid);
+                    return; // failed to connect
+                }
 
-                        // Do not process if we aren't expecting a result. Also prevent reply malleability (only first reply is accepted)
-                        if (!queryMgr.hasQuery(uuid, addr) || queryMgr.hasReply(uuid, addr))
-                            return; // done, nothing found
-
-                        // Verify servicenode response
-                        CHashWriter hw(SER_GETHASH, 0);
-                        hw << std::vector<unsigned char>(xrresponse.result.begin(), xrresponse.result.end());
-                        const auto hash = hw.GetHash();
-                        CPubKey sigPubKey;
-                        if (snode.getSnodePubKey() != xrresponse.hdrpubkey
-                        || !sigPubKey.RecoverCompact(hash, xrresponse.hdrsignature)
-                        || snode.getSnodePubKey() != sigPubKey) {
-                            UniValue error(UniValue::VOBJ);
-                            error.pushKV("error", "Unable to verify if the service node is valid. Received bad signature on this request.");
-                            error.pushKV("code", xrouter::Error::BAD_SIGNATURE);
-                            error.pushKV("reply", xrresponse.result);
-                            queryMgr.addReply(uuid, addr, error.write());
-                            queryMgr.purge(uuid, addr);
-                            return;
-                        }
+                // Do not process if we aren't expecting a result. Also prevent reply malleability (only first reply is accepted)
+                // Replies to queries that completed without them are only timed.
+                const bool late = queryMgr.hasLateQuery(uuid, addr);
+                if (!late && (!queryMgr.hasQuery(uuid, addr) || queryMgr.hasReply(uuid, addr)))
+                    return; // done, nothing found
+
+                // Verify servicenode response
+                CHashWriter hw(SER_GETHASH, 0);
+                hw << std::vector<unsigned char>(xrresponse.result.begin(), xrresponse.result.end());
+                const auto hash = hw.GetHash();
+                CPubKey sigPubKey;
+                if (snode.getSnodePubKey() != xrresponse.hdrpubkey
+                || !sigPubKey.RecoverCompact(hash, xrresponse.hdrsignature)
+                || snode.getSnodePubKey() != sigPubKey) {
+                    UniValue error(UniValue::VOBJ);
+                    error.pushKV("error", "Unable to verify if the service node is valid. Received bad signature on this request.");
+                    error.pushKV("code", xrouter::Error::BAD_SIGNATURE);
+                    error.pushKV("reply", xrresponse.result);
+                    if (late) {
+                        queryMgr.addLateReply(uuid, addr, error.write());
+                        return;
+                    }
+                    queryMgr.addReply(uuid, addr, error.write());
+                    queryMgr.purge(uuid, addr);
+                    onQueryReply(uuid);
+                    return;
+                }
 
-                        // Store the reply
-                        queryMgr.addReply(uuid, addr, xrresponse.result);
-                        queryMgr.purge(uuid, addr);
-                    });
-                } catch (...) { }
+                if (late) {
+                    queryMgr.addLateReply(uuid, addr, xrresponse.result);
+                    return;
+                }
+
+                // Store the reply
+                queryMgr.addReply(uuid, addr, xrresponse.result);
+                queryMgr.purge(uuid, addr);
+                onQueryReply(uuid);
+            });
+        } catch (...) { }
+
+        queryMgr.updateSentRequest(addr, fqService);
+    }
+    LOG() << "Sent command " << fqService << " query " << uuid << " to node " << addr;
+}
+
+//*****************************************************************************
+//*****************************************************************************
+void App::hedgeQuery(const PendingQueryPtr & query)
+{
+    if (query->done)
+        return;
+
+    int replies{0};
+    for (const auto & addr : query->review) {
+        if (queryMgr.hasReply(query->uuid, addr))
+            ++replies;
+    }
+
+    // One extra node for each reply still missing
+    const int needed = query->confs - replies;
+    const auto candidates = query->hedgeNodes;
+    query->hedgeNodes.clear();
+    if (needed <= 0 || candidates.empty())
+        return;
+
+    // Fee payments are created on a request handler thread, the query is sent
+    // from the completion thread like all other changes to the query state
+    requestHandlers.create_thread([this,query,candidates,needed]() {
+        RenameThread("blocknet-xrhedge");
+        int remaining = needed;
+        for (const auto & snode : candidates) {
+            if (remaining <= 0 || query->done || ShutdownRequested())
+                break;
+            const auto & addr = snode.getHostPort();
+            auto config = getConfig(addr);
+            if (!config)
+                continue;
 
-                queryMgr.updateSentRequest(addr, fqService);
+            std::string feetx;
+            CAmount fee = to_amount(config->commandFee(query->command, query->service));
+            if (fee > 0) {
+                try {
+                    if (!generatePayment(addr, config->paymentAddress(query->command, query->service), fee, feetx))
+                        continue;
+                } catch (XRouterError & e) {
+                    ERR() << "Failed to create payment to node " << addr << " " << e.msg;
+                    continue;
+                }
             }
-            LOG() << "Sent command " << fqService << " query " << uuid << " to node " << addr;
+
+            ioservices.front()->post([this,query,snode,feetx]() {
+                if (query->done) { // completed while the payment was created
+                    unlockOutputs(feetx);
+                    return;
+                }
+                const auto & addr = snode.getHostPort();
+                if (!feetx.empty())
+                    query->feePaymentTxs[addr] = feetx;
+                sendQuery(query, snode, feetx);
+                query->review.push_back(addr);
+            });
+            --remaining;
         }
+    });
+}
+
+//*****************************************************************************
+//*****************************************************************************
+void App::onQueryReply(const std::string & uuid)
+{
+    PendingQueryPtr query;
+    {
+        LOCK(mqueries);
+        auto it = pendingQueries.find(uuid);
+        if (it == pendingQueries.end())
+            return;
+        query = it->second;
+    }
+
+    if (!query->submitted || query->done || ioservices.empty())
+        return;
 
-        // At this point we need to wait for responses
+    ioservices.front()->post([this,query]() {
+        if (query->done)
+            return;
         int confirmation_count = 0;
-        auto queryCheckStart = GetTime();
-        auto queries = queryMgr.allLocks(uuid);
-        std::vector<NodeAddr> review;
-        for (auto & query : queries)
-            review.push_back(query.first);
+        for (const auto & addr : query->review) {
+            if (queryMgr.hasReply(query->uuid, addr))
+                ++confirmation_count;
+        }
+        if (confirmation_count >= query->confs) {
+            // Hedged queries can complete before the slow nodes reply
+            query->quorum = confirmation_count < static_cast<int>(query->review.size());
+            completeQuery(query);
+        }
+        else if (queryMgr.mostCommonCount(query->uuid) * 2 > query->confs) {
+            // A majority agrees, outstanding replies can't change the result
+            query->quorum = true;
+            completeQuery(query);
+        }
+    });
+}
 
-        // Check that all replies have arrived, only run as long as timeout
-        while (!ShutdownRequested() && confirmation_count < confs
-            && GetTime() - queryCheckStart < timeout)
-        {
-            boost::this_thread::sleep_for(boost::chrono::milliseconds(5));
-            for (int i = review.size() - 1; i >= 0; --i)
-                if (queryMgr.hasReply(uuid, review[i])) {
-                    ++confirmation_count;
-                    review.erase(review.begin()+i);
-                }
+//*****************************************************************************
+//*****************************************************************************
+void App::completeQuery(const PendingQueryPtr & query)
+{
+    if (query->done.exchange(true))
+        return; // already completed
+
+    if (query->timer) {
+        boost::system::error_code ec;
+        query->timer->cancel(ec);
+    }
+    if (query->hedgeTimer) {
+        boost::system::error_code ec;
+        query->hedgeTimer->cancel(ec);
+    }
+
+    const auto & uuid = query->uuid;
+    std::string result;
+
+    try {
+        // Nodes that did not reply in time. Nodes still working on a query
+        // that completed early on quorum are not penalized.
+        std::vector<NodeAddr> review;
+        for (const auto & addr : query->review) {
+            if (!queryMgr.hasReply(uuid, addr) && !query->quorum)
+                review.push_back(addr);
         }
 
-        // Clean up
+        // Clean up, the response times of nodes that haven't replied are
+        // recorded when their late replies arrive or as timeouts
+        queryMgr.closeQuery(uuid, query->timeout * 1000);
         queryMgr.purge(uuid);
 
         std::set<NodeAddr> failed;
 
-        if (confirmation_count < confs) {
+        if (!review.empty()) {
             failed.insert(review.begin(), review.end());
 
             auto snodes = getServiceNodes();
@@ -1334,7 +1643,7 @@ std::string App::xrouterCall(enum XRouterCommand command, std::string & uuidRet,
 
             // Unlock failed txs
             for (const auto & addr : failed) { // unlock any fee txs
-                const auto & tx = feePaymentTxs[addr];
+                const auto & tx = query->feePaymentTxs[addr];
                 unlockOutputs(tx);
             }
 
@@ -1346,8 +1655,7 @@ std::string App::xrouterCall(enum XRouterCommand command, std::string & uuidRet,
         std::map<NodeAddr, std::string> replies;
         std::set<NodeAddr> diff;
         std::set<NodeAddr> agree;
-        std::string rawResult;
-        int c = queryMgr.mostCommonReply(uuid, rawResult, replies, agree, diff);
+        int c = queryMgr.mostCommonReply(uuid, result, replies, agree, diff);
         for (const auto & addr : diff) // penalize nodes that didn't match consensus
             checkSnodeBan(addr, queryMgr.updateScore(addr, -5));
         if (c > 1) { // only update score if there's consensus
@@ -1376,7 +1684,7 @@ std::string App::xrouterCall(enum XRouterCommand command, std::string & uuidRet,
         }
 
         // Unlock any utxos associated with replies that returned an error
-        if (!feePaymentTxs.empty()) {
+        if (!query->feePaymentTxs.empty()) {
             for (const auto & item : replies) {
                 const auto & nodeAddr = item.first;
                 const auto & reply = item.second;
@@ -1384,55 +1692,55 @@ std::string App::xrouterCall(enum XRouterCommand command, std::string & uuidRet,
                 if (uv.read(reply) && uv.isObject()) {
                     const auto & err = find_value(uv.get_obj(), "error");
                     if (!err.isNull()) {
-                        const auto & tx = feePaymentTxs[nodeAddr];
+                        const auto & tx = query->feePaymentTxs[nodeAddr];
                         unlockOutputs(tx);
                     }
                 }
             }
         }
 
-        releaseNodes(selectedNodes);
-        return rawResult;
-
-    } catch (XRouterError & e) {
-        LOG() << e.msg;
-
-        for (const auto & item : feePaymentTxs) { // unlock any fee txs
-            const std::string & tx = item.second;
-            unlockOutputs(tx);
-        }
-
-        std::string errmsg = e.msg;
-        if (!nodeErrors.empty()) {
-            for (int i = 0; i < nodeErrors.size(); ++i) {
-                const auto & em = nodeErrors[i];
-                errmsg += strprintf(" | %s code %u", em.first, em.second);
-            }
-        }
-
-        UniValue error(UniValue::VOBJ);
-        error.pushKV("error", errmsg);
-        error.pushKV("code", e.code);
-        error.pushKV("uuid", uuid);
-
-        releaseNodes(selectedNodes);
-        return error.write();
-
     } catch (std::exception & e) {
         LOG() << e.what();
 
-        for (const auto & item : feePaymentTxs) { // unlock any fee txs
-            const std::string & tx = item.second;
-            unlockOutputs(tx);
-        }
+        for (const auto & item : query->feePaymentTxs) // unlock any fee txs
+            unlockOutputs(item.second);
 
         UniValue error(UniValue::VOBJ);
         error.pushKV("error", "Internal Server Error");
         error.pushKV("code", INTERNAL_SERVER_ERROR);
         error.pushKV("uuid", uuid);
+        result = error.write();
+    }
+
+    releaseNodes(query->selectedNodes);
+    query->completedTime = GetTime();
+    query->promise.set_value(result);
+    if (query->callback) {
+        try {
+            query->callback(uuid, result);
+        } catch (...) { }
+    }
+}
+
+//*****************************************************************************
+//*****************************************************************************
+void App::failQuery(const PendingQueryPtr & query, const std::string & result)
+{
+    if (query->done.exchange(true))
+        return;
 
-        releaseNodes(selectedNodes);
-        return error.write();
+    for (const auto & item : query->feePaymentTxs) { // unlock any fee txs
+        const std::string & tx = item.second;
+        unlockOutputs(tx);
+    }
+
+    releaseNodes(query->selectedNodes);
+    query->completedTime = GetTime();
+    query->promise.set_value(result);
+    if (query->callback) {
+        try {
+            query->callback(query->uuid, result);
+        } catch (...) { }
     }
 }
 
@@ -1667,6 +1975,27 @@ std::map<NodeAddr, std::pair<XRouterSettingsPtr, sn::ServiceNode::Tier>> App::xr
     return selectedConfigs;
 }
 
+/**
+ * Response time stats of a node or service as json.
+ */
+static Object latencyJSON(const std::map<std::string, QueryMgr::LatencyStats> & latencies) {
+    Object result;
+    for (const auto & item : latencies) {
+        const auto & stats = item.second;
+        Object o;
+        o.emplace_back("ewma", static_cast<int64_t>(std::round(stats.ewma)));
+        o.emplace_back("p50", stats.percentile(50));
+        o.emplace_back("p90", stats.percentile(90));
+        o.emplace_back("p99", stats.percentile(99));
+        o.emplace_back("replies", static_cast<int64_t>(stats.replies));
+        o.emplace_back("errors", static_cast<int64_t>(stats.errors));
+        o.emplace_back("timeouts", static_cast<int64_t>(stats.timeouts));
+        o.emplace_back("timeoutrate", stats.timeoutRate());
+        result.emplace_back(item.first, o);
+    }
+    return result;
+}
+
 void App::snodeConfigJSON(const std::map<NodeAddr, std::pair<XRouterSettingsPtr, sn::ServiceNode::Tier>> & configs, json_spirit::Array & data) {
     if (configs.empty()) // no configs
         return;
@@ -1686,6 +2015,8 @@ void App::snodeConfigJSON(const std::map<NodeAddr, std::pair<XRouterSettingsPtr,
 
         // score
         o.emplace_back("score", queryMgr.getScore(item.first));
+        // response times
+        o.emplace_back("latency", latencyJSON(queryMgr.getLatencies(item.first)));
         // banned
         o.emplace_back("banned", g_banman->IsBanned(settings->getAddr()));
         // payment address
@@ -1846,6 +2177,7 @@ std::string App::getStatus() {
             plugins.emplace_back(p, pp->rawText());
     }
     result.emplace_back("plugins", plugins);
+    result.emplace_back("latency", latencyJSON(queryMgr.getServiceLatencies()));
 
     return json_spirit::write_string(Value(result), json_spirit::pretty_print, 8);
 }
@@ -24,7 +24,10 @@
 #endif
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <functional>
+#include <future>
 #include <memory>
 
 #include <json/json_spirit.h>
@@ -45,6 +48,11 @@ namespace xrouter
 typedef std::shared_ptr<XRouterSettings> XRouterSettingsPtr;
 typedef std::shared_ptr<XRouterServer> XRouterServerPtr;
 
+/**
+ * Invoked once with the query uuid and the final result of an asynchronous xrouter query.
+ */
+typedef std::function<void(const std::string & uuid, const std::string & result)> XRouterQueryCallback;
+
 template <typename T>
 bool PushXRouterMessage(CNode *pnode, const T & message);
 
@@ -163,6 +171,32 @@ public:
     std::string xrouterCall(enum XRouterCommand command, std::string & uuidRet, const std::string & service,
                             const int & confirmations, const UniValue & params);
 
+    /**
+     * @brief submits a query without blocking on the service node replies. Replies from all
+     *        in-flight queries are collected on a single completion thread, the query completes
+     *        as soon as enough replies arrive or the command timeout expires.
+     * @param command XRouter command code
+     * @param uuidRet uuid of the request
+     * @param service chain code (BTC, LTC etc)
+     * @param confirmations number of service nodes to call (final result is selected from all answers by majority vote)
+     * @param params json parameter list
+     * @param callback optional, called once with the result. Runs on the completion thread, or on
+     *        the calling thread if the query fails before it is sent
+     * @return future holding the same reply xrouterCall would return
+     */
+    std::shared_future<std::string> xrouterCallAsync(enum XRouterCommand command, std::string & uuidRet,
+                                                     const std::string & service, const int & confirmations,
+                                                     const UniValue & params, XRouterQueryCallback callback = nullptr);
+
+    /**
+     * @brief looks up a query submitted with xrouterCallAsync
+     * @param uuid UUID of the query
+     * @param complete set to true if the query finished
+     * @param result reply from service node, only set if the query finished
+     * @return false if the query is unknown or its result has expired
+     */
+    bool queryResult(const std::string & uuid, bool & complete, std::string & result);
+
     /**
      * @brief returns block count (highest tree) in the selected chain
      * @param uuidRet uuid of the request
@@ -388,16 +422,29 @@ public:
      */
     bool processConfigMessage(const sn::ServiceNode & snode);
 
+    /**
+     * Settings of a snode that supports a command, read once from the snode's config
+     * so that node selection doesn't have to parse the config on every query.
+     */
+    struct ServiceCandidate {
+        XRouterSettingsPtr settings;
+        sn::ServiceNode::Tier tier;
+        double fee{0};
+        int fetchLimit{0};
+        int rateLimit{-1};
+    };
+    typedef std::map<NodeAddr, ServiceCandidate> ServiceCandidates;
+
     /**
      * Returns true if the specified service node matches all the criteria required for querying.
      * @param snode
-     * @param settings
+     * @param candidate
      * @param command
      * @param service
      * @param parameterCount
      * @return
      */
-    bool snodeMatchesCriteria(const sn::ServiceNode & snode, xrouter::XRouterSettingsPtr settings,
+    bool snodeMatchesCriteria(const sn::ServiceNode & snode, const ServiceCandidate & candidate,
             enum XRouterCommand command, const std::string & service, const int & parameterCount);
 
     /**
@@ -547,17 +594,73 @@ private:
     virtual ~App();
 
     bool bestNode(const NodeAddr & a, const NodeAddr & b, const XRouterCommand & command, const std::string & service) {
+        auto sa = getConfig(a);
+        auto sb = getConfig(b);
+        if (!sa || !sb) {
+            const auto & a_score = queryMgr.getScore(a);
+            const auto & b_score = queryMgr.getScore(b);
+            return a_score > b_score;
+        }
+        return bestNode(a, b, sa->commandFee(command, service), sb->commandFee(command, service), command, service);
+    }
+
+    /**
+     * Orders nodes for selection. Nodes with a negative score go last, then the lowest
+     * fee, then the lowest expected response time for the command, then the highest
+     * score. Nodes that haven't been queried for the command are tried before measured
+     * nodes so that their response times get measured, nodes that have been queried
+     * but never replied rank as if they timed out.
+     */
+    bool bestNode(const NodeAddr & a, const NodeAddr & b, const double & a_fee, const double & b_fee,
+                  const XRouterCommand & command, const std::string & service) {
         const auto & a_score = queryMgr.getScore(a);
         const auto & b_score = queryMgr.getScore(b);
         if (a_score < 0)
             return a_score > b_score;
         if (b_score < 0)
             return true;
-        auto sa = getConfig(a);
-        auto sb = getConfig(b);
-        if (!sa || !sb)
-            return a_score > b_score;
-        return sa->commandFee(command, service) < sb->commandFee(command, service);
+        if (a_fee != b_fee)
+            return a_fee < b_fee;
+        const auto & fqService = (command == xrService) ? pluginCommandKey(service) // plugin
+                                                        : walletCommandKey(service, XRouterCommand_ToString(command)); // spv wallet
+        const auto timeoutMs = xrsettings->commandTimeout(command, service) * 1000;
+        const auto a_latency = queryMgr.expectedLatency(a, fqService, timeoutMs);
+        const auto b_latency = queryMgr.expectedLatency(b, fqService, timeoutMs);
+        if (a_latency != b_latency)
+            return a_latency < b_latency;
+        return a_score > b_score;
+    }
+
+    /**
+     * Returns the snodes whose configs support the command and service. The candidates
+     * are indexed by fully qualified command on first use and the index is dropped
+     * whenever a snode config changes.
+     * @param command
+     * @param service
+     * @return
+     */
+    ServiceCandidates getCandidates(const XRouterCommand & command, const std::string & service) {
+        const auto & key = (command == xrService) ? pluginCommandKey(service) // plugin
+                                                  : walletCommandKey(service, XRouterCommand_ToString(command)); // spv wallet
+        LOCK(mu);
+        auto it = serviceIndex.find(key);
+        if (it != serviceIndex.end())
+            return it->second;
+        ServiceCandidates candidates;
+        for (const auto & item : snodeConfigs) {
+            auto settings = item.second.first;
+            if (!settings->isAvailableCommand(command, service))
+                continue;
+            ServiceCandidate candidate;
+            candidate.settings = settings;
+            candidate.tier = item.second.second;
+            candidate.fee = settings->commandFee(command, service);
+            candidate.fetchLimit = settings->commandFetchLimit(command, service);
+            candidate.rateLimit = settings->clientRequestLimit(command, service);
+            candidates[item.first] = candidate;
+        }
+        serviceIndex[key] = candidates;
+        return candidates;
     }
 
     std::map<NodeAddr, std::pair<XRouterSettingsPtr, sn::ServiceNode::Tier>> getConfigs() {
@@ -571,18 +674,46 @@ private:
         else
             configQueries[queryId].insert(node);
     }
-    void updateConfig(const sn::ServiceNode & snode, XRouterSettingsPtr & config) {
+    /**
+     * Stores the snode's config. The config hash is the hash of the raw config the
+     * settings were parsed from, a null hash means the config came from elsewhere.
+     * @param snode
+     * @param config
+     * @param configHash
+     */
+    void updateConfig(const sn::ServiceNode & snode, XRouterSettingsPtr & config, const uint256 & configHash = uint256()) {
         if (snode.isNull())
             return;
         LOCK(mu);
         // Remove existing configs that are associated with the snode pubkey
         for(auto it = snodeConfigs.begin(); it != snodeConfigs.end(); ) {
-            if (it->second.first->getSnodePubKey() == snode.getSnodePubKey())
+            if (it->second.first->getSnodePubKey() == snode.getSnodePubKey()) {
+                snodeConfigHashes.erase(it->first);
                 snodeConfigs.erase(it++);
-            else
+            } else
                 it++;
         }
         snodeConfigs[snode.getHostPort()] = std::make_pair(config, snode.getTier());
+        if (!configHash.IsNull())
+            snodeConfigHashes[snode.getHostPort()] = configHash;
+        serviceIndex.clear(); // rebuilt on the next query
+    }
+
+    /**
+     * Returns true if the snode's current config was parsed from a raw config with
+     * the specified hash.
+     * @param snode
+     * @param configHash
+     * @return
+     */
+    bool hasConfigHash(const sn::ServiceNode & snode, const uint256 & configHash) {
+        LOCK(mu);
+        const auto & addr = snode.getHostPort();
+        auto it = snodeConfigHashes.find(addr);
+        if (it == snodeConfigHashes.end() || it->second != configHash)
+            return false;
+        auto cit = snodeConfigs.find(addr);
+        return cit != snodeConfigs.end() && cit->second.first->getSnodePubKey() == snode.getSnodePubKey();
     }
     bool needConfigUpdate(const NodeAddr & node, const bool & isServer = false) {
         const auto & service = XRouterCommand_ToString(xrGetConfig);
@@ -742,6 +873,8 @@ private:
 
     std::map<std::string, std::set<NodeAddr> > configQueries;
     std::map<NodeAddr, std::pair<XRouterSettingsPtr, sn::ServiceNode::Tier>> snodeConfigs;
+    std::map<NodeAddr, uint256> snodeConfigHashes;
+    std::map<std::string, ServiceCandidates> serviceIndex; // fully qualified command -> snodes
     std::map<std::string, NodeAddr> snodeDomains;
 
     boost::filesystem::path xrouterpath;
@@ -751,6 +884,69 @@ private:
     std::deque<std::shared_ptr<boost::asio::io_service> > ioservices;
     std::deque<std::shared_ptr<boost::asio::io_service::work> > ioworkers;
 
+    /**
+     * State of an xrouter query that has been sent to service nodes. A query is
+     * completed exactly once, by the reply that meets the consensus count or gives
+     * one reply a majority, by its timeout, or on shutdown.
+     */
+    struct PendingQuery {
+        std::string uuid;
+        int confs{0};
+        std::vector<CNode*> selectedNodes;
+        std::map<NodeAddr, std::string> feePaymentTxs;
+        std::vector<NodeAddr> review; // nodes the query was sent to
+        XRouterCommand command{xrInvalid};
+        std::string service;
+        std::string fqService;
+        UniValue params;
+        int timeout{0};
+        std::map<NodeAddr, CNode*> nodes; // retained by selectedNodes
+        std::vector<sn::ServiceNode> hedgeNodes; // extra nodes to query if the selected ones are slow
+        std::shared_ptr<boost::asio::deadline_timer> timer;
+        std::shared_ptr<boost::asio::deadline_timer> hedgeTimer;
+        std::promise<std::string> promise;
+        std::shared_future<std::string> result;
+        XRouterQueryCallback callback;
+        std::atomic<bool> submitted{false};
+        std::atomic<bool> done{false};
+        std::atomic<bool> quorum{false}; // completed before all nodes replied
+        std::atomic<int64_t> completedTime{0};
+    };
+    typedef std::shared_ptr<PendingQuery> PendingQueryPtr;
+
+    /**
+     * Validates the query, pays and sends it to the selected nodes. Returns a query that
+     * is already complete if it could not be sent.
+     */
+    PendingQueryPtr submitQuery(enum XRouterCommand command, const std::string & fqServiceName,
+                                const int & confirmations, const UniValue & params, XRouterQueryCallback callback);
+    /**
+     * Sends the query to the snode, over the blocknet network if the snode is one of
+     * the query's connected nodes otherwise to its EXR endpoint.
+     */
+    void sendQuery(const PendingQueryPtr & query, const sn::ServiceNode & snode, const std::string & feetx);
+    /**
+     * Sends the query to extra nodes when the selected nodes haven't replied within
+     * the hedge delay. Runs on the completion thread, fee payments for the extra nodes
+     * are created on a request handler thread.
+     */
+    void hedgeQuery(const PendingQueryPtr & query);
+    /**
+     * Scores the replies, unlocks unused fee payments and fulfills the query result.
+     */
+    void completeQuery(const PendingQueryPtr & query);
+    /**
+     * Fails the query with the specified json result.
+     */
+    void failQuery(const PendingQueryPtr & query, const std::string & result);
+    /**
+     * Schedules a consensus check on the completion thread after a reply arrives.
+     */
+    void onQueryReply(const std::string & uuid);
+
+    Mutex mqueries;
+    std::map<std::string, PendingQueryPtr> pendingQueries;
+
     // timer
     boost::asio::io_service timerIo;
     boost::thread timerThread;
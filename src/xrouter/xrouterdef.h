@@ -15,6 +15,9 @@
 #define XROUTER_DEFAULT_FETCHLIMIT 50
 #define XROUTER_DEFAULT_CONFIRMATIONS 1
 #define XROUTER_TIMER_SECONDS 15
+#define XROUTER_QUERY_RESULT_EXPIRY 600 // seconds async query results are kept after completion
+#define XROUTER_LATENCY_SAMPLES 100 // recent response times kept per node and service
+#define XROUTER_LATENCY_EWMA_WEIGHT 0.2 // weight of the newest response time in the moving average
 
 // Note: also puts an upper limit on the number of requests per xrouter call (consensus)
 const uint32_t XROUTER_MAX_CONNECTION_COUNT = 50;
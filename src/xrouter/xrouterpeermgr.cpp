@@ -443,14 +443,9 @@ bool XRouterPeerMgr::ProcessMessages(CNode* pfrom, std::atomic<bool>& interruptM
 
     std::list<CNetMessage> msgs;
     {
-        LOCK(pfrom->cs_vProcessMsg);
-        if (pfrom->vProcessMsg.empty())
+        // Just take one message, block relay first
+        if (!connman->PollMessage(pfrom, msgs, fMoreWork))
             return false;
-        // Just take one message
-        msgs.splice(msgs.begin(), pfrom->vProcessMsg, pfrom->vProcessMsg.begin());
-        pfrom->nProcessQueueSize -= msgs.front().vRecv.size() + CMessageHeader::HEADER_SIZE;
-        pfrom->fPauseRecv = pfrom->nProcessQueueSize > connman->GetReceiveFloodSize();
-        fMoreWork = !pfrom->vProcessMsg.empty();
     }
 
     CNetMessage& msg(msgs.front());
@@ -468,6 +463,7 @@ bool XRouterPeerMgr::ProcessMessages(CNode* pfrom, std::atomic<bool>& interruptM
     if (!hdr.IsValid(chainparams.MessageStart()))
     {
         LogPrint(BCLog::NET, "PROCESSMESSAGE: ERRORS IN HEADER %s peer=%d\n", SanitizeString(hdr.GetCommand()), pfrom->GetId());
+        connman->RecordProcessedMessage(pfrom, hdr.GetCommand(), msg.vRecv.size() + CMessageHeader::HEADER_SIZE, 0, true);
         return fMoreWork;
     }
     const auto strCommand = hdr.GetCommand();
@@ -484,11 +480,13 @@ bool XRouterPeerMgr::ProcessMessages(CNode* pfrom, std::atomic<bool>& interruptM
                  SanitizeString(strCommand), nMessageSize,
                  HexStr(hash.begin(), hash.begin()+CMessageHeader::CHECKSUM_SIZE),
                  HexStr(hdr.pchChecksum, hdr.pchChecksum+CMessageHeader::CHECKSUM_SIZE));
+        connman->RecordProcessedMessage(pfrom, strCommand, nMessageSize + CMessageHeader::HEADER_SIZE, 0, true);
         return fMoreWork;
     }
 
     // Process message
     bool fRet = false;
+    const int64_t nTimeStart = GetTimeMicros();
     try {
         if (   strCommand == NetMsgType::REJECT
             || strCommand == NetMsgType::VERSION
@@ -525,6 +523,8 @@ bool XRouterPeerMgr::ProcessMessages(CNode* pfrom, std::atomic<bool>& interruptM
         PrintExceptionContinue(nullptr, "ProcessMessages()");
     }
 
+    connman->RecordProcessedMessage(pfrom, strCommand, nMessageSize + CMessageHeader::HEADER_SIZE, GetTimeMicros() - nTimeStart, !fRet);
+
     if (!fRet) {
         LogPrint(BCLog::NET, "%s(%s, %u bytes) FAILED peer=%d\n", __func__, SanitizeString(strCommand), nMessageSize, pfrom->GetId());
         return false;
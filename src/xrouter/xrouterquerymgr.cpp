@@ -4,14 +4,49 @@
 
 #include <xrouter/xrouterquerymgr.h>
 
+#include <cmath>
+
 namespace xrouter {
 
-void QueryMgr::addQuery(const std::string & id, const NodeAddr & node) {
+void QueryMgr::LatencyStats::addSample(const int64_t ms) {
+    ewma = replies == 0 ? ms : XROUTER_LATENCY_EWMA_WEIGHT * ms + (1 - XROUTER_LATENCY_EWMA_WEIGHT) * ewma;
+    ++replies;
+    if (samples.size() < XROUTER_LATENCY_SAMPLES)
+        samples.push_back(ms);
+    else {
+        samples[next] = ms;
+        next = (next + 1) % samples.size();
+    }
+}
+
+int64_t QueryMgr::LatencyStats::percentile(const double p) const {
+    if (samples.empty())
+        return 0;
+    std::vector<int64_t> sorted(samples);
+    std::sort(sorted.begin(), sorted.end());
+    const auto i = static_cast<size_t>(std::ceil(p / 100.0 * sorted.size()));
+    return sorted[std::min(std::max<size_t>(i, 1), sorted.size()) - 1];
+}
+
+double QueryMgr::LatencyStats::timeoutRate() const {
+    const auto total = replies + timeouts;
+    if (total == 0)
+        return 0;
+    return static_cast<double>(timeouts) / total;
+}
+
+void QueryMgr::addQuery(const std::string & id, const NodeAddr & node, const std::string & service) {
     if (id.empty() || node.empty())
         return;
 
     LOCK(mu);
 
+    if (!service.empty()) {
+        expireLateQueries();
+        queriesStarted[id][node] = std::make_pair(service, std::chrono::steady_clock::now());
+        ++latencies[node][service].sent;
+    }
+
     if (!queries.count(id))
         queries[id] = std::map<NodeAddr, std::string>{};
 
@@ -48,9 +83,44 @@ int QueryMgr::addReply(const std::string & id, const NodeAddr & node, const std:
             return 0;
     }
 
+    // Normalize and hash outside the lock, this is done once per reply
+    bool error{false};
+    const auto hash = replyHash(reply, error);
+
     if (replies) { // only handle locks if they exist for this query
         boost::mutex::scoped_lock l(*qcond.first);
-        queries[id][node] = reply; // Assign reply
+        {
+            LOCK(mu);
+            queries[id][node] = reply; // Assign reply
+            auto sit = queriesStarted.find(id);
+            if (sit != queriesStarted.end() && sit->second.count(node)) {
+                const auto & started = sit->second[node];
+                auto & stats = latencies[node][started.first];
+                if (error)
+                    ++stats.errors;
+                else
+                    stats.addSample(std::chrono::duration_cast<std::chrono::milliseconds>(
+                            std::chrono::steady_clock::now() - started.second).count());
+                sit->second.erase(node);
+            }
+            auto & votes = queriesVotes[id];
+            if (votes.nodeHashes.count(node)) { // replace a previous vote
+                const auto prev = votes.nodeHashes[node];
+                votes.nodes[prev].erase(node);
+                if (votes.nodes[prev].empty()) {
+                    votes.nodes.erase(prev);
+                    votes.errors.erase(prev);
+                }
+                votes.best = 0;
+                for (const auto & item : votes.nodes)
+                    votes.best = std::max(votes.best, static_cast<int>(item.second.size()));
+            }
+            votes.nodeHashes[node] = hash;
+            votes.errors[hash] = error;
+            auto & agree = votes.nodes[hash];
+            agree.insert(node);
+            votes.best = std::max(votes.best, static_cast<int>(agree.size()));
+        }
         qcond.second->notify_all();
     }
 
@@ -75,36 +145,21 @@ int QueryMgr::mostCommonReply(const std::string & id, std::string & reply, std::
     LOCK(mu);
 
     int consensus = queries.count(id);
-    if (!consensus || queries[id].empty())
+    if (!consensus || queries[id].empty() || !queriesVotes.count(id))
         return 0;
 
     // all replies
     replies = queries[id];
 
-    std::map<uint256, std::string> hashes;
-    std::map<uint256, int> counts;
-    std::map<uint256, std::set<NodeAddr> > nodes;
-    for (auto & item : queries[id]) {
-        auto result = item.second;
-        try {
-            UniValue j;
-            if (j.read(result)) {
-                if (j.isObject() || j.isArray())
-                    result = j.write();
-                else
-                    result = j.getValStr();
-            }
-        } catch (...) {
-            result = item.second;
-        }
-        auto hash = Hash(result.begin(), result.end());
-        hashes[hash] = item.second;
-        counts[hash] += 1; // update counts for common replies
-        nodes[hash].insert(item.first);
-    }
+    // Votes were tallied as replies arrived
+    const auto & votes = queriesVotes[id];
+    std::vector<std::pair<uint256, int> > tmp;
+    for (const auto & item : votes.nodes)
+        tmp.emplace_back(item.first, static_cast<int>(item.second.size()));
+    if (tmp.empty())
+        return 0;
 
     // sort reply counts descending (most similar replies are more valuable)
-    std::vector<std::pair<uint256, int> > tmp(counts.begin(), counts.end());
     std::sort(tmp.begin(), tmp.end(),
               [](const std::pair<uint256, int> & a, const std::pair<uint256, int> & b) {
                   return a.second > b.second;
@@ -113,12 +168,11 @@ int QueryMgr::mostCommonReply(const std::string & id, std::string & reply, std::
     diff.clear();
     if (tmp.size() > 1) {
         if (tmp[0].second == tmp[1].second) { // Check for errors and re-sort if there's a tie and highest rank has error
-            const auto &r = hashes[tmp[0].first];
-            if (hasError(r)) { // in tie arrangements we don't want errors to take precendence
+            if (votes.errors.at(tmp[0].first)) { // in tie arrangements we don't want errors to take precendence
                 std::sort(tmp.begin(), tmp.end(), // sort descending
-                          [this, &hashes](const std::pair<uint256, int> & a, const std::pair<uint256, int> & b) {
-                              const auto & ae = hasError(hashes[a.first]);
-                              const auto & be = hasError(hashes[b.first]);
+                          [&votes](const std::pair<uint256, int> & a, const std::pair<uint256, int> & b) {
+                              const auto & ae = votes.errors.at(a.first);
+                              const auto & be = votes.errors.at(b.first);
                               if ((!ae && !be) || (ae && be))
                                   return a.second > b.second;
                               return be;
@@ -127,22 +181,20 @@ int QueryMgr::mostCommonReply(const std::string & id, std::string & reply, std::
         }
         // Filter nodes that responded with different results
         for (int i = 1; i < static_cast<int>(tmp.size()); ++i) {
-            const auto & hash = tmp[i].first;
-            if (!nodes.count(hash) || tmp[i].second >= tmp[0].second) // do not penalize equal counts, only fewer
+            if (tmp[i].second >= tmp[0].second) // do not penalize equal counts, only fewer
                 continue;
-            auto ns = nodes[hash];
+            const auto & ns = votes.nodes.at(tmp[i].first);
             diff.insert(ns.begin(), ns.end());
         }
     }
 
-    auto selhash = tmp[0].first;
+    const auto & selhash = tmp[0].first;
 
     // store agreeing nodes
-    agree.clear();
-    agree = nodes[selhash];
+    agree = votes.nodes.at(selhash);
 
     // select the most common replies
-    reply = hashes[selhash];
+    reply = queries[id][*agree.begin()];
     return tmp[0].second;
 }
 
@@ -153,6 +205,13 @@ int QueryMgr::mostCommonReply(const std::string & id, std::string & reply) {
     return mostCommonReply(id, reply, replies, agree, diff);
 }
 
+int QueryMgr::mostCommonCount(const std::string & id) {
+    LOCK(mu);
+    if (!queriesVotes.count(id))
+        return 0;
+    return queriesVotes[id].best;
+}
+
 bool QueryMgr::hasQuery(const std::string & id) {
     LOCK(mu);
     return queriesLocks.count(id);
@@ -208,12 +267,18 @@ std::map<std::string, QueryMgr::QueryCondition> QueryMgr::allLocks(const std::st
 void QueryMgr::purge(const std::string & id) {
     LOCK(mu);
     queriesLocks.erase(id);
+    queriesStarted.erase(id);
 }
 
 void QueryMgr::purge(const std::string & id, const NodeAddr & node) {
     LOCK(mu);
     if (queriesLocks.count(id))
         queriesLocks[id].erase(node);
+    if (queriesStarted.count(id)) {
+        queriesStarted[id].erase(node);
+        if (queriesStarted[id].empty())
+            queriesStarted.erase(id);
+    }
 }
 
 std::chrono::time_point<std::chrono::system_clock> QueryMgr::getLastRequest(const NodeAddr & node, const std::string & command) {
@@ -274,13 +339,127 @@ int QueryMgr::banScore(const NodeAddr & node) {
     return snodeScore[node];
 }
 
+void QueryMgr::closeQuery(const std::string & id, const int timeoutMs) {
+    LOCK(mu);
+    expireLateQueries();
+    auto it = queriesStarted.find(id);
+    if (it == queriesStarted.end())
+        return;
+    const auto now = std::chrono::steady_clock::now();
+    for (const auto & item : it->second) {
+        const auto & started = item.second;
+        const auto deadline = started.second + std::chrono::milliseconds(timeoutMs);
+        if (deadline <= now)
+            ++latencies[item.first][started.first].timeouts;
+        else
+            queriesLate[id][item.first] = LateQuery{started.first, started.second, deadline};
+    }
+    queriesStarted.erase(it);
+}
+
+bool QueryMgr::hasLateQuery(const std::string & id, const NodeAddr & node) {
+    LOCK(mu);
+    return queriesLate.count(id) && queriesLate[id].count(node);
+}
+
+void QueryMgr::addLateReply(const std::string & id, const NodeAddr & node, const std::string & reply) {
+    bool error{false};
+    replyHash(reply, error);
+
+    LOCK(mu);
+    expireLateQueries();
+    auto it = queriesLate.find(id);
+    if (it == queriesLate.end() || !it->second.count(node))
+        return;
+    const auto & late = it->second[node];
+    auto & stats = latencies[node][late.service];
+    if (error)
+        ++stats.errors;
+    else
+        stats.addSample(std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - late.started).count());
+    it->second.erase(node);
+    if (it->second.empty())
+        queriesLate.erase(it);
+}
+
+double QueryMgr::expectedLatency(const NodeAddr & node, const std::string & service, const int timeoutMs) {
+    LOCK(mu);
+    auto it = latencies.find(node);
+    if (it == latencies.end() || !it->second.count(service))
+        return -1;
+    const auto & stats = it->second[service];
+    if (stats.replies + stats.timeouts == 0)
+        return stats.sent > 0 ? timeoutMs : -1;
+    const auto rate = stats.timeoutRate();
+    return (1 - rate) * stats.ewma + rate * timeoutMs;
+}
+
+std::map<std::string, QueryMgr::LatencyStats> QueryMgr::getLatencies(const NodeAddr & node) {
+    LOCK(mu);
+    expireLateQueries();
+    auto it = latencies.find(node);
+    if (it == latencies.end())
+        return {};
+    return it->second;
+}
+
+std::map<std::string, QueryMgr::LatencyStats> QueryMgr::getServiceLatencies() {
+    LOCK(mu);
+    expireLateQueries();
+    std::map<std::string, LatencyStats> result;
+    for (const auto & item : latencies) {
+        for (const auto & sitem : item.second) {
+            const auto & stats = sitem.second;
+            auto & total = result[sitem.first];
+            if (stats.replies > 0) // reply weighted average of the node averages
+                total.ewma = (total.ewma * total.replies + stats.ewma * stats.replies) / (total.replies + stats.replies);
+            total.samples.insert(total.samples.end(), stats.samples.begin(), stats.samples.end());
+            total.sent += stats.sent;
+            total.replies += stats.replies;
+            total.errors += stats.errors;
+            total.timeouts += stats.timeouts;
+        }
+    }
+    return result;
+}
+
+//private
+void QueryMgr::expireLateQueries() {
+    AssertLockHeld(mu);
+    const auto now = std::chrono::steady_clock::now();
+    for (auto it = queriesLate.begin(); it != queriesLate.end(); ) {
+        for (auto nit = it->second.begin(); nit != it->second.end(); ) {
+            if (nit->second.deadline <= now) {
+                ++latencies[nit->first][nit->second.service].timeouts;
+                it->second.erase(nit++);
+            } else
+                ++nit;
+        }
+        if (it->second.empty())
+            queriesLate.erase(it++);
+        else
+            ++it;
+    }
+}
+
 //private static
-bool QueryMgr::hasError(const std::string & reply) {
-    UniValue uv;
-    if (!uv.read(reply) || !uv.isObject())
-        return false;
-    const auto & err_v = find_value(uv, "error");
-    return !err_v.isNull();
+uint256 QueryMgr::replyHash(const std::string & reply, bool & error) {
+    std::string result = reply;
+    error = false;
+    try {
+        UniValue j;
+        if (j.read(reply)) {
+            error = j.isObject() && !find_value(j, "error").isNull();
+            if (j.isObject() || j.isArray())
+                result = j.write();
+            else
+                result = j.getValStr();
+        }
+    } catch (...) {
+        result = reply;
+    }
+    return Hash(result.begin(), result.end());
 }
 
 }
@@ -9,6 +9,7 @@
 #include <sync.h>
 #include <uint256.h>
 #include <univalue.h>
+#include <xrouter/xrouterdef.h>
 #include <xrouter/xrouterutils.h>
 
 #include <chrono>
@@ -17,6 +18,7 @@
 #include <set>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include <boost/thread/condition_variable.hpp>
 #include <boost/thread/mutex.hpp>
@@ -28,14 +30,42 @@ public:
     typedef std::string QueryReply;
     typedef std::pair<std::shared_ptr<boost::mutex>, std::shared_ptr<boost::condition_variable> > QueryCondition;
 
+    /**
+     * Response times of a node for one service. Replies and timeouts are tracked
+     * separately, error replies are counted but don't contribute a response time.
+     */
+    struct LatencyStats {
+        double ewma{0}; // milliseconds
+        std::vector<int64_t> samples; // most recent response times in milliseconds
+        size_t next{0}; // next sample to overwrite once full
+        uint64_t sent{0};
+        uint64_t replies{0};
+        uint64_t errors{0};
+        uint64_t timeouts{0};
+
+        void addSample(int64_t ms);
+        /**
+         * Response time at the specified percentile (0-100) of the recent samples.
+         * @param p
+         * @return Milliseconds, 0 if there are no samples
+         */
+        int64_t percentile(double p) const;
+        /**
+         * Fraction of queries that timed out.
+         * @return
+         */
+        double timeoutRate() const;
+    };
+
     explicit QueryMgr() = default;
 
     /**
      * Add a query. This stores interal state including condition variables and associated mutexes.
      * @param id uuid of query, can't be empty
      * @param node address of node associated with query, can't be empty
+     * @param service fully qualified service, if not empty the response time is tracked
      */
-    void addQuery(const std::string & id, const NodeAddr & node);
+    void addQuery(const std::string & id, const NodeAddr & node, const std::string & service = "");
 
     /**
      * Store a query reply.
@@ -76,6 +106,14 @@ public:
      */
     int mostCommonReply(const std::string & id, std::string & reply);
 
+    /**
+     * Returns the number of nodes that agree on the most common reply. Votes are
+     * counted as replies arrive so this does not inspect the replies.
+     * @param id
+     * @return
+     */
+    int mostCommonCount(const std::string & id);
+
     /**
      * Returns true if the query with specified id.
      * @param id
@@ -212,15 +250,100 @@ public:
      */
     int banScore(const NodeAddr & node);
 
+    /**
+     * Stops timing the nodes that haven't replied to a completed query. Nodes queried
+     * longer ago than the timeout are counted as timeouts, the others are still timed
+     * if their reply arrives before the timeout (see addLateReply).
+     * @param id
+     * @param timeoutMs
+     */
+    void closeQuery(const std::string & id, int timeoutMs);
+
+    /**
+     * Returns true if the query completed without a reply from the node and the
+     * node's reply is still being timed.
+     * @param id
+     * @param node
+     * @return
+     */
+    bool hasLateQuery(const std::string & id, const NodeAddr & node);
+
+    /**
+     * Records the response time of a reply that arrived after the query completed.
+     * The reply isn't stored and doesn't count towards the query's consensus.
+     * @param id
+     * @param node
+     * @param reply
+     */
+    void addLateReply(const std::string & id, const NodeAddr & node, const std::string & reply);
+
+    /**
+     * Returns the expected response time of the node for the service, the moving
+     * average of its response times with timeouts counting as the full timeout. A node
+     * that has been queried but hasn't replied yet is expected to time out.
+     * @param node
+     * @param service
+     * @param timeoutMs
+     * @return Milliseconds, -1 if the node hasn't been queried for the service
+     */
+    double expectedLatency(const NodeAddr & node, const std::string & service, int timeoutMs);
+
+    /**
+     * Returns the response times of the node by service.
+     * @param node
+     * @return
+     */
+    std::map<std::string, LatencyStats> getLatencies(const NodeAddr & node);
+
+    /**
+     * Returns the response times of all nodes by service.
+     * @return
+     */
+    std::map<std::string, LatencyStats> getServiceLatencies();
+
 private:
-    static bool hasError(const std::string & reply);
+    /**
+     * Hash of the normalized reply, json replies hash the same regardless of formatting.
+     * @param reply
+     * @param error Set to true if the reply is an error object
+     * @return
+     */
+    static uint256 replyHash(const std::string & reply, bool & error);
+
+    /**
+     * Counts the late queries past their deadline as timeouts. Requires mu.
+     */
+    void expireLateQueries();
+
+    /**
+     * Consensus votes of a query, updated once per reply.
+     */
+    struct ReplyVotes {
+        std::map<NodeAddr, uint256> nodeHashes;
+        std::map<uint256, std::set<NodeAddr> > nodes;
+        std::map<uint256, bool> errors;
+        int best{0};
+    };
+
+    /**
+     * Node that didn't reply before its query completed, timed until the deadline.
+     */
+    struct LateQuery {
+        std::string service;
+        std::chrono::steady_clock::time_point started;
+        std::chrono::steady_clock::time_point deadline;
+    };
 
 private:
     Mutex mu;
     std::map<std::string, std::map<NodeAddr, QueryCondition> > queriesLocks;
     std::map<std::string, std::map<NodeAddr, QueryReply> > queries;
+    std::map<std::string, ReplyVotes> queriesVotes;
     std::map<NodeAddr, std::map<std::string, std::chrono::time_point<std::chrono::system_clock> > > queriesLastSent;
     std::unordered_map<NodeAddr, int> snodeScore;
+    std::map<std::string, std::map<NodeAddr, std::pair<std::string, std::chrono::steady_clock::time_point> > > queriesStarted;
+    std::map<std::string, std::map<NodeAddr, LateQuery> > queriesLate;
+    std::unordered_map<NodeAddr, std::map<std::string, LatencyStats> > latencies;
 };
 
 }
@@ -4,6 +4,9 @@
 
 #include <xrouter/xrouterserver.h>
 
+#include <core_io.h>
+#include <index/addressindex.h>
+#include <key_io.h>
 #include <servicenode/servicenodemgr.h>
 #include <xbridge/util/settings.h>
 #include <xrouter/xrouterapp.h>
@@ -368,8 +371,7 @@ void XRouterServer::onMessageReceived(CNode* node, XRouterPacketPtr packet, CVal
                         reply = parseResult(processDecodeRawTransaction(service, params));
                         break;
                     case xrGetBalance:
-                        throw XRouterError("This call is not supported: " + fqService, xrouter::UNSUPPORTED_SERVICE);
-//                        reply = parseResult(processGetBalance(service, params));
+                        reply = parseResult(processGetBalance(service, params));
                         break;
                     case xrGetTxBloomFilter:
                         throw XRouterError("This call is not supported: " + fqService, xrouter::UNSUPPORTED_SERVICE);
@@ -633,7 +635,25 @@ std::string XRouterServer::processConvertTimeToBlockCount(const std::string & cu
 }
 
 std::string XRouterServer::processGetBalance(const std::string & currency, const std::vector<std::string> & params) {
-    throw XRouterError("Internal Server Error: Not implemented for " + currency, xrouter::BAD_CONNECTOR);
+    // Balances are only served for the local chain, and only when the address index is available
+    if (currency != "BLOCK" || !g_addressindex)
+        throw XRouterError("This call is not supported: " + currency, xrouter::UNSUPPORTED_SERVICE);
+    if (params.empty())
+        throw XRouterError("Missing address parameter", xrouter::INVALID_PARAMETERS);
+
+    const CTxDestination dest = DecodeDestination(params[0]);
+    if (!IsValidDestination(dest))
+        throw XRouterError("Bad address: " + params[0], xrouter::INVALID_PARAMETERS);
+
+    CAmount balance{0}, received{0};
+    g_addressindex->BlockUntilSyncedToCurrentChain();
+    if (!g_addressindex->GetBalance(GetScriptForDestination(dest), balance, received))
+        throw XRouterError("Internal Server Error: Failed to read the address index", xrouter::INTERNAL_SERVER_ERROR);
+
+    Object result;
+    result.emplace_back("balance", ValueFromAmount(balance).getValStr());
+    result.emplace_back("received", ValueFromAmount(received).getValStr());
+    return json_spirit::write_string(Value(result), true);
 }
 
 std::string XRouterServer::processServiceCall(const std::string & name, const std::vector<std::string> & params)
@@ -364,6 +364,25 @@ int XRouterSettings::commandTimeout(XRouterCommand c, const std::string & servic
     return res;
 }
 
+int XRouterSettings::hedgeDelay(XRouterCommand c, const std::string & service, int def)
+{
+    const std::string cstr{XRouterCommand_ToString(c)};
+    auto res = get<int>("Main.hedgedelay", def);
+
+    if (c == xrService) { // Handle plugin
+        if (!service.empty())
+            res = get<int>(cstr + xrdelimiter + service + ".hedgedelay", res);
+    } else {
+        res = get<int>(cstr + ".hedgedelay", res);
+        if (!service.empty()) {
+            res = get<int>(service + ".hedgedelay", res);
+            res = get<int>(service + xrdelimiter + cstr + ".hedgedelay", res);
+        }
+    }
+
+    return std::max(res, 0);
+}
+
 int XRouterSettings::confirmations(XRouterCommand c, std::string service, int def) {
     if (def > 1) // user requested consensus takes precedence
         return def;
@@ -785,6 +804,11 @@ bool createConf(const boost::filesystem::path & confDir, const bool & skipPlugin
                      "#! timeout is the maximum time in seconds you're willing to wait for an XRouter response"          + eol +
                      "timeout=30"                                                                                        + eol +
                      ""                                                                                                  + eol +
+                     "#! hedgedelay is the time in milliseconds to wait on the selected nodes before the query is also"  + eol +
+                     "#! sent to extra nodes, the first replies to meet consensus are used. 0 disables extra requests."  + eol +
+                     "#! Paid calls will send a payment to each extra node."                                             + eol +
+                     "hedgedelay=0"                                                                                      + eol +
+                     ""                                                                                                  + eol +
                      "#! Optionally set per-call config options:"                                                        + eol +
                      "#! [xrGetBlockCount]"                                                                              + eol +
                      "#! maxfee=0.01"                                                                                    + eol +
@@ -196,6 +196,7 @@ public:
     double commandFee(XRouterCommand c, const std::string & service, double def=0.0);
     std::string help(XRouterCommand c, const std::string & service);
     int commandTimeout(XRouterCommand c, const std::string & service, int def=XROUTER_DEFAULT_TIMEOUT);
+    int hedgeDelay(XRouterCommand c, const std::string & service, int def=0); // milliseconds, 0 is no hedging
     int commandFetchLimit(XRouterCommand c, const std::string & service, int def=XROUTER_DEFAULT_FETCHLIMIT);
     double maxFee(XRouterCommand c, const std::string& currency="", double def=0.0);
     int clientRequestLimit(XRouterCommand c, const std::string & service, int def=-1); // -1 is no limit
@@ -21,3 +21,18 @@ bool CZMQAbstractNotifier::NotifyTransaction(const CTransaction &/*transaction*/
 {
     return true;
 }
+
+bool CZMQAbstractNotifier::NotifyXBridgeOrder(const UniValue &/*order*/)
+{
+    return true;
+}
+
+bool CZMQAbstractNotifier::NotifyServiceNode(const UniValue &/*snode*/)
+{
+    return true;
+}
+
+bool CZMQAbstractNotifier::NotifyGovernance(const UniValue &/*data*/)
+{
+    return true;
+}
@@ -9,6 +9,7 @@
 
 class CBlockIndex;
 class CZMQAbstractNotifier;
+class UniValue;
 
 typedef CZMQAbstractNotifier* (*CZMQNotifierFactory)();
 
@@ -42,6 +43,9 @@ public:
 
     virtual bool NotifyBlock(const CBlockIndex *pindex);
     virtual bool NotifyTransaction(const CTransaction &transaction);
+    virtual bool NotifyXBridgeOrder(const UniValue &order);
+    virtual bool NotifyServiceNode(const UniValue &snode);
+    virtual bool NotifyGovernance(const UniValue &data);
 
 protected:
     void *psocket;
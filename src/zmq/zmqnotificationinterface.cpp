@@ -5,10 +5,18 @@
 #include <zmq/zmqnotificationinterface.h>
 #include <zmq/zmqpublishnotifier.h>
 
+#include <core_io.h>
+#include <governance/governance.h>
+#include <servicenode/servicenodemgr.h>
 #include <version.h>
 #include <validation.h>
 #include <streams.h>
 #include <util/system.h>
+#include <xbridge/util/xutil.h>
+#include <xbridge/xbridgeapp.h>
+#include <xbridge/xuiconnector.h>
+
+#include <univalue.h>
 
 void zmqError(const char *str)
 {
@@ -31,6 +39,7 @@ CZMQNotificationInterface::~CZMQNotificationInterface()
 
 std::list<const CZMQAbstractNotifier*> CZMQNotificationInterface::GetActiveNotifiers() const
 {
+    LOCK(cs_notifiers);
     std::list<const CZMQAbstractNotifier*> result;
     for (const auto* n : notifiers) {
         result.push_back(n);
@@ -48,6 +57,9 @@ CZMQNotificationInterface* CZMQNotificationInterface::Create()
     factories["pubhashtx"] = CZMQAbstractNotifier::Create<CZMQPublishHashTransactionNotifier>;
     factories["pubrawblock"] = CZMQAbstractNotifier::Create<CZMQPublishRawBlockNotifier>;
     factories["pubrawtx"] = CZMQAbstractNotifier::Create<CZMQPublishRawTransactionNotifier>;
+    factories["pubxbridgeorder"] = CZMQAbstractNotifier::Create<CZMQPublishXBridgeOrderNotifier>;
+    factories["pubsnode"] = CZMQAbstractNotifier::Create<CZMQPublishServiceNodeNotifier>;
+    factories["pubgovernance"] = CZMQAbstractNotifier::Create<CZMQPublishGovernanceNotifier>;
 
     for (const auto& entry : factories)
     {
@@ -67,13 +79,20 @@ CZMQNotificationInterface* CZMQNotificationInterface::Create()
     if (!notifiers.empty())
     {
         notificationInterface = new CZMQNotificationInterface();
-        notificationInterface->notifiers = notifiers;
+        {
+            LOCK(notificationInterface->cs_notifiers);
+            notificationInterface->notifiers = notifiers;
+        }
 
         if (!notificationInterface->Initialize())
         {
             delete notificationInterface;
             notificationInterface = nullptr;
         }
+        else
+        {
+            notificationInterface->ConnectSignals();
+        }
     }
 
     return notificationInterface;
@@ -97,6 +116,7 @@ bool CZMQNotificationInterface::Initialize()
         return false;
     }
 
+    LOCK(cs_notifiers);
     std::list<CZMQAbstractNotifier*>::iterator i=notifiers.begin();
     for (; i!=notifiers.end(); ++i)
     {
@@ -124,8 +144,10 @@ bool CZMQNotificationInterface::Initialize()
 void CZMQNotificationInterface::Shutdown()
 {
     LogPrint(BCLog::ZMQ, "zmq: Shutdown notification interface\n");
+    DisconnectSignals();
     if (pcontext)
     {
+        LOCK(cs_notifiers);
         for (std::list<CZMQAbstractNotifier*>::iterator i=notifiers.begin(); i!=notifiers.end(); ++i)
         {
             CZMQAbstractNotifier *notifier = *i;
@@ -143,19 +165,9 @@ void CZMQNotificationInterface::UpdatedBlockTip(const CBlockIndex *pindexNew, co
     if (fInitialDownload || pindexNew == pindexFork) // In IBD or blocks were disconnected without any new ones
         return;
 
-    for (std::list<CZMQAbstractNotifier*>::iterator i = notifiers.begin(); i!=notifiers.end(); )
-    {
-        CZMQAbstractNotifier *notifier = *i;
-        if (notifier->NotifyBlock(pindexNew))
-        {
-            i++;
-        }
-        else
-        {
-            notifier->Shutdown();
-            i = notifiers.erase(i);
-        }
-    }
+    Notify([pindexNew](CZMQAbstractNotifier *notifier) {
+        return notifier->NotifyBlock(pindexNew);
+    });
 }
 
 void CZMQNotificationInterface::TransactionAddedToMempool(const CTransactionRef& ptx)
@@ -164,10 +176,34 @@ void CZMQNotificationInterface::TransactionAddedToMempool(const CTransactionRef&
     // all the same external callback.
     const CTransaction& tx = *ptx;
 
+    Notify([&tx](CZMQAbstractNotifier *notifier) {
+        return notifier->NotifyTransaction(tx);
+    });
+}
+
+void CZMQNotificationInterface::BlockConnected(const std::shared_ptr<const CBlock>& pblock, const CBlockIndex* pindexConnected, const std::vector<CTransactionRef>& vtxConflicted)
+{
+    for (const CTransactionRef& ptx : pblock->vtx) {
+        // Do a normal notify for each transaction added in the block
+        TransactionAddedToMempool(ptx);
+    }
+}
+
+void CZMQNotificationInterface::BlockDisconnected(const std::shared_ptr<const CBlock>& pblock)
+{
+    for (const CTransactionRef& ptx : pblock->vtx) {
+        // Do a normal notify for each transaction removed in block disconnection
+        TransactionAddedToMempool(ptx);
+    }
+}
+
+void CZMQNotificationInterface::Notify(const std::function<bool(CZMQAbstractNotifier*)> &fn)
+{
+    LOCK(cs_notifiers);
     for (std::list<CZMQAbstractNotifier*>::iterator i = notifiers.begin(); i!=notifiers.end(); )
     {
         CZMQAbstractNotifier *notifier = *i;
-        if (notifier->NotifyTransaction(tx))
+        if (fn(notifier))
         {
             i++;
         }
@@ -179,20 +215,155 @@ void CZMQNotificationInterface::TransactionAddedToMempool(const CTransactionRef&
     }
 }
 
-void CZMQNotificationInterface::BlockConnected(const std::shared_ptr<const CBlock>& pblock, const CBlockIndex* pindexConnected, const std::vector<CTransactionRef>& vtxConflicted)
+/** Order lifecycle event for a state change, the exact state is published as "status" */
+static std::string XBridgeOrderEvent(const xbridge::TransactionDescrPtr &order)
 {
-    for (const CTransactionRef& ptx : pblock->vtx) {
-        // Do a normal notify for each transaction added in the block
-        TransactionAddedToMempool(ptx);
+    switch (order->state)
+    {
+        case xbridge::TransactionDescr::trAccepting:
+        case xbridge::TransactionDescr::trHold:
+            return "accepted";
+        case xbridge::TransactionDescr::trCancelled:
+            return "cancelled";
+        case xbridge::TransactionDescr::trFinished:
+            return "finished";
+        case xbridge::TransactionDescr::trExpired:
+            return "expired";
+        default:
+            return "updated";
     }
 }
 
-void CZMQNotificationInterface::BlockDisconnected(const std::shared_ptr<const CBlock>& pblock)
+static UniValue XBridgeOrderToJSON(const xbridge::TransactionDescrPtr &order, const std::string &event)
 {
-    for (const CTransactionRef& ptx : pblock->vtx) {
-        // Do a normal notify for each transaction removed in block disconnection
-        TransactionAddedToMempool(ptx);
+    UniValue obj(UniValue::VOBJ);
+    obj.pushKV("event", event);
+    obj.pushKV("id", order->id.GetHex());
+    obj.pushKV("maker", order->fromCurrency);
+    obj.pushKV("maker_size", xbridge::xBridgeStringValueFromAmount(order->fromAmount));
+    obj.pushKV("taker", order->toCurrency);
+    obj.pushKV("taker_size", xbridge::xBridgeStringValueFromAmount(order->toAmount));
+    // Price of the maker asset denominated in the taker asset
+    if (order->fromAmount > 0)
+        obj.pushKV("price", strprintf("%.8f", static_cast<double>(order->toAmount) / static_cast<double>(order->fromAmount)));
+    obj.pushKV("updated_at", xbridge::iso8601(order->txtime));
+    obj.pushKV("created_at", xbridge::iso8601(order->created));
+    obj.pushKV("status", order->strState());
+    return obj;
+}
+
+static UniValue ServiceNodeToJSON(const sn::ServiceNode &snode, const std::string &event)
+{
+    UniValue obj(UniValue::VOBJ);
+    obj.pushKV("event", event);
+    obj.pushKV("snodekey", HexStr(snode.getSnodePubKey()));
+    obj.pushKV("tier", sn::ServiceNodeMgr::tierString(snode.getTier()));
+    obj.pushKV("address", EncodeDestination(CTxDestination(snode.getPaymentAddress())));
+    obj.pushKV("host", snode.getHostPort());
+    obj.pushKV("timelastseen", snode.getPingTime());
+    obj.pushKV("status", snode.running() ? "running" : "offline");
+    return obj;
+}
+
+static UniValue ProposalToJSON(const gov::Proposal &proposal, const std::string &event)
+{
+    UniValue obj(UniValue::VOBJ);
+    obj.pushKV("event", event);
+    obj.pushKV("hash", proposal.getHash().ToString());
+    obj.pushKV("name", proposal.getName());
+    obj.pushKV("superblock", proposal.getSuperblock());
+    obj.pushKV("amount", ValueFromAmount(proposal.getAmount()));
+    obj.pushKV("address", proposal.getAddress());
+    return obj;
+}
+
+static UniValue VoteToJSON(const gov::Vote &vote, const std::string &event)
+{
+    UniValue obj(UniValue::VOBJ);
+    obj.pushKV("event", event);
+    obj.pushKV("hash", vote.getHash().ToString());
+    obj.pushKV("proposal", vote.getProposal().ToString());
+    obj.pushKV("vote", gov::Vote::voteTypeToString(vote.getVote()));
+    obj.pushKV("utxo", vote.getUtxo().ToString());
+    obj.pushKV("amount", ValueFromAmount(vote.getAmount()));
+    obj.pushKV("blocknumber", vote.getBlockNumber());
+    obj.pushKV("spent", vote.spent());
+    return obj;
+}
+
+void CZMQNotificationInterface::ConnectSignals()
+{
+    bool xbridgeorders{false}, snodes{false}, governance{false};
+    for (const auto* n : GetActiveNotifiers()) {
+        xbridgeorders |= n->GetType() == "pubxbridgeorder";
+        snodes |= n->GetType() == "pubsnode";
+        governance |= n->GetType() == "pubgovernance";
+    }
+
+    if (xbridgeorders) {
+        connections.push_back(xuiConnector.NotifyXBridgeTransactionReceived.connect([this](const xbridge::TransactionDescrPtr &order) {
+            const auto obj = XBridgeOrderToJSON(order, "new");
+            Notify([&obj](CZMQAbstractNotifier *notifier) { return notifier->NotifyXBridgeOrder(obj); });
+        }));
+        connections.push_back(xuiConnector.NotifyXBridgeTransactionChanged.connect([this](const uint256 &id) {
+            const auto order = xbridge::App::instance().transaction(id);
+            if (!order)
+                return;
+            const auto obj = XBridgeOrderToJSON(order, XBridgeOrderEvent(order));
+            Notify([&obj](CZMQAbstractNotifier *notifier) { return notifier->NotifyXBridgeOrder(obj); });
+        }));
+    }
+
+    if (snodes) {
+        auto & smgr = sn::ServiceNodeMgr::instance();
+        connections.push_back(smgr.NotifyServiceNodeRegistered.connect([this](const sn::ServiceNode &snode) {
+            const auto obj = ServiceNodeToJSON(snode, "registered");
+            Notify([&obj](CZMQAbstractNotifier *notifier) { return notifier->NotifyServiceNode(obj); });
+        }));
+        connections.push_back(smgr.NotifyServiceNodePing.connect([this](const sn::ServiceNodePing &ping) {
+            auto obj = ServiceNodeToJSON(ping.getSnode(), "ping");
+            obj.pushKV("config", ping.getConfig());
+            Notify([&obj](CZMQAbstractNotifier *notifier) { return notifier->NotifyServiceNode(obj); });
+        }));
+        connections.push_back(smgr.NotifyServiceNodeRemoved.connect([this](const CPubKey &snodePubKey) {
+            UniValue obj(UniValue::VOBJ);
+            obj.pushKV("event", "removed");
+            obj.pushKV("snodekey", HexStr(snodePubKey));
+            Notify([&obj](CZMQAbstractNotifier *notifier) { return notifier->NotifyServiceNode(obj); });
+        }));
+    }
+
+    if (governance) {
+        auto & gov = gov::Governance::instance();
+        auto notifyProposal = [this](const gov::Proposal &proposal, const std::string &event) {
+            const auto obj = ProposalToJSON(proposal, event);
+            Notify([&obj](CZMQAbstractNotifier *notifier) { return notifier->NotifyGovernance(obj); });
+        };
+        auto notifyVote = [this](const gov::Vote &vote, const std::string &event) {
+            const auto obj = VoteToJSON(vote, event);
+            Notify([&obj](CZMQAbstractNotifier *notifier) { return notifier->NotifyGovernance(obj); });
+        };
+        connections.push_back(gov.NotifyProposalAdded.connect(std::bind(notifyProposal, std::placeholders::_1, "proposaladded")));
+        connections.push_back(gov.NotifyProposalRemoved.connect(std::bind(notifyProposal, std::placeholders::_1, "proposalremoved")));
+        connections.push_back(gov.NotifyVoteAdded.connect(std::bind(notifyVote, std::placeholders::_1, "voteadded")));
+        connections.push_back(gov.NotifyVoteRemoved.connect(std::bind(notifyVote, std::placeholders::_1, "voteremoved")));
+        connections.push_back(gov.NotifyVoteSpent.connect(std::bind(notifyVote, std::placeholders::_1, "votespent")));
+        connections.push_back(gov.NotifyVoteUnspent.connect(std::bind(notifyVote, std::placeholders::_1, "voteunspent")));
+        connections.push_back(gov.NotifySuperblockChanged.connect([this](int superblock, uint64_t generation) {
+            UniValue obj(UniValue::VOBJ);
+            obj.pushKV("event", "superblockchanged");
+            obj.pushKV("superblock", superblock);
+            obj.pushKV("generation", generation);
+            Notify([&obj](CZMQAbstractNotifier *notifier) { return notifier->NotifyGovernance(obj); });
+        }));
     }
 }
 
+void CZMQNotificationInterface::DisconnectSignals()
+{
+    for (auto & connection : connections)
+        connection.disconnect();
+    connections.clear();
+}
+
 CZMQNotificationInterface* g_zmq_notification_interface = nullptr;
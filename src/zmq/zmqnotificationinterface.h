@@ -5,10 +5,15 @@
 #ifndef BITCOIN_ZMQ_ZMQNOTIFICATIONINTERFACE_H
 #define BITCOIN_ZMQ_ZMQNOTIFICATIONINTERFACE_H
 
+#include <sync.h>
 #include <validationinterface.h>
+#include <functional>
 #include <string>
 #include <map>
 #include <list>
+#include <vector>
+
+#include <boost/signals2/connection.hpp>
 
 class CBlockIndex;
 class CZMQAbstractNotifier;
@@ -35,8 +40,19 @@ protected:
 private:
     CZMQNotificationInterface();
 
+    /** Runs fn for every notifier, notifiers that fail are shut down and removed */
+    void Notify(const std::function<bool(CZMQAbstractNotifier*)> &fn);
+
+    /** Subscribes the xbridge, servicenode and governance notifiers to their events */
+    void ConnectSignals();
+    void DisconnectSignals();
+
     void *pcontext;
-    std::list<CZMQAbstractNotifier*> notifiers;
+    // Notifications arrive from the validation interface, xbridge and network threads and
+    // notifiers may share a socket, sends are serialized by this lock.
+    mutable Mutex cs_notifiers;
+    std::list<CZMQAbstractNotifier*> notifiers GUARDED_BY(cs_notifiers);
+    std::vector<boost::signals2::connection> connections;
 };
 
 extern CZMQNotificationInterface* g_zmq_notification_interface;
@@ -10,12 +10,17 @@
 #include <util/system.h>
 #include <rpc/server.h>
 
+#include <univalue.h>
+
 static std::multimap<std::string, CZMQAbstractPublishNotifier*> mapPublishNotifiers;
 
 static const char *MSG_HASHBLOCK = "hashblock";
 static const char *MSG_HASHTX    = "hashtx";
 static const char *MSG_RAWBLOCK  = "rawblock";
 static const char *MSG_RAWTX     = "rawtx";
+static const char *MSG_XBRIDGEORDER = "xbridgeorder";
+static const char *MSG_SNODE        = "snode";
+static const char *MSG_GOVERNANCE   = "governance";
 
 // Internal function to send multipart message
 static int zmq_send_multipart(void *sock, const void* data, size_t size, ...)
@@ -206,3 +211,24 @@ bool CZMQPublishRawTransactionNotifier::NotifyTransaction(const CTransaction &tr
     ss << transaction;
     return SendMessage(MSG_RAWTX, &(*ss.begin()), ss.size());
 }
+
+bool CZMQPublishXBridgeOrderNotifier::NotifyXBridgeOrder(const UniValue &order)
+{
+    LogPrint(BCLog::ZMQ, "zmq: Publish xbridgeorder %s %s\n", find_value(order, "event").get_str(), find_value(order, "id").get_str());
+    const std::string data = order.write();
+    return SendMessage(MSG_XBRIDGEORDER, data.data(), data.size());
+}
+
+bool CZMQPublishServiceNodeNotifier::NotifyServiceNode(const UniValue &snode)
+{
+    LogPrint(BCLog::ZMQ, "zmq: Publish snode %s %s\n", find_value(snode, "event").get_str(), find_value(snode, "snodekey").get_str());
+    const std::string data = snode.write();
+    return SendMessage(MSG_SNODE, data.data(), data.size());
+}
+
+bool CZMQPublishGovernanceNotifier::NotifyGovernance(const UniValue &data)
+{
+    LogPrint(BCLog::ZMQ, "zmq: Publish governance %s\n", find_value(data, "event").get_str());
+    const std::string str = data.write();
+    return SendMessage(MSG_GOVERNANCE, str.data(), str.size());
+}
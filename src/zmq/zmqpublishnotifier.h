@@ -52,4 +52,22 @@ public:
     bool NotifyTransaction(const CTransaction &transaction) override;
 };
 
+class CZMQPublishXBridgeOrderNotifier : public CZMQAbstractPublishNotifier
+{
+public:
+    bool NotifyXBridgeOrder(const UniValue &order) override;
+};
+
+class CZMQPublishServiceNodeNotifier : public CZMQAbstractPublishNotifier
+{
+public:
+    bool NotifyServiceNode(const UniValue &snode) override;
+};
+
+class CZMQPublishGovernanceNotifier : public CZMQAbstractPublishNotifier
+{
+public:
+    bool NotifyGovernance(const UniValue &data) override;
+};
+
 #endif // BITCOIN_ZMQ_ZMQPUBLISHNOTIFIER_H